@@ -41,6 +41,39 @@ DataBlock::~DataBlock ()
     // qDebug () << "DataBlock::instance_count_ = " << instance_count_ << " deleting";
 }
 
+//-----------------------------------------------------------------------------
+bool DataBlock::getMinMax (size_t start, size_t length, float32& min, float32& max) const
+{
+    bool found = false;
+    for (size_t index = start; index < start + length; index++)
+    {
+        float32 value = (*this)[index];
+        if (std::isnan (value))
+            continue;
+        if (!found || value < min)
+            min = value;
+        if (!found || value > max)
+            max = value;
+        found = true;
+    }
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+void DataBlock::copyTo (size_t start, size_t length, float32* destination) const
+{
+    for (size_t index = start; index < start + length; index++)
+        *destination++ = (*this)[index];
+}
+
+//-----------------------------------------------------------------------------
+std::vector<DataBlock::Range> DataBlock::getCoveredRanges (size_t start, size_t length) const
+{
+    if (length == 0)
+        return std::vector<Range> ();
+    return std::vector<Range> (1, Range {start, start + length});
+}
+
 //-----------------------------------------------------------------------------
 size_t DataBlock::size () const
 {
@@ -89,4 +122,10 @@ float64 DataBlock::getSampleRatePerUnit () const
     return sample_rate_per_unit_;
 }
 
+//-------------------------------------------------------------------------
+float64 DataBlock::getNativeSampleRatePerUnit () const
+{
+    return sample_rate_per_unit_;
+}
+
 }
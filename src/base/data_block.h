@@ -11,6 +11,8 @@
 #include <QSharedPointer>
 #include <QMap>
 
+#include <vector>
+
 
 namespace sigviewer {
 
@@ -28,7 +30,7 @@ public:
     virtual QSharedPointer<DataBlock> createSubBlock(size_t start, size_t length) const = 0;
 
     //-------------------------------------------------------------------------
-    virtual float32 const& operator[] (size_t index) const = 0;
+    virtual float32 operator[] (size_t index) const = 0;
 
     //-------------------------------------------------------------------------
     virtual float32 getMin () const = 0;
@@ -36,6 +38,32 @@ public:
     //-------------------------------------------------------------------------
     virtual float32 getMax () const = 0;
 
+    //-------------------------------------------------------------------------
+    /// minimum and maximum of the values [start, start + length) in one pass,
+    /// NANs are ignored
+    ///
+    /// @return false if there is no value other than NAN in the range; min and
+    ///         max are left unchanged then
+    virtual bool getMinMax (size_t start, size_t length, float32& min, float32& max) const;
+
+    //-------------------------------------------------------------------------
+    /// copies the values [start, start + length) to the given array
+    virtual void copyTo (size_t start, size_t length, float32* destination) const;
+
+    //-------------------------------------------------------------------------
+    /// samples [begin, end) of a block
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    //-------------------------------------------------------------------------
+    /// the parts of [start, start + length) which may hold values other than
+    /// NAN, in ascending order; all other samples are NAN, so they need
+    /// neither be searched nor drawn
+    virtual std::vector<Range> getCoveredRanges (size_t start, size_t length) const;
+
     //-------------------------------------------------------------------------
     /// length of the block
     size_t size () const;
@@ -63,6 +91,11 @@ public:
     //-------------------------------------------------------------------------
     float64 getSampleRatePerUnit () const;
 
+    //-------------------------------------------------------------------------
+    /// rate of the samples the block has been created out of, if they are
+    /// mapped onto another rate; the sample rate of the block otherwise
+    virtual float64 getNativeSampleRatePerUnit () const;
+
 protected:
     // protected constructors here:
     DataBlock (size_t length, float64 sample_rate_per_unit);
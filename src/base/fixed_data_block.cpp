@@ -4,6 +4,7 @@
 
 
 #include "fixed_data_block.h"
+#include "math_utils.h"
 
 #include "signal_processing/FFTReal.h"
 
@@ -27,7 +28,7 @@ FixedDataBlock::FixedDataBlock (QSharedPointer<QVector<float32> > data,
 FixedDataBlock::FixedDataBlock (FixedDataBlock const& base, size_t new_start, size_t new_length)
     : DataBlock (base, new_length),
       data_ (base.data_),
-      start_index_ (new_start)
+      start_index_ (base.start_index_ + new_start)
 {
     // nothing to do here
 }
@@ -40,7 +41,7 @@ QSharedPointer<DataBlock> FixedDataBlock::createSubBlock (size_t start,
 }
 
 //-------------------------------------------------------------------------------------------------
-float32 const& FixedDataBlock::operator[] (size_t index) const
+float32 FixedDataBlock::operator[] (size_t index) const
 {
     return data_->at(start_index_ + index);
 }
@@ -50,23 +51,8 @@ float32 const& FixedDataBlock::operator[] (size_t index) const
 float32 FixedDataBlock::getMin () const
 {
     float32 min = 0;
-    for (auto const elem : *data_)
-    {
-        if (!std::isnan(elem))
-        {
-            min = elem;
-            break;
-        }
-    }
-
-    for (auto const elem : *data_)
-    {
-        if (!std::isnan(elem))
-        {
-            if (elem < min)
-                min = elem;
-        }
-    }
+    float32 max = 0;
+    getMinMax (0, size (), min, max);
     return min;
 }
 
@@ -74,27 +60,25 @@ float32 FixedDataBlock::getMin () const
 //! Get the maximal value in a data block, excluding any NANs
 float32 FixedDataBlock::getMax () const
 {
+    float32 min = 0;
     float32 max = 0;
-    for (auto const elem : *data_)
-    {
-        if (!std::isnan(elem))
-        {
-            max = elem;
-            break;
-        }
-    }
-
-    for (auto const elem : *data_)
-    {
-        if (!std::isnan(elem))
-        {
-            if (elem > max)
-                max = elem;
-        }
-    }
+    getMinMax (0, size (), min, max);
     return max;
 }
 
+//-------------------------------------------------------------------------------------------------
+bool FixedDataBlock::getMinMax (size_t start, size_t length, float32& min, float32& max) const
+{
+    return MathUtils_::minMax (data_->constData () + start_index_ + start, length, min, max);
+}
+
+//-------------------------------------------------------------------------------------------------
+void FixedDataBlock::copyTo (size_t start, size_t length, float32* destination) const
+{
+    float32 const* source = data_->constData () + start_index_ + start;
+    std::copy (source, source + length, destination);
+}
+
 //-----------------------------------------------------------------------------
 QSharedPointer<DataBlock const> FixedDataBlock::createPowerSpectrum (QSharedPointer<DataBlock const> data_block)
 {
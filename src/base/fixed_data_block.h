@@ -36,7 +36,7 @@ public:
     virtual QSharedPointer<DataBlock> createSubBlock (size_t start, size_t length) const;
 
     //-------------------------------------------------------------------------
-    virtual float32 const& operator[] (size_t index) const;
+    virtual float32 operator[] (size_t index) const;
 
     //-------------------------------------------------------------------------
     virtual float32 getMin () const;
@@ -44,6 +44,12 @@ public:
     //-------------------------------------------------------------------------
     virtual float32 getMax () const;
 
+    //-------------------------------------------------------------------------
+    virtual bool getMinMax (size_t start, size_t length, float32& min, float32& max) const;
+
+    //-------------------------------------------------------------------------
+    virtual void copyTo (size_t start, size_t length, float32* destination) const;
+
     //---------------------------------------------------------------------------------------------
     static QSharedPointer<DataBlock const> createPowerSpectrum (QSharedPointer<DataBlock const> data_block);
 
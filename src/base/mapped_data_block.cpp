@@ -0,0 +1,245 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "mapped_data_block.h"
+#include "math_utils.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sigviewer {
+
+//-------------------------------------------------------------------------------------------------
+MappedFile::MappedFile (QString const& file_path)
+    : file_ (file_path),
+      data_ (0),
+      size_ (0)
+{
+    if (file_.open (QIODevice::ReadOnly))
+    {
+        size_ = file_.size ();
+        data_ = file_.map (0, size_);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile ()
+{
+    if (data_)
+        file_.unmap (data_);
+}
+
+//-------------------------------------------------------------------------------------------------
+int MappedChannelLayout::bytesPerSample (SampleFormat format)
+{
+    switch (format)
+    {
+    case INT8:
+    case UINT8:
+        return 1;
+    case INT16:
+    case UINT16:
+        return 2;
+    case INT24:
+    case UINT24:
+        return 3;
+    case INT32:
+    case UINT32:
+    case FLOAT32:
+        return 4;
+    case FLOAT64:
+        return 8;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+MappedDataBlock::MappedDataBlock (QSharedPointer<MappedFile const> file, MappedChannelLayout const& layout,
+                                  size_t length, float64 sample_rate_per_unit)
+    : DataBlock (length, sample_rate_per_unit),
+      file_ (file),
+      layout_ (layout),
+      bytes_per_sample_ (MappedChannelLayout::bytesPerSample (layout.format)),
+      start_index_ (0)
+{
+    // nothing to do here
+}
+
+//-------------------------------------------------------------------------------------------------
+MappedDataBlock::MappedDataBlock (MappedDataBlock const& base, size_t new_start, size_t new_length)
+    : DataBlock (base, new_length),
+      file_ (base.file_),
+      layout_ (base.layout_),
+      bytes_per_sample_ (base.bytes_per_sample_),
+      start_index_ (base.start_index_ + new_start)
+{
+    // nothing to do here
+}
+
+//-------------------------------------------------------------------------------------------------
+QSharedPointer<DataBlock> MappedDataBlock::createSubBlock (size_t start, size_t length) const
+{
+    return QSharedPointer<DataBlock> (new MappedDataBlock (*this, start, length));
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 MappedDataBlock::operator[] (size_t index) const
+{
+    return decode (samplePosition (start_index_ + index));
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 MappedDataBlock::getMin () const
+{
+    float32 min = 0;
+    float32 max = 0;
+    getMinMax (0, size (), min, max);
+    return min;
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 MappedDataBlock::getMax () const
+{
+    float32 min = 0;
+    float32 max = 0;
+    getMinMax (0, size (), min, max);
+    return max;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool MappedDataBlock::getMinMax (size_t start, size_t length, float32& min, float32& max) const
+{
+    bool found = false;
+    size_t index = start_index_ + start;
+    size_t end = index + length;
+    while (index < end)
+    {
+        // samples within one record are stored contiguously
+        size_t in_record = index % layout_.samples_per_record;
+        size_t record_end = std::min (end, index - in_record + layout_.samples_per_record);
+        uchar const* sample = samplePosition (index);
+        if (isNativeFloat32 (sample))
+        {
+            float32 record_min = 0;
+            float32 record_max = 0;
+            if (MathUtils_::minMax (reinterpret_cast<float32 const*>(sample), record_end - index,
+                                    record_min, record_max))
+            {
+                if (!found || record_min < min)
+                    min = record_min;
+                if (!found || record_max > max)
+                    max = record_max;
+                found = true;
+            }
+            index = record_end;
+            continue;
+        }
+        for (; index < record_end; index++, sample += bytes_per_sample_)
+        {
+            float32 value = decode (sample);
+            if (std::isnan (value))
+                continue;
+            if (!found || value < min)
+                min = value;
+            if (!found || value > max)
+                max = value;
+            found = true;
+        }
+    }
+    return found;
+}
+
+//-------------------------------------------------------------------------------------------------
+void MappedDataBlock::copyTo (size_t start, size_t length, float32* destination) const
+{
+    size_t index = start_index_ + start;
+    size_t end = index + length;
+    while (index < end)
+    {
+        size_t in_record = index % layout_.samples_per_record;
+        size_t record_end = std::min (end, index - in_record + layout_.samples_per_record);
+        uchar const* sample = samplePosition (index);
+        if (isNativeFloat32 (sample))
+        {
+            float32 const* values = reinterpret_cast<float32 const*>(sample);
+            destination = std::copy (values, values + (record_end - index), destination);
+            index = record_end;
+            continue;
+        }
+        for (; index < record_end; index++, sample += bytes_per_sample_)
+            *destination++ = decode (sample);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+bool MappedDataBlock::isNativeFloat32 (uchar const* sample) const
+{
+    return Q_BYTE_ORDER == Q_LITTLE_ENDIAN &&
+           layout_.format == MappedChannelLayout::FLOAT32 &&
+           layout_.scale == 1 && layout_.offset == 0 && !layout_.overflow_detection &&
+           reinterpret_cast<quintptr>(sample) % alignof (float32) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+uchar const* MappedDataBlock::samplePosition (size_t index) const
+{
+    size_t record = index / layout_.samples_per_record;
+    size_t in_record = index % layout_.samples_per_record;
+    return file_->data () + layout_.first_sample_position + record * layout_.record_size +
+           in_record * bytes_per_sample_;
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 MappedDataBlock::decode (uchar const* sample) const
+{
+    float64 value = 0;
+    switch (layout_.format)
+    {
+    case MappedChannelLayout::INT8:
+        value = static_cast<qint8>(sample[0]);
+        break;
+    case MappedChannelLayout::UINT8:
+        value = sample[0];
+        break;
+    case MappedChannelLayout::INT16:
+        value = qFromLittleEndian<qint16> (sample);
+        break;
+    case MappedChannelLayout::UINT16:
+        value = qFromLittleEndian<quint16> (sample);
+        break;
+    case MappedChannelLayout::INT24:
+        value = static_cast<qint32>((static_cast<quint32>(sample[0]) << 8) |
+                                    (static_cast<quint32>(sample[1]) << 16) |
+                                    (static_cast<quint32>(sample[2]) << 24)) >> 8;
+        break;
+    case MappedChannelLayout::UINT24:
+        value = static_cast<quint32>(sample[0]) |
+                (static_cast<quint32>(sample[1]) << 8) |
+                (static_cast<quint32>(sample[2]) << 16);
+        break;
+    case MappedChannelLayout::INT32:
+        value = qFromLittleEndian<qint32> (sample);
+        break;
+    case MappedChannelLayout::UINT32:
+        value = qFromLittleEndian<quint32> (sample);
+        break;
+    case MappedChannelLayout::FLOAT32:
+        value = qFromLittleEndian<float> (sample);
+        break;
+    case MappedChannelLayout::FLOAT64:
+        value = qFromLittleEndian<double> (sample);
+        break;
+    }
+
+    if (layout_.overflow_detection &&
+        (value <= layout_.digital_min || value >= layout_.digital_max))
+        return NAN;
+
+    return value * layout_.scale + layout_.offset;
+}
+
+}
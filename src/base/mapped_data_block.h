@@ -0,0 +1,129 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef MAPPED_DATA_BLOCK_H
+#define MAPPED_DATA_BLOCK_H
+
+#include "data_block.h"
+
+#include <QFile>
+#include <QSharedPointer>
+
+namespace sigviewer {
+
+//-------------------------------------------------------------------------
+/// MappedFile
+///
+/// read only memory mapping of a whole file
+class MappedFile
+{
+public:
+    //-------------------------------------------------------------------------
+    MappedFile (QString const& file_path);
+
+    //-------------------------------------------------------------------------
+    ~MappedFile ();
+
+    //-------------------------------------------------------------------------
+    /// @return 0 if the file could not be mapped
+    uchar const* data () const {return data_;}
+
+    //-------------------------------------------------------------------------
+    qint64 size () const {return size_;}
+
+private:
+    Q_DISABLE_COPY (MappedFile);
+
+    QFile file_;
+    uchar* data_;
+    qint64 size_;
+};
+
+//-------------------------------------------------------------------------
+/// MappedChannelLayout
+///
+/// position and encoding of the samples of one channel in a file which
+/// stores the data in records of fixed size (e.g. EDF, BDF or GDF)
+struct MappedChannelLayout
+{
+    enum SampleFormat
+    {
+        INT8, UINT8, INT16, UINT16, INT24, UINT24, INT32, UINT32, FLOAT32, FLOAT64
+    };
+
+    qint64 first_sample_position;   // byte position of the channel in the first record
+    qint64 record_size;             // bytes per record
+    size_t samples_per_record;
+    SampleFormat format;            // little endian
+    float64 scale;                  // physical value = digital value * scale + offset
+    float64 offset;
+    bool overflow_detection;        // digital values <= digital_min or >= digital_max are NAN
+    float64 digital_min;
+    float64 digital_max;
+
+    //-------------------------------------------------------------------------
+    /// @return number of bytes of one sample
+    static int bytesPerSample (SampleFormat format);
+};
+
+//-------------------------------------------------------------------------
+/// MappedDataBlock
+///
+/// channel data decoded on access out of a memory mapped file, so the data
+/// is held by the page cache of the operating system instead of the heap
+class MappedDataBlock : public DataBlock
+{
+public:
+    //-------------------------------------------------------------------------
+    /// @param length number of samples of the channel
+    MappedDataBlock (QSharedPointer<MappedFile const> file, MappedChannelLayout const& layout,
+                     size_t length, float64 sample_rate_per_unit);
+
+    //-------------------------------------------------------------------------
+    virtual ~MappedDataBlock () {}
+
+    //-------------------------------------------------------------------------
+    virtual QSharedPointer<DataBlock> createSubBlock (size_t start, size_t length) const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 operator[] (size_t index) const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 getMin () const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 getMax () const;
+
+    //-------------------------------------------------------------------------
+    virtual bool getMinMax (size_t start, size_t length, float32& min, float32& max) const;
+
+    //-------------------------------------------------------------------------
+    virtual void copyTo (size_t start, size_t length, float32* destination) const;
+
+private:
+    Q_DISABLE_COPY (MappedDataBlock);
+
+    //-------------------------------------------------------------------------
+    MappedDataBlock (MappedDataBlock const& base, size_t new_start, size_t new_length);
+
+    //-------------------------------------------------------------------------
+    float32 decode (uchar const* sample) const;
+
+    //-------------------------------------------------------------------------
+    uchar const* samplePosition (size_t index) const;
+
+    //-------------------------------------------------------------------------
+    /// @return true if the samples can be searched in place as float32 values
+    bool isNativeFloat32 (uchar const* sample) const;
+
+    QSharedPointer<MappedFile const> file_;
+    MappedChannelLayout layout_;
+    int bytes_per_sample_;
+    size_t start_index_;
+};
+
+}
+
+#endif // MAPPED_DATA_BLOCK_H
@@ -6,7 +6,16 @@
 #include "math_utils.h"
 
 #include <QDebug>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIGVIEWER_MIN_MAX_SSE
+#include <emmintrin.h>
+#endif
 
 namespace sigviewer
 {
@@ -42,6 +51,86 @@ int sampleRateToDecimalPrecision (float64 sample_rate)
     return precision;
 }
 
+//-----------------------------------------------------------------------------
+bool minMax (float32 const* data, size_t length, float32& min, float32& max)
+{
+    // NANs never win a comparison, so they are skipped without a branch; the
+    // SIMD min/max instructions return their second operand if one is NAN
+    float32 current_min = std::numeric_limits<float32>::infinity ();
+    float32 current_max = -std::numeric_limits<float32>::infinity ();
+    size_t index = 0;
+
+#if defined(__AVX__)
+    if (length >= 16)
+    {
+        __m256 mins_0 = _mm256_set1_ps (current_min);
+        __m256 mins_1 = mins_0;
+        __m256 maxs_0 = _mm256_set1_ps (current_max);
+        __m256 maxs_1 = maxs_0;
+        for (; index + 16 <= length; index += 16)
+        {
+            __m256 values_0 = _mm256_loadu_ps (data + index);
+            __m256 values_1 = _mm256_loadu_ps (data + index + 8);
+            mins_0 = _mm256_min_ps (values_0, mins_0);
+            mins_1 = _mm256_min_ps (values_1, mins_1);
+            maxs_0 = _mm256_max_ps (values_0, maxs_0);
+            maxs_1 = _mm256_max_ps (values_1, maxs_1);
+        }
+        float32 mins[8];
+        float32 maxs[8];
+        _mm256_storeu_ps (mins, _mm256_min_ps (mins_0, mins_1));
+        _mm256_storeu_ps (maxs, _mm256_max_ps (maxs_0, maxs_1));
+        for (int lane = 0; lane < 8; lane++)
+        {
+            current_min = std::min (current_min, mins[lane]);
+            current_max = std::max (current_max, maxs[lane]);
+        }
+    }
+#elif defined(SIGVIEWER_MIN_MAX_SSE)
+    if (length >= 8)
+    {
+        __m128 mins_0 = _mm_set1_ps (current_min);
+        __m128 mins_1 = mins_0;
+        __m128 maxs_0 = _mm_set1_ps (current_max);
+        __m128 maxs_1 = maxs_0;
+        for (; index + 8 <= length; index += 8)
+        {
+            __m128 values_0 = _mm_loadu_ps (data + index);
+            __m128 values_1 = _mm_loadu_ps (data + index + 4);
+            mins_0 = _mm_min_ps (values_0, mins_0);
+            mins_1 = _mm_min_ps (values_1, mins_1);
+            maxs_0 = _mm_max_ps (values_0, maxs_0);
+            maxs_1 = _mm_max_ps (values_1, maxs_1);
+        }
+        float32 mins[4];
+        float32 maxs[4];
+        _mm_storeu_ps (mins, _mm_min_ps (mins_0, mins_1));
+        _mm_storeu_ps (maxs, _mm_max_ps (maxs_0, maxs_1));
+        for (int lane = 0; lane < 4; lane++)
+        {
+            current_min = std::min (current_min, mins[lane]);
+            current_max = std::max (current_max, maxs[lane]);
+        }
+    }
+#endif
+
+    for (; index < length; index++)
+    {
+        float32 value = data[index];
+        if (value < current_min)
+            current_min = value;
+        if (value > current_max)
+            current_max = value;
+    }
+
+    if (current_min > current_max)
+        return false;
+
+    min = current_min;
+    max = current_max;
+    return true;
+}
+
 }
 
 }
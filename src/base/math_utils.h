@@ -21,6 +21,13 @@ float64 round125(float64 value);
 /// @return number of decimals needed to display time intervals correctly
 int sampleRateToDecimalPrecision (float64 sample_rate);
 
+//-----------------------------------------------------------------------------
+/// minimum and maximum of the given values in one pass, NANs are ignored
+///
+/// @return false if there is no value other than NAN; min and max are
+///         left unchanged then
+bool minMax (float32 const* data, size_t length, float32& min, float32& max);
+
 }
 
 }
@@ -0,0 +1,177 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "native_rate_data_block.h"
+#include "math_utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sigviewer
+{
+
+// native positions this close to a native sample are rounded onto it, so
+// rounding errors of the offset do not cut off the first or last sample
+float64 const NativeRateDataBlock::POSITION_TOLERANCE_ = 1e-6;
+
+//-------------------------------------------------------------------------------------------------
+NativeRateDataBlock::NativeRateDataBlock (std::vector<float32> samples, float64 native_sample_rate_per_unit,
+                                          float64 offset, size_t length, float64 sample_rate_per_unit)
+    : DataBlock (length, sample_rate_per_unit),
+      samples_ (new std::vector<float32> (std::move (samples))),
+      native_sample_rate_per_unit_ (native_sample_rate_per_unit),
+      native_samples_per_sample_ (native_sample_rate_per_unit / sample_rate_per_unit),
+      offset_ (offset),
+      start_index_ (0)
+{
+    // nothing to do here
+}
+
+//---------------------------------------------------------------------------------------------
+NativeRateDataBlock::NativeRateDataBlock (NativeRateDataBlock const& base, size_t new_start,
+                                          size_t new_length)
+    : DataBlock (base, new_length),
+      samples_ (base.samples_),
+      native_sample_rate_per_unit_ (base.native_sample_rate_per_unit_),
+      native_samples_per_sample_ (base.native_samples_per_sample_),
+      offset_ (base.offset_),
+      start_index_ (base.start_index_ + new_start)
+{
+    // nothing to do here
+}
+
+//-------------------------------------------------------------------------
+QSharedPointer<DataBlock> NativeRateDataBlock::createSubBlock (size_t start,
+                                                               size_t length) const
+{
+    return QSharedPointer<DataBlock> (new NativeRateDataBlock (*this, start, length));
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 NativeRateDataBlock::operator[] (size_t index) const
+{
+    return interpolate (nativePosition (index));
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 NativeRateDataBlock::getMin () const
+{
+    float32 min = 0;
+    float32 max = 0;
+    getMinMax (0, size (), min, max);
+    return min;
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 NativeRateDataBlock::getMax () const
+{
+    float32 min = 0;
+    float32 max = 0;
+    getMinMax (0, size (), min, max);
+    return max;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool NativeRateDataBlock::getMinMax (size_t start, size_t length, float32& min, float32& max) const
+{
+    Range range = coveredRange (start, length);
+    if (range.begin >= range.end)
+        return false;
+
+    // the interpolated values lie between the native samples around them,
+    // so only the values at both ends have to be interpolated
+    bool found = false;
+    float32 values[2] = {(*this)[range.begin], (*this)[range.end - 1]};
+    for (float32 value : values)
+    {
+        if (std::isnan (value))
+            continue;
+        if (!found || value < min)
+            min = value;
+        if (!found || value > max)
+            max = value;
+        found = true;
+    }
+
+    float64 first = std::floor (nativePosition (range.begin) + POSITION_TOLERANCE_) + 1;
+    float64 last = std::ceil (nativePosition (range.end - 1) - POSITION_TOLERANCE_) - 1;
+    if (first <= last)
+    {
+        float32 native_min = 0;
+        float32 native_max = 0;
+        if (MathUtils_::minMax (samples_->data () + static_cast<size_t> (first),
+                                static_cast<size_t> (last - first) + 1, native_min, native_max))
+        {
+            if (!found || native_min < min)
+                min = native_min;
+            if (!found || native_max > max)
+                max = native_max;
+            found = true;
+        }
+    }
+    return found;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NativeRateDataBlock::copyTo (size_t start, size_t length, float32* destination) const
+{
+    for (size_t index = start; index < start + length; index++)
+        *destination++ = interpolate (nativePosition (index));
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<DataBlock::Range> NativeRateDataBlock::getCoveredRanges (size_t start, size_t length) const
+{
+    Range range = coveredRange (start, length);
+    if (range.begin >= range.end)
+        return std::vector<Range> ();
+    return std::vector<Range> (1, range);
+}
+
+//-------------------------------------------------------------------------------------------------
+float64 NativeRateDataBlock::getNativeSampleRatePerUnit () const
+{
+    return native_sample_rate_per_unit_;
+}
+
+//-------------------------------------------------------------------------------------------------
+float64 NativeRateDataBlock::nativePosition (size_t index) const
+{
+    return (static_cast<float64> (start_index_ + index) - offset_) * native_samples_per_sample_;
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 NativeRateDataBlock::interpolate (float64 position) const
+{
+    float64 last = static_cast<float64> (samples_->size ()) - 1;
+    if (position < -POSITION_TOLERANCE_ || position > last + POSITION_TOLERANCE_)
+        return NAN;
+    position = std::clamp (position, 0.0, last);
+
+    size_t index = static_cast<size_t> (position);
+    if (index + 1 >= samples_->size ())
+        return (*samples_)[index];
+    float32 fraction = position - index;
+    return (*samples_)[index] + fraction * ((*samples_)[index + 1] - (*samples_)[index]);
+}
+
+//-------------------------------------------------------------------------------------------------
+DataBlock::Range NativeRateDataBlock::coveredRange (size_t start, size_t length) const
+{
+    if (samples_->empty () || length == 0)
+        return Range {start, start};
+
+    // samples of the whole channel onto which the first and last native
+    // samples fall
+    float64 first = offset_;
+    float64 last = offset_ + (samples_->size () - 1) / native_samples_per_sample_;
+    float64 begin = std::max<float64> (start, std::ceil (first - start_index_ - POSITION_TOLERANCE_));
+    float64 end = std::min<float64> (start + length, std::floor (last - start_index_ + POSITION_TOLERANCE_) + 1);
+    if (end <= begin)
+        return Range {start, start};
+    return Range {static_cast<size_t> (begin), static_cast<size_t> (end)};
+}
+
+}
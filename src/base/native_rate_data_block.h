@@ -0,0 +1,102 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef NATIVE_RATE_DATA_BLOCK_H
+#define NATIVE_RATE_DATA_BLOCK_H
+
+#include "data_block.h"
+
+#include <QSharedPointer>
+
+#include <vector>
+
+namespace sigviewer {
+
+//-------------------------------------------------------------------------
+/// NativeRateDataBlock
+///
+/// a channel recorded at another sample rate than the block, stored with its
+/// native samples; the samples of the block are linearly interpolated out of
+/// the native ones when accessed, and are NAN before the first and after the
+/// last native sample
+class NativeRateDataBlock : public DataBlock
+{
+public:
+    //-------------------------------------------------------------------------
+    /// @param native_sample_rate_per_unit rate of the given samples
+    /// @param offset position of the first native sample, in samples of the
+    ///               block
+    NativeRateDataBlock (std::vector<float32> samples, float64 native_sample_rate_per_unit,
+                         float64 offset, size_t length, float64 sample_rate_per_unit);
+
+    //-------------------------------------------------------------------------
+    virtual ~NativeRateDataBlock () {}
+
+    //-------------------------------------------------------------------------
+    virtual QSharedPointer<DataBlock> createSubBlock (size_t start, size_t length) const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 operator[] (size_t index) const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 getMin () const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 getMax () const;
+
+    //-------------------------------------------------------------------------
+    /// the native samples between the first and the last sample of the range
+    /// are included, even if no sample of the block falls onto them, so the
+    /// peaks of channels recorded at a higher rate are not lost
+    virtual bool getMinMax (size_t start, size_t length, float32& min, float32& max) const;
+
+    //-------------------------------------------------------------------------
+    virtual void copyTo (size_t start, size_t length, float32* destination) const;
+
+    //-------------------------------------------------------------------------
+    virtual std::vector<Range> getCoveredRanges (size_t start, size_t length) const;
+
+    //-------------------------------------------------------------------------
+    virtual float64 getNativeSampleRatePerUnit () const;
+
+    //-------------------------------------------------------------------------
+    /// the native samples of the whole channel, e.g. to store them
+    std::vector<float32> const& getNativeSamples () const {return *samples_;}
+
+    //-------------------------------------------------------------------------
+    /// position of the first native sample, in samples of this block
+    float64 getOffset () const {return offset_ - start_index_;}
+
+private:
+    Q_DISABLE_COPY (NativeRateDataBlock);
+
+    //-------------------------------------------------------------------------
+    NativeRateDataBlock (NativeRateDataBlock const& base, size_t new_start, size_t new_length);
+
+    //-------------------------------------------------------------------------
+    /// @return the native position of the given sample of the block
+    float64 nativePosition (size_t index) const;
+
+    //-------------------------------------------------------------------------
+    /// @param position native position, NAN outside of the native samples
+    float32 interpolate (float64 position) const;
+
+    //-------------------------------------------------------------------------
+    /// @return the samples of [start, start + length) which lie between the
+    ///         first and the last native sample
+    Range coveredRange (size_t start, size_t length) const;
+
+    static float64 const POSITION_TOLERANCE_;
+
+    QSharedPointer<std::vector<float32> const> samples_;
+    float64 native_sample_rate_per_unit_;
+    float64 native_samples_per_sample_;
+    float64 offset_;
+    size_t start_index_;
+};
+
+}
+
+#endif // NATIVE_RATE_DATA_BLOCK_H
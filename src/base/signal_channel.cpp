@@ -4,7 +4,7 @@
 
 
 #include "signal_channel.h"
-#include "file_handling/xdf_reader.h"
+#include "xdf.h"
 
 namespace sigviewer
 {
@@ -32,14 +32,14 @@ SignalChannel::SignalChannel(unsigned ch, const HDRTYPE* hdr) :
 }
 
 //!Constructor for XDF format---------------------------------------------------
-SignalChannel::SignalChannel(unsigned ch, QString file_format) :
-    label_ (QString::fromStdString(XDFdata->labels[ch]).trimmed())
+SignalChannel::SignalChannel(unsigned ch, Xdf const& xdf, QString file_format) :
+    label_ (QString::fromStdString(xdf.labels[ch]).trimmed())
 {
     //easy extension for potential other formats in the future
     if (file_format.compare("xdf", Qt::CaseInsensitive))
     {
         phys_y_dimension_label_ = QString::number(ch);
-        samplerate_ = XDFdata->majSR;
+        samplerate_ = xdf.majSR;
     }
 }
 
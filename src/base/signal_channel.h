@@ -12,6 +12,8 @@
 #include <QString>
 #include <QMutex>
 
+class Xdf;
+
 namespace sigviewer
 {
 
@@ -23,7 +25,7 @@ class SignalChannel
 public:
     //-------------------------------------------------------------------------
     SignalChannel(unsigned ch, const HDRTYPE* hdr);
-    SignalChannel(unsigned ch, QString file_format);
+    SignalChannel(unsigned ch, Xdf const& xdf, QString file_format);
     SignalChannel(QString label, float64 sample_rate, QString physical_dim = "uV");
 //    SignalChannel(unsigned number, CHANNEL_TYPE C);  /* obsolete, deprecated */
 
@@ -0,0 +1,154 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "sparse_data_block.h"
+#include "math_utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sigviewer
+{
+
+//-------------------------------------------------------------------------------------------------
+SparseDataBlock::SparseDataBlock (std::vector<SparseExtent> extents, size_t length,
+                                  float64 sample_rate_per_unit)
+    : DataBlock (length, sample_rate_per_unit),
+      start_index_ (0)
+{
+    Extents shared_extents;
+    shared_extents.reserve (extents.size ());
+    for (SparseExtent& extent : extents)
+        shared_extents.push_back (QSharedPointer<SparseExtent const> (new SparseExtent (std::move (extent))));
+    extents_ = QSharedPointer<Extents const> (new Extents (std::move (shared_extents)));
+}
+
+//-------------------------------------------------------------------------------------------------
+SparseDataBlock::SparseDataBlock (std::vector<QSharedPointer<SparseExtent const> > extents,
+                                  size_t length, float64 sample_rate_per_unit)
+    : DataBlock (length, sample_rate_per_unit),
+      extents_ (new Extents (std::move (extents))),
+      start_index_ (0)
+{
+    // nothing to do here
+}
+
+//---------------------------------------------------------------------------------------------
+SparseDataBlock::SparseDataBlock (SparseDataBlock const& base, size_t new_start, size_t new_length)
+    : DataBlock (base, new_length),
+      extents_ (base.extents_),
+      start_index_ (base.start_index_ + new_start)
+{
+    // nothing to do here
+}
+
+//-------------------------------------------------------------------------
+QSharedPointer<DataBlock> SparseDataBlock::createSubBlock (size_t start,
+                                                           size_t length) const
+{
+    return QSharedPointer<DataBlock> (new SparseDataBlock (*this, start, length));
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 SparseDataBlock::operator[] (size_t index) const
+{
+    index += start_index_;
+    Extents::const_iterator extent = findExtent (index);
+    if (extent == extents_->end () || (*extent)->start > index)
+        return NAN;
+    return (*extent)->samples[index - (*extent)->start];
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 SparseDataBlock::getMin () const
+{
+    float32 min = 0;
+    float32 max = 0;
+    getMinMax (0, size (), min, max);
+    return min;
+}
+
+//-------------------------------------------------------------------------------------------------
+float32 SparseDataBlock::getMax () const
+{
+    float32 min = 0;
+    float32 max = 0;
+    getMinMax (0, size (), min, max);
+    return max;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SparseDataBlock::getMinMax (size_t start, size_t length, float32& min, float32& max) const
+{
+    bool found = false;
+    size_t begin = start_index_ + start;
+    size_t end = begin + length;
+    for (Extents::const_iterator extent = findExtent (begin);
+         extent != extents_->end () && (*extent)->start < end; ++extent)
+    {
+        size_t extent_begin = std::max (begin, (*extent)->start);
+        size_t extent_end = std::min (end, (*extent)->start + (*extent)->samples.size ());
+        float32 extent_min = 0;
+        float32 extent_max = 0;
+        if (!MathUtils_::minMax ((*extent)->samples.data () + extent_begin - (*extent)->start,
+                                 extent_end - extent_begin, extent_min, extent_max))
+            continue;
+        if (!found || extent_min < min)
+            min = extent_min;
+        if (!found || extent_max > max)
+            max = extent_max;
+        found = true;
+    }
+    return found;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SparseDataBlock::copyTo (size_t start, size_t length, float32* destination) const
+{
+    size_t begin = start_index_ + start;
+    size_t end = begin + length;
+    size_t position = begin;
+    for (Extents::const_iterator extent = findExtent (begin);
+         extent != extents_->end () && (*extent)->start < end; ++extent)
+    {
+        size_t extent_begin = std::max (begin, (*extent)->start);
+        size_t extent_end = std::min (end, (*extent)->start + (*extent)->samples.size ());
+        destination = std::fill_n (destination, extent_begin - position, NAN);
+        float32 const* source = (*extent)->samples.data () + extent_begin - (*extent)->start;
+        destination = std::copy (source, source + extent_end - extent_begin, destination);
+        position = extent_end;
+    }
+    std::fill_n (destination, end - position, NAN);
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector<DataBlock::Range> SparseDataBlock::getCoveredRanges (size_t start, size_t length) const
+{
+    std::vector<Range> ranges;
+    size_t begin = start_index_ + start;
+    size_t end = begin + length;
+    for (Extents::const_iterator extent = findExtent (begin);
+         extent != extents_->end () && (*extent)->start < end; ++extent)
+    {
+        size_t range_begin = std::max (begin, (*extent)->start) - start_index_;
+        size_t range_end = std::min (end, (*extent)->start + (*extent)->samples.size ()) - start_index_;
+        if (!ranges.empty () && ranges.back ().end == range_begin)
+            ranges.back ().end = range_end;
+        else
+            ranges.push_back ({range_begin, range_end});
+    }
+    return ranges;
+}
+
+//-------------------------------------------------------------------------------------------------
+SparseDataBlock::Extents::const_iterator SparseDataBlock::findExtent (size_t index) const
+{
+    return std::partition_point (extents_->begin (), extents_->end (), [index] (QSharedPointer<SparseExtent const> const& extent)
+    {
+        return extent->start + extent->samples.size () <= index;
+    });
+}
+
+}
@@ -0,0 +1,90 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef SPARSE_DATA_BLOCK_H
+#define SPARSE_DATA_BLOCK_H
+
+#include "data_block.h"
+
+#include <QSharedPointer>
+
+#include <vector>
+
+namespace sigviewer {
+
+//-------------------------------------------------------------------------
+/// SparseExtent
+///
+/// consecutive samples of a SparseDataBlock
+struct SparseExtent
+{
+    size_t start;
+    std::vector<float32> samples;
+};
+
+//-------------------------------------------------------------------------
+/// SparseDataBlock
+///
+/// channel data which only covers some parts of the block, e.g. a stream
+/// starting late or recorded only for a short time; just the covered extents
+/// are stored, all other samples are NAN
+class SparseDataBlock : public DataBlock
+{
+public:
+    //-------------------------------------------------------------------------
+    /// @param extents sorted by their start, not overlapping and lying within
+    ///                the length of the block
+    SparseDataBlock (std::vector<SparseExtent> extents, size_t length, float64 sample_rate_per_unit);
+
+    //-------------------------------------------------------------------------
+    /// the extents may be shared with other blocks, e.g. by a reader which
+    /// publishes a new block whenever it has decoded further extents
+    SparseDataBlock (std::vector<QSharedPointer<SparseExtent const> > extents, size_t length,
+                     float64 sample_rate_per_unit);
+
+    //-------------------------------------------------------------------------
+    virtual ~SparseDataBlock () {}
+
+    //-------------------------------------------------------------------------
+    virtual QSharedPointer<DataBlock> createSubBlock (size_t start, size_t length) const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 operator[] (size_t index) const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 getMin () const;
+
+    //-------------------------------------------------------------------------
+    virtual float32 getMax () const;
+
+    //-------------------------------------------------------------------------
+    virtual bool getMinMax (size_t start, size_t length, float32& min, float32& max) const;
+
+    //-------------------------------------------------------------------------
+    virtual void copyTo (size_t start, size_t length, float32* destination) const;
+
+    //-------------------------------------------------------------------------
+    virtual std::vector<Range> getCoveredRanges (size_t start, size_t length) const;
+
+private:
+    Q_DISABLE_COPY (SparseDataBlock);
+
+    typedef std::vector<QSharedPointer<SparseExtent const> > Extents;
+
+    //-------------------------------------------------------------------------
+    SparseDataBlock (SparseDataBlock const& base, size_t new_start, size_t new_length);
+
+    //-------------------------------------------------------------------------
+    /// @return the first extent ending after the given index of the whole
+    ///         channel
+    Extents::const_iterator findExtent (size_t index) const;
+
+    QSharedPointer<Extents const> extents_;
+    size_t start_index_;
+};
+
+}
+
+#endif // SPARSE_DATA_BLOCK_H
@@ -29,6 +29,7 @@ ChangeTypeUndoCommand::~ChangeTypeUndoCommand ()
 //-----------------------------------------------------------------------------
 void ChangeTypeUndoCommand::undo ()
 {
+    signal_event_ = event_manager_->getAndLockEventForEditing (event_id_);
     signal_event_->setType(old_type_);
     event_manager_->updateAndUnlockEvent (signal_event_->getId());
 }
@@ -0,0 +1,38 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "import_events_undo_command.h"
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+ImportEventsUndoCommand::ImportEventsUndoCommand (QSharedPointer<EventManager> event_manager,
+                                                  EventColumns const& events)
+ : event_manager_ (event_manager),
+   events_ (events)
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+ImportEventsUndoCommand::~ImportEventsUndoCommand ()
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+void ImportEventsUndoCommand::undo ()
+{
+    event_manager_->removeEvents (ids_);
+}
+
+//-----------------------------------------------------------------------------
+void ImportEventsUndoCommand::redo ()
+{
+    ids_ = event_manager_->addEvents (events_, ids_);
+}
+
+}
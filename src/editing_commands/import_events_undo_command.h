@@ -0,0 +1,54 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef IMPORT_EVENTS_UNDO_COMMAND_H
+#define IMPORT_EVENTS_UNDO_COMMAND_H
+
+#include "file_handling/event_manager.h"
+
+#include <QUndoCommand>
+#include <QSharedPointer>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// adds imported events through the bulk path of the EventManager
+class ImportEventsUndoCommand : public QUndoCommand
+{
+public:
+    //-------------------------------------------------------------------------
+    ImportEventsUndoCommand (QSharedPointer<EventManager> event_manager,
+                             EventColumns const& events);
+
+    //-------------------------------------------------------------------------
+    virtual ~ImportEventsUndoCommand ();
+
+    //-------------------------------------------------------------------------
+    /// removes the imported events
+    virtual void undo ();
+
+    //-------------------------------------------------------------------------
+    /// adds the events, with their previous ids if they were removed by undo
+    virtual void redo ();
+
+private:
+    QSharedPointer<EventManager> event_manager_;
+    EventColumns events_;
+    QList<EventID> ids_;
+
+    //-------------------------------------------------------------------------
+    /// copy-constructor disabled
+    ImportEventsUndoCommand (ImportEventsUndoCommand const &);
+
+    //-------------------------------------------------------------------------
+    /// assignment-operator disabled
+    ImportEventsUndoCommand& operator= (ImportEventsUndoCommand const &);
+
+};
+
+}
+
+#endif // IMPORT_EVENTS_UNDO_COMMAND_H
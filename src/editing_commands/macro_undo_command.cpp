@@ -9,8 +9,10 @@ namespace sigviewer
 {
 
 //-----------------------------------------------------------------------------
-MacroUndoCommand::MacroUndoCommand (QList<QSharedPointer<QUndoCommand> > const& commands)
-    : commands_ (commands)
+MacroUndoCommand::MacroUndoCommand (QList<QSharedPointer<QUndoCommand> > const& commands,
+                                    QSharedPointer<EventManager> event_manager)
+    : commands_ (commands),
+      event_manager_ (event_manager)
 {
     // nothing to do here
 }
@@ -18,15 +20,23 @@ MacroUndoCommand::MacroUndoCommand (QList<QSharedPointer<QUndoCommand> > const&
 //-----------------------------------------------------------------------------
 void MacroUndoCommand::undo ()
 {
+    if (!event_manager_.isNull ())
+        event_manager_->beginBatch ();
     for (int index = commands_.length () - 1; index > -1; index--)
         commands_[index]->undo ();
+    if (!event_manager_.isNull ())
+        event_manager_->commitBatch ();
 }
 
 //-----------------------------------------------------------------------------
 void MacroUndoCommand::redo ()
 {
+    if (!event_manager_.isNull ())
+        event_manager_->beginBatch ();
     for (int index = 0; index < commands_.length (); index++)
         commands_[index]->redo ();
+    if (!event_manager_.isNull ())
+        event_manager_->commitBatch ();
 }
 
 }
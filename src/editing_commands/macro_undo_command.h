@@ -6,6 +6,8 @@
 #ifndef MACRO_UNDO_COMMAND_H
 #define MACRO_UNDO_COMMAND_H
 
+#include "file_handling/event_manager.h"
+
 #include <QUndoCommand>
 #include <QSharedPointer>
 
@@ -17,7 +19,10 @@ class MacroUndoCommand : public QUndoCommand
 public:
     //-------------------------------------------------------------------------
     /// constructor
-    MacroUndoCommand (QList<QSharedPointer<QUndoCommand> > const& commands);
+    /// @param event_manager if set the commands are executed as one batch of
+    ///        edits of it, which is reported and redrawn once
+    MacroUndoCommand (QList<QSharedPointer<QUndoCommand> > const& commands,
+                      QSharedPointer<EventManager> event_manager = QSharedPointer<EventManager> ());
 
     //-------------------------------------------------------------------------
     /// destructor
@@ -34,6 +39,7 @@ public:
 
 private:
     QList<QSharedPointer<QUndoCommand> > commands_;
+    QSharedPointer<EventManager> event_manager_;
 
     //-------------------------------------------------------------------------
     /// copy-constructor disabled
@@ -31,14 +31,15 @@ void NewEventUndoCommand::undo ()
 {
     event_manager_->removeEvent (created_signal_event_->getId ());
 
-    //If XDF file, also pop back the event added to the XDFdata object earlier
+    //If XDF file, also pop back the event added to the Xdf of the file earlier
     if (event_manager_->getFileType().startsWith("XDF", Qt::CaseInsensitive))
     {
-        XDFdata->userCreatedEvents.pop_back();
-        if (XDFdata->userCreatedEvents.empty())
+        QSharedPointer<Xdf> xdf = event_manager_->getXdf();
+        xdf->userCreatedEvents.pop_back();
+        if (xdf->userCreatedEvents.empty())
         {
-            XDFdata->streams.pop_back();
-            XDFdata->userAddedStream = 0;
+            xdf->streams.pop_back();
+            xdf->userAddedStream = 0;
         }
     }
 }
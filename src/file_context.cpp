@@ -30,6 +30,8 @@ FileContext::FileContext (QString const& file_path_and_name,
 FileContext::~FileContext ()
 {
     qDebug () << "deleting FileContext";
+    // the model renders the signals on other threads out of the channel manager
+    main_signal_vis_model_.clear ();
     delete channel_manager_;
 }
 
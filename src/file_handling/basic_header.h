@@ -13,6 +13,8 @@
 #include <QMap>
 #include <QSharedPointer>
 
+class Xdf;
+
 namespace sigviewer
 {
 
@@ -56,6 +58,10 @@ public:
     virtual QMap<unsigned, QString> getNamesOfUserSpecificEvents () const
     {return QMap<unsigned, QString>();}
 
+    //-------------------------------------------------------------------------
+    /// @return the parsed streams of XDF files, null for other files
+    virtual QSharedPointer<Xdf> getXdf () const {return QSharedPointer<Xdf> ();}
+
     uint32 getNumberEvents() const;
     void setNumberEvents (uint32 number_events);
     double getEventSamplerate() const;
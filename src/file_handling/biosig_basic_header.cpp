@@ -4,7 +4,7 @@
 
 
 #include "biosig_basic_header.h"
-#include "xdf_reader.h"
+#include "xdf.h"
 
 #include <ctime>
 #include <cmath>
@@ -38,24 +38,26 @@ BiosigBasicHeader::BiosigBasicHeader (HDRTYPE* raw_header, QString const& file_p
 }
 
 //!alternative for XDF---------------------------------------------------------
-BiosigBasicHeader::BiosigBasicHeader (QString file_format, QString const& file_path)
+BiosigBasicHeader::BiosigBasicHeader (QString file_format, QString const& file_path,
+                                      QSharedPointer<Xdf> xdf)
     : BasicHeader (file_path),
-      number_samples_ (XDFdata->totalLen)
+      xdf_ (xdf),
+      number_samples_ (xdf->totalLen)
 {
-    if (XDFdata->dictionary.size())
+    if (xdf_->dictionary.size())
     {
-        for (unsigned index = 0; index < XDFdata->dictionary.size(); index++)
+        for (unsigned index = 0; index < xdf_->dictionary.size(); index++)
         {
             //below we use index+1 because in SigViewer, 0 is reserved for a special event type.
             //thus we count from 1
-            user_defined_event_map_[index + 1] = QString::fromStdString(XDFdata->dictionary[index]);
+            user_defined_event_map_[index + 1] = QString::fromStdString(xdf_->dictionary[index]);
         }
     }
 
-    QString fileType = "XDF v" + QString::number(XDFdata->version, 'f', 1);
+    QString fileType = "XDF v" + QString::number(xdf_->version, 'f', 1);
     setFileTypeString (fileType);
 
-    float64 sampling_rate = XDFdata->majSR;
+    float64 sampling_rate = xdf_->majSR;
 
     setSampleRate (sampling_rate);
     readChannelsInfo (file_format);
@@ -90,9 +92,9 @@ void BiosigBasicHeader::readChannelsInfo (HDRTYPE const* raw_header)
 void BiosigBasicHeader::readChannelsInfo (QString file_format)
 {
     unsigned ch = 0;
-    for (unsigned channel_index = 0; channel_index < XDFdata->totalCh; channel_index++)
+    for (unsigned channel_index = 0; channel_index < xdf_->totalCh; channel_index++)
     {
-        QSharedPointer<SignalChannel> channel(new SignalChannel(channel_index, file_format));
+        QSharedPointer<SignalChannel> channel(new SignalChannel(channel_index, *xdf_, file_format));
         addChannel(ch++, channel);
     }
 }
@@ -19,7 +19,8 @@ public:
     BiosigBasicHeader (HDRTYPE* raw_header, QString const& file_path);
 
     //!Alternative constructor for XDF-----------------------------------------
-    BiosigBasicHeader (QString file_format, QString const& file_path);
+    BiosigBasicHeader (QString file_format, QString const& file_path,
+                       QSharedPointer<Xdf> xdf);
 
     //-------------------------------------------------------------------------
     virtual size_t getNumberOfSamples () const;
@@ -27,6 +28,9 @@ public:
     //-------------------------------------------------------------------------
     virtual QMap<unsigned, QString> getNamesOfUserSpecificEvents () const;
 
+    //-------------------------------------------------------------------------
+    virtual QSharedPointer<Xdf> getXdf () const {return xdf_;}
+
 private:
     //-------------------------------------------------------------------------
     void readChannelsInfo (HDRTYPE const* raw_header);
@@ -43,6 +47,7 @@ private:
 
 
 
+    QSharedPointer<Xdf> xdf_;
     unsigned number_samples_;
     QMap<unsigned, QString> user_defined_event_map_;
     QMap<unsigned, QSharedPointer<SignalChannel> > channels_;
@@ -6,13 +6,14 @@
 #include "biosig_reader.h"
 #include "biosig_basic_header.h"
 #include "file_handler_factory_registrator.h"
-#include "gui/progress_bar.h"
 #include "base/fixed_data_block.h"
+#include "base/mapped_data_block.h"
 
 
 #include <QSettings>
 
-
+#include <algorithm>
+#include <cmath>
 
 
 using namespace std;
@@ -20,6 +21,9 @@ using namespace std;
 namespace sigviewer
 {
 
+size_t const BioSigReader::BLOCK_SIZE_IN_BYTES_ = 4 << 20;
+int const BioSigReader::DEFAULT_BLOCK_CACHE_SIZE_IN_MB_ = 256;
+
 //-----------------------------------------------------------------------------
 FILE_SIGNAL_READER_REGISTRATION(gdf, BioSigReader);
 FILE_SIGNAL_READER_REGISTRATION(edf, BioSigReader);
@@ -38,15 +42,24 @@ BioSigReader::BioSigReader() :
     basic_header_ (0),
     biosig_header_ (0),
     buffered_all_channels_ (false),
-    buffered_all_events_ (false)
+    buffered_all_events_ (false),
+    records_per_block_ (1),
+    samples_per_block_ (1),
+    number_blocks_ (0),
+    last_first_block_ (0)
 {
     qDebug () << "Constructed BioSigReader";
-    // nothing to do here
+    QSettings settings;
+    int cache_size = settings.value ("BioSigReader/block_cache_size_mb", DEFAULT_BLOCK_CACHE_SIZE_IN_MB_).toInt();
+    block_cache_.setMaxCost (std::max (1, cache_size) * 1024);
+    prefetch_pool_.setMaxThreadCount (1);
 }
 
 //-----------------------------------------------------------------------------
 BioSigReader::~BioSigReader()
 {
+    prefetch_pool_.clear ();
+    prefetch_pool_.waitForDone ();
     doClose();
 }
 
@@ -80,25 +93,115 @@ QSharedPointer<DataBlock const> BioSigReader::getSignalData (ChannelID channel_i
                                        size_t start_sample,
                                        size_t length) const
 {
+    size_t number_channels = basic_header_->getNumberChannels();
+    size_t number_samples = basic_header_->getNumberOfSamples();
+    if (buffered_all_channels_ || channel_id < 0 ||
+        static_cast<size_t>(channel_id) >= number_channels ||
+        start_sample >= number_samples || length == 0)
+        return QSharedPointer<DataBlock const> (0);
+    length = std::min (length, number_samples - start_sample);
+
+    if (mapped_channels_.contains (channel_id))
+    {
+        if (start_sample == 0 && length == number_samples)
+            return mapped_channels_[channel_id];
+        return mapped_channels_[channel_id]->createSubBlock (start_sample, length);
+    }
+
+    size_t first_block = start_sample / samples_per_block_;
+    size_t last_block = (start_sample + length - 1) / samples_per_block_;
+
+    QSharedPointer<QVector<float32> > data (new QVector<float32> (length));
+    for (size_t block = first_block; block <= last_block; block++)
+    {
+        QSharedPointer<QVector<float32> const> block_data = getBlock (block);
+        size_t block_start = block * samples_per_block_;
+        size_t block_length = block_data->size() / number_channels;
+        size_t from = std::max (start_sample, block_start);
+        size_t to = std::min (start_sample + length, block_start + block_length);
+        float32 const* channel_data = block_data->constData() + channel_id * block_length;
+        std::copy (channel_data + (from - block_start), channel_data + (to - block_start),
+                   data->data() + (from - start_sample));
+    }
+
+    prefetchBlock (first_block, last_block);
+
+    return QSharedPointer<DataBlock const> (new FixedDataBlock (data, basic_header_->getSampleRate()));
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<QVector<float32> const> BioSigReader::getBlock (size_t block) const
+{
+    {
+        QMutexLocker lock (&mutex_);
+        if (QSharedPointer<QVector<float32> const>* cached_block = block_cache_.object (block))
+            return *cached_block;
+    }
+
+    QMutexLocker biosig_lock (&biosig_access_lock_);
+    {
+        // the block may have been read by another thread in the meantime
+        QMutexLocker lock (&mutex_);
+        if (QSharedPointer<QVector<float32> const>* cached_block = block_cache_.object (block))
+            return *cached_block;
+    }
+
+    size_t number_channels = basic_header_->getNumberChannels();
+    size_t start_record = block * records_per_block_;
+    size_t number_records = std::min<size_t> (records_per_block_, biosig_header_->NRec - start_record);
+    size_t block_length = number_records * biosig_header_->SPR;
+
+    read_buffer_.resize (block_length * number_channels);
+    biosig_header_->FLAG.ROW_BASED_CHANNELS = 0;
+    size_t read_records = sread (read_buffer_.data(), start_record, number_records, biosig_header_);
+    size_t read_length = std::min (read_records, number_records) * biosig_header_->SPR;
+
+    // samples missing in the file are marked as NAN
+    QSharedPointer<QVector<float32> > block_data (new QVector<float32> (block_length * number_channels, NAN));
+    for (size_t channel = 0; channel < number_channels; channel++)
+        std::copy (read_buffer_.data() + channel * read_length,
+                   read_buffer_.data() + (channel + 1) * read_length,
+                   block_data->data() + channel * block_length);
+
+    QSharedPointer<QVector<float32> const> const_block_data = block_data;
     QMutexLocker lock (&mutex_);
+    int cost_in_kb = std::max<size_t> (1, block_data->size() * sizeof (float32) / 1024);
+    block_cache_.insert (block, new QSharedPointer<QVector<float32> const> (const_block_data), cost_in_kb);
+    return const_block_data;
+}
 
-    if (!buffered_all_channels_)
-        bufferAllChannels();
+//-----------------------------------------------------------------------------
+void BioSigReader::prefetchBlock (size_t first_block, size_t last_block) const
+{
+    size_t block = 0;
+    {
+        QMutexLocker lock (&mutex_);
+        bool forward = first_block >= last_first_block_;
+        last_first_block_ = first_block;
+        if (forward && last_block + 1 < number_blocks_)
+            block = last_block + 1;
+        else if (!forward && first_block > 0)
+            block = first_block - 1;
+        else
+            return;
 
-    if (!channel_map_.contains(channel_id))
-        return QSharedPointer<DataBlock const> (0);
+        if (block_cache_.contains (block) || prefetching_blocks_.contains (block))
+            return;
+        prefetching_blocks_.insert (block);
+    }
 
-    if (length == basic_header_->getNumberOfSamples() &&
-        start_sample == 0)
-        return channel_map_[channel_id];
-    else
-        return channel_map_[channel_id]->createSubBlock (start_sample, length);
+    prefetch_pool_.start ([this, block] ()
+    {
+        getBlock (block);
+        QMutexLocker lock (&mutex_);
+        prefetching_blocks_.remove (block);
+    });
 }
 
 //-----------------------------------------------------------------------------
 QList<QSharedPointer<SignalEvent const> > BioSigReader::getEvents () const
 {
-    QMutexLocker lock (&mutex_);
+    QMutexLocker lock (&biosig_access_lock_);
     QList<QSharedPointer<SignalEvent const> > empty_list;
     if (!biosig_header_)
         return empty_list;
@@ -160,6 +263,13 @@ QString BioSigReader::loadFixedHeader(const QString& file_name)
 
     convert2to4_eventtable(biosig_header_);
 
+    // channel data is read on demand in blocks of whole records
+    size_t bytes_per_record = std::max<size_t> (1, biosig_header_->SPR * basic_header_->getNumberChannels() * sizeof (float32));
+    records_per_block_ = std::max<size_t> (1, BLOCK_SIZE_IN_BYTES_ / bytes_per_record);
+    samples_per_block_ = std::max<size_t> (1, records_per_block_ * biosig_header_->SPR);
+    number_blocks_ = (biosig_header_->NRec + records_per_block_ - 1) / records_per_block_;
+    mapChannels (file_name);
+
     basic_header_->setNumberEvents(biosig_header_->EVENT.N);
 
     if (biosig_header_->EVENT.SampleRate)
@@ -173,6 +283,70 @@ QString BioSigReader::loadFixedHeader(const QString& file_name)
     return "";
 }
 
+//-----------------------------------------------------------------------------
+void BioSigReader::mapChannels (QString const& file_name)
+{
+    QSettings settings;
+    if (!settings.value ("BioSigReader/memory_map", true).toBool())
+        return;
+
+    if ((biosig_header_->TYPE != EDF && biosig_header_->TYPE != BDF && biosig_header_->TYPE != GDF) ||
+        !biosig_header_->FILE.LittleEndian || biosig_header_->FILE.COMPRESSION ||
+        biosig_header_->NRec <= 0 || biosig_header_->SPR == 0)
+        return;
+
+    QSharedPointer<MappedFile const> file (new MappedFile (file_name));
+    qint64 data_size = static_cast<qint64>(biosig_header_->AS.bpb) * biosig_header_->NRec;
+    if (!file->data() || file->size() < biosig_header_->HeadLen + data_size)
+        return;
+
+    QMap<ChannelID, QSharedPointer<DataBlock const> > mapped_channels;
+    ChannelID id = 0;
+    for (unsigned channel_index = 0; channel_index < biosig_header_->NS; channel_index++)
+    {
+        CHANNEL_TYPE const& channel = biosig_header_->CHANNEL[channel_index];
+        if (!channel.OnOff)
+            continue;
+
+        // channels with a different sample rate are resampled by sread
+        if (channel.SPR != biosig_header_->SPR)
+            return;
+
+        MappedChannelLayout layout;
+        bool integer = true;
+        switch (channel.GDFTYP)
+        {
+        case 1: layout.format = MappedChannelLayout::INT8; break;
+        case 2: layout.format = MappedChannelLayout::UINT8; break;
+        case 3: layout.format = MappedChannelLayout::INT16; break;
+        case 4: layout.format = MappedChannelLayout::UINT16; break;
+        case 5: layout.format = MappedChannelLayout::INT32; break;
+        case 6: layout.format = MappedChannelLayout::UINT32; break;
+        case 16: layout.format = MappedChannelLayout::FLOAT32; integer = false; break;
+        case 17: layout.format = MappedChannelLayout::FLOAT64; integer = false; break;
+        case 255 + 24: layout.format = MappedChannelLayout::INT24; break;
+        case 511 + 24: layout.format = MappedChannelLayout::UINT24; break;
+        default:
+            return;
+        }
+
+        layout.first_sample_position = biosig_header_->HeadLen + channel.bi;
+        layout.record_size = biosig_header_->AS.bpb;
+        layout.samples_per_record = channel.SPR;
+        layout.scale = biosig_header_->FLAG.UCAL ? 1.0 : channel.Cal;
+        layout.offset = biosig_header_->FLAG.UCAL ? 0.0 : channel.Off;
+        layout.overflow_detection = biosig_header_->FLAG.OVERFLOWDETECTION && integer &&
+                                    channel.DigMin < channel.DigMax;
+        layout.digital_min = channel.DigMin;
+        layout.digital_max = channel.DigMax;
+
+        mapped_channels[id++] = QSharedPointer<DataBlock const> (
+                    new MappedDataBlock (file, layout, basic_header_->getNumberOfSamples(),
+                                         basic_header_->getSampleRate()));
+    }
+    mapped_channels_ = mapped_channels;
+}
+
 //-----------------------------------------------------------------------------
 QSharedPointer<BasicHeader> BioSigReader::getBasicHeader ()
 {
@@ -192,37 +366,6 @@ int BioSigReader::setChannelColors()
     return 0;
 }
 
-//-----------------------------------------------------------------------------
-void BioSigReader::bufferAllChannels () const
-{
-    size_t numberOfSamples = biosig_header_->NRec * biosig_header_->SPR;
-    biosig_data_type* read_data = new biosig_data_type[numberOfSamples * basic_header_->getNumberChannels()];
-
-    biosig_header_->FLAG.ROW_BASED_CHANNELS = 0;
-
-    QString progress_name = QObject::tr("Loading data...");
-
-    sread(read_data, 0, biosig_header_->NRec, biosig_header_);
-
-    for (unsigned channel_id = 0; channel_id < basic_header_->getNumberChannels();
-         ++channel_id)
-    {
-        ProgressBar::instance().increaseValue (1, progress_name);
-
-        QSharedPointer<QVector<float32> > raw_data(new QVector<float32> (numberOfSamples, NAN));
-        for (size_t data_index = 0; data_index < numberOfSamples; data_index++)
-            raw_data->operator [](data_index) = read_data[data_index + channel_id * numberOfSamples];
-
-        QSharedPointer<DataBlock const> data_block(new FixedDataBlock(raw_data, basic_header_->getSampleRate()));
-        channel_map_[channel_id] = data_block;
-    }
-
-    buffered_all_channels_ = true;
-    if (buffered_all_events_)
-        doClose();
-    delete[] read_data;
-}
-
 //-------------------------------------------------------------------------
 void BioSigReader::bufferAllEvents () const
 {
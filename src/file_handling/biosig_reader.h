@@ -8,6 +8,12 @@
 
 #include "file_signal_reader.h"
 
+#include <QCache>
+#include <QMap>
+#include <QSet>
+#include <QThreadPool>
+
+#include <vector>
 
 namespace sigviewer
 {
@@ -44,7 +50,19 @@ private:
     QString open (QString const& file_name);
 
     //-------------------------------------------------------------------------
-    void bufferAllChannels () const;
+    /// channels of uncompressed EDF, BDF and GDF files are decoded directly out
+    /// of a memory mapping of the file if their layout allows it
+    void mapChannels (QString const& file_name);
+
+    //-------------------------------------------------------------------------
+    /// @return the samples of all channels of the given block, channel after
+    ///         channel; blocks are read on demand and kept in an LRU cache
+    QSharedPointer<QVector<float32> const> getBlock (size_t block) const;
+
+    //-------------------------------------------------------------------------
+    /// reads the block next to the requested ones in scroll direction in the
+    /// background
+    void prefetchBlock (size_t first_block, size_t last_block) const;
 
     //-------------------------------------------------------------------------
     void applyFilters (double* &in, double* &out, int length) const;
@@ -64,8 +82,20 @@ private:
     mutable HDRTYPE* biosig_header_;
     mutable bool buffered_all_channels_;
     mutable bool buffered_all_events_;
-    mutable QMap<ChannelID, QSharedPointer<DataBlock const> > channel_map_;
     mutable QList<QSharedPointer<SignalEvent const> > events_;
+
+    QMap<ChannelID, QSharedPointer<DataBlock const> > mapped_channels_;
+    size_t records_per_block_;
+    size_t samples_per_block_;
+    size_t number_blocks_;
+    mutable std::vector<biosig_data_type> read_buffer_;
+    mutable QCache<size_t, QSharedPointer<QVector<float32> const> > block_cache_;
+    mutable QSet<size_t> prefetching_blocks_;
+    mutable size_t last_first_block_;
+    mutable QThreadPool prefetch_pool_;
+
+    static size_t const BLOCK_SIZE_IN_BYTES_;
+    static int const DEFAULT_BLOCK_CACHE_SIZE_IN_MB_;
 };
 
 }
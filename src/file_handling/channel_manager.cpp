@@ -7,20 +7,73 @@
 
 #include "gui/progress_bar.h"
 
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <cmath>
 #include <limits>
 
 namespace sigviewer
 {
 
+int const ChannelManager::MIN_MAX_CACHE_SIZE_ = 16;
+size_t const ChannelManager::MIN_MAX_SECTION_SIZE_IN_BYTES_ = 8 << 20;
+size_t const ChannelManager::MIN_MAX_MIN_SECTION_LENGTH_ = 4096;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/// extrema of recently opened files, so reopening a file does not search them again
+struct MinMaxCacheEntry
+{
+    std::map<ChannelID, float64> min_values;
+    std::map<ChannelID, float64> max_values;
+};
+
+QMutex min_max_cache_mutex;
+QMap<QString, MinMaxCacheEntry> min_max_cache;
+QStringList min_max_cache_order;
+
+}
+
 ////-------------------------------------------------------------------------
 //QString ChannelManager::getChannelLabel(ChannelID id, int streamNumber) const
 //{
 
 //}
 
+//-------------------------------------------------------------------------
+QSharedPointer<DataBlock const> ChannelManager::getAvailableData (ChannelID id, unsigned start_pos,
+                                                                  unsigned length) const
+{
+    return getData (id, start_pos, length);
+}
+
+//-------------------------------------------------------------------------
+bool ChannelManager::waitUntilDecoded (int) const
+{
+    return true;
+}
+
+//-------------------------------------------------------------------------
+float64 ChannelManager::getChannelSampleRate (ChannelID) const
+{
+    return getSampleRate ();
+}
+
+//-------------------------------------------------------------------------
+float64 ChannelManager::getChannelTimeOffset (ChannelID) const
+{
+    return 0;
+}
+
+//-------------------------------------------------------------------------
 void ChannelManager::addDownsampledMinMaxVersion (ChannelID id, QSharedPointer<DataBlock const> min,
                                                   QSharedPointer<DataBlock const> max, unsigned factor)
 {
+    QMutexLocker lock (&downsampled_mutex_);
     downsampled_max_map_[id][factor] = max;
     downsampled_min_map_[id][factor] = min;
 }
@@ -28,28 +81,37 @@ void ChannelManager::addDownsampledMinMaxVersion (ChannelID id, QSharedPointer<D
 //-------------------------------------------------------------------------
 unsigned ChannelManager::getNearestDownsamplingFactor (ChannelID id, unsigned factor) const
 {
+    QMutexLocker lock (&downsampled_mutex_);
     if (!downsampled_min_map_.contains (id))
         return 0;
 
-    unsigned nearest_factor = 1;
-    bool search = true;
-    for (nearest_factor = factor + 1; search && (nearest_factor > 1); --nearest_factor)
-        if (downsampled_min_map_[id].contains (nearest_factor - 1))
-            search = false;
+    // largest available factor which is not greater than the requested one
+    QMap<unsigned, QSharedPointer<DataBlock const> > levels = downsampled_min_map_.value (id);
+    QMap<unsigned, QSharedPointer<DataBlock const> >::const_iterator level = levels.upperBound (factor);
+    if (level == levels.constBegin())
+        return 1;
+    return (--level).key();
+}
 
-    return nearest_factor;
+//-------------------------------------------------------------------------
+QList<unsigned> ChannelManager::getDownsamplingFactors (ChannelID id) const
+{
+    QMutexLocker lock (&downsampled_mutex_);
+    return downsampled_min_map_.value (id).keys ();
 }
 
 //-------------------------------------------------------------------------
 QSharedPointer<DataBlock const> ChannelManager::getDownsampledMin (ChannelID id, unsigned factor) const
 {
-    return downsampled_min_map_[id][factor];
+    QMutexLocker lock (&downsampled_mutex_);
+    return downsampled_min_map_.value (id).value (factor);
 }
 
 //-------------------------------------------------------------------------
 QSharedPointer<DataBlock const> ChannelManager::getDownsampledMax (ChannelID id, unsigned factor) const
 {
-    return downsampled_max_map_[id][factor];
+    QMutexLocker lock (&downsampled_mutex_);
+    return downsampled_max_map_.value (id).value (factor);
 }
 
 
@@ -62,8 +124,7 @@ float64 ChannelManager::getValueRange (std::set<ChannelID> const& channels) cons
 //-------------------------------------------------------------------------
 float64 ChannelManager::getMinValue (std::set<ChannelID> const& channels) const
 {
-    if (!min_max_initialized_)
-        initMinMax();
+    initMinMax ();
     float64 min = std::numeric_limits<float64>::max();
     for (const auto channel : channels)
         min = std::min (min, min_values_[channel]);
@@ -73,8 +134,7 @@ float64 ChannelManager::getMinValue (std::set<ChannelID> const& channels) const
 //-------------------------------------------------------------------------
 float64 ChannelManager::getMaxValue (std::set<ChannelID> const& channels) const
 {
-    if (!min_max_initialized_)
-        initMinMax();
+    initMinMax ();
 
     float64 max = std::numeric_limits<float64>::min();
     for (const auto channel : channels)
@@ -85,8 +145,7 @@ float64 ChannelManager::getMaxValue (std::set<ChannelID> const& channels) const
 //-------------------------------------------------------------------------
 float64 ChannelManager::getMinValue (ChannelID channel_id) const
 {
-    if (!min_max_initialized_)
-        initMinMax();
+    initMinMax ();
 
     if (min_values_.count (channel_id))
         return min_values_[channel_id];
@@ -97,8 +156,7 @@ float64 ChannelManager::getMinValue (ChannelID channel_id) const
 //-------------------------------------------------------------------------
 float64 ChannelManager::getMaxValue (ChannelID channel_id) const
 {
-    if (!min_max_initialized_)
-        initMinMax();
+    initMinMax ();
 
     if (max_values_.count (channel_id))
         return max_values_[channel_id];
@@ -106,19 +164,146 @@ float64 ChannelManager::getMaxValue (ChannelID channel_id) const
         return std::numeric_limits<float64>::max();
 }
 
+//-------------------------------------------------------------------------
+bool ChannelManager::getMinMaxValues (std::map<ChannelID, float64>& min_values,
+                                      std::map<ChannelID, float64>& max_values) const
+{
+    QMutexLocker lock (&min_max_mutex_);
+    if (!min_max_initialized_ || min_max_estimated_)
+        return false;
+
+    min_values = min_values_;
+    max_values = max_values_;
+    return true;
+}
+
+//-------------------------------------------------------------------------
+void ChannelManager::setMinMaxValues (std::map<ChannelID, float64> const& min_values,
+                                      std::map<ChannelID, float64> const& max_values)
+{
+    QMutexLocker lock (&min_max_mutex_);
+    min_values_ = min_values;
+    max_values_ = max_values;
+    min_max_initialized_ = true;
+    min_max_estimated_ = false;
+}
+
 //-------------------------------------------------------------------------
 void ChannelManager::initMinMax () const
 {
-    if (min_max_initialized_)
+    if (min_max_initialized_ && !(min_max_estimated_ && waitUntilDecoded (0)))
         return;
-    for (const auto id : getChannels())
+
+    QString cache_key = getMinMaxCacheKey ();
+    if (!cache_key.isEmpty ())
     {
-        QSharedPointer<DataBlock const> data = getData (id, 0, getNumberSamples ());
-        max_values_[id] = data->getMax ();
-        min_values_[id] = data->getMin ();
-        ProgressBar::instance().increaseValue (1, QObject::tr("Searching for Min-Max"));
+        QMutexLocker cache_lock (&min_max_cache_mutex);
+        if (min_max_cache.contains (cache_key))
+        {
+            QMutexLocker lock (&min_max_mutex_);
+            min_values_ = min_max_cache[cache_key].min_values;
+            max_values_ = min_max_cache[cache_key].max_values;
+            min_max_initialized_ = true;
+            min_max_estimated_ = false;
+            return;
+        }
+    }
+
+    // while samples are still decoded in the background, the extrema are
+    // estimated out of the decoded ones; they are neither cached nor
+    // returned by getMinMaxValues
+    bool estimated = !waitUntilDecoded (0);
+    if (estimated)
+        cache_key.clear ();
+
+    std::set<ChannelID> channel_set = getChannels ();
+    QVector<ChannelID> channels (channel_set.begin (), channel_set.end ());
+    int number_channels = channels.size ();
+    size_t number_samples = getNumberSamples ();
+    size_t samples_per_section = std::max<size_t> (MIN_MAX_MIN_SECTION_LENGTH_,
+        MIN_MAX_SECTION_SIZE_IN_BYTES_ / (std::max (1, number_channels) * sizeof (float32)));
+    size_t number_sections = std::max<size_t> (1, (number_samples + samples_per_section - 1) / samples_per_section);
+
+    // extrema per section and channel; NAN if not searched or without values
+    QVector<float32> min_values (number_sections * number_channels, NAN);
+    QVector<float32> max_values (number_sections * number_channels, NAN);
+    float32* min_results = min_values.data ();
+    float32* max_results = max_values.data ();
+
+    // all channels of a section are searched at once, so readers have to read
+    // every part of a file only once; the first section is searched on the
+    // calling thread, as readers may buffer data and report progress on the
+    // first access
+    QAtomicInt cancelled (0);
+    QSemaphore finished_sections;
+    QThreadPool pool;
+    for (size_t section = 0; section < number_sections; section++)
+    {
+        auto search_section = [&, section] ()
+        {
+            size_t start = section * samples_per_section;
+            size_t length = std::min (samples_per_section, number_samples - start);
+            for (int index = 0; index < number_channels && !cancelled.loadRelaxed (); index++)
+            {
+                QSharedPointer<DataBlock const> data = getAvailableData (channels.at (index), start, length);
+                if (!data.isNull ())
+                    data->getMinMax (0, data->size (),
+                                     min_results[section * number_channels + index],
+                                     max_results[section * number_channels + index]);
+            }
+            finished_sections.release ();
+        };
+        if (section == 0)
+            search_section ();
+        else
+            pool.start (search_section);
+    }
+
+    int reported_progress = 0;
+    for (size_t section = 0; section < number_sections; section++)
+    {
+        finished_sections.acquire ();
+        int progress = number_channels * (section + 1) / number_sections;
+        if (!ProgressBar::instance().increaseValue (progress - reported_progress, QObject::tr("Searching for Min-Max")))
+            cancelled.storeRelaxed (1);
+        reported_progress = progress;
+    }
+    pool.waitForDone ();
+
+    // if the search was cancelled, the extrema are estimated out of the
+    // sections searched so far
+    QMutexLocker lock (&min_max_mutex_);
+    for (int index = 0; index < number_channels; index++)
+    {
+        float32 min = NAN;
+        float32 max = NAN;
+        for (size_t section = 0; section < number_sections; section++)
+        {
+            float32 section_min = min_values[section * number_channels + index];
+            float32 section_max = max_values[section * number_channels + index];
+            if (std::isnan (min) || section_min < min)
+                min = section_min;
+            if (std::isnan (max) || section_max > max)
+                max = section_max;
+        }
+        min_values_[channels[index]] = std::isnan (min) ? 0 : min;
+        max_values_[channels[index]] = std::isnan (max) ? 0 : max;
     }
     min_max_initialized_ = true;
+    min_max_estimated_ = estimated;
+    lock.unlock ();
+
+    if (!cache_key.isEmpty () && !cancelled.loadRelaxed ())
+    {
+        QMutexLocker cache_lock (&min_max_cache_mutex);
+        MinMaxCacheEntry& entry = min_max_cache[cache_key];
+        entry.min_values = min_values_;
+        entry.max_values = max_values_;
+        min_max_cache_order.removeAll (cache_key);
+        min_max_cache_order.append (cache_key);
+        while (min_max_cache_order.size () > MIN_MAX_CACHE_SIZE_)
+            min_max_cache.remove (min_max_cache_order.takeFirst ());
+    }
 }
 
 }
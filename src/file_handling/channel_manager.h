@@ -8,6 +8,9 @@
 
 #include "base/data_block.h"
 
+#include <QList>
+#include <QMutex>
+
 #include <set>
 
 namespace sigviewer
@@ -47,6 +50,19 @@ public:
                                                      unsigned start_pos,
                                                      unsigned length) const = 0;
 
+    //-------------------------------------------------------------------------
+    /// like getData, but does not wait for samples which are still decoded
+    /// in the background; these are NAN, e.g. for drawing the signal while a
+    /// file is being decoded
+    virtual QSharedPointer<DataBlock const> getAvailableData (ChannelID id,
+                                                              unsigned start_pos,
+                                                              unsigned length) const;
+
+    //-------------------------------------------------------------------------
+    /// @param timeout_in_ms -1 to wait without a timeout
+    /// @return true if all samples are decoded
+    virtual bool waitUntilDecoded (int timeout_in_ms) const;
+
     //-------------------------------------------------------------------------
     virtual float64 getDurationInSec () const = 0;
 
@@ -57,12 +73,32 @@ public:
     virtual float64 getSampleRate () const = 0;
 
     //-------------------------------------------------------------------------
+    /// rate the channel has been recorded with; getData maps the samples of
+    /// channels recorded at another rate onto getSampleRate
+    virtual float64 getChannelSampleRate (ChannelID id) const;
+
+    //-------------------------------------------------------------------------
+    /// time of the first sample of the channel after the begin of the
+    /// recording in seconds
+    virtual float64 getChannelTimeOffset (ChannelID id) const;
+
+    //-------------------------------------------------------------------------
+    /// thread safe, downsampled versions may be added from background threads
+    ///
+    /// @param factor entry i of min and max covers the samples
+    ///               [i * factor, (i + 1) * factor) of the channel
     void addDownsampledMinMaxVersion (ChannelID id, QSharedPointer<DataBlock const> min,
                                       QSharedPointer<DataBlock const> max, unsigned factor);
 
     //-------------------------------------------------------------------------
+    /// @return the largest available factor not greater than the given one,
+    ///         1 if there is none and 0 if the channel has no downsampled data
     unsigned getNearestDownsamplingFactor (ChannelID id, unsigned factor) const;
 
+    //-------------------------------------------------------------------------
+    /// @return the factors of all downsampled versions of the channel
+    QList<unsigned> getDownsamplingFactors (ChannelID id) const;
+
     //-------------------------------------------------------------------------
     QSharedPointer<DataBlock const> getDownsampledMin (ChannelID id, unsigned factor) const;
 
@@ -84,6 +120,14 @@ public:
     //-------------------------------------------------------------------------
     float64 getMaxValue (ChannelID channel_id) const;
 
+    //-------------------------------------------------------------------------
+    /// does not search the extrema if this has not happened yet; thread safe
+    ///
+    /// @return false if the extrema have not been searched yet or have been
+    ///         estimated while the samples were still decoded
+    bool getMinMaxValues (std::map<ChannelID, float64>& min_values,
+                          std::map<ChannelID, float64>& max_values) const;
+
     //-------------------------------------------------------------------------
     void setXAxisUnitLabel (QString const& label) {x_axis_unit_label_ = label;}
 
@@ -91,19 +135,41 @@ public:
     QString getXAxisUnitLabel () const {return x_axis_unit_label_;}
 
 protected:
-    ChannelManager () : min_max_initialized_ (false) {}
+    ChannelManager () : min_max_initialized_ (false), min_max_estimated_ (false) {}
+
+    //-------------------------------------------------------------------------
+    /// @return a key identifying the underlying data (e.g. file path, size and
+    ///         modification time) to cache the extrema of the channels; an
+    ///         empty string disables caching
+    virtual QString getMinMaxCacheKey () const {return QString ();}
+
+    //-------------------------------------------------------------------------
+    /// sets already known extrema of the channels, so they are not searched
+    void setMinMaxValues (std::map<ChannelID, float64> const& min_values,
+                          std::map<ChannelID, float64> const& max_values);
 
 private:
     //-------------------------------------------------------------------------
+    /// searches the extrema of all channels in parallel sections of the
+    /// signal; if the user cancels, they are estimated out of the sections
+    /// searched so far; extrema estimated while the samples are still decoded
+    /// are searched again once decoding has finished
     void initMinMax () const;
 
+    static int const MIN_MAX_CACHE_SIZE_;
+    static size_t const MIN_MAX_SECTION_SIZE_IN_BYTES_;
+    static size_t const MIN_MAX_MIN_SECTION_LENGTH_;
+
+    mutable QMutex min_max_mutex_;
     mutable bool min_max_initialized_;
+    mutable bool min_max_estimated_;
     mutable std::map<ChannelID, float64> max_values_;
     mutable std::map<ChannelID, float64> min_values_;
     mutable std::map<ChannelID, float64> offsets_;
 
     QString x_axis_unit_label_;
 
+    mutable QMutex downsampled_mutex_;
     QMap<ChannelID, QMap<unsigned, QSharedPointer<DataBlock const> > > downsampled_max_map_; // [channel][factor] -> maximum downsampled_data
     QMap<ChannelID, QMap<unsigned, QSharedPointer<DataBlock const> > > downsampled_min_map_; // [channel][factor] -> minimum downsampled_data
 
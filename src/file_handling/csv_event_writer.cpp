@@ -0,0 +1,168 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "csv_event_writer.h"
+#include "file_handler_factory_registrator.h"
+
+#include <QFile>
+#include <QHash>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <vector>
+
+namespace sigviewer
+{
+
+FILE_SIGNAL_WRITER_REGISTRATION(csv, CSVEventWriter);
+
+int const CSVEventWriter::ROWS_PER_CHUNK_ = 65536;
+
+namespace CSVEventWriter_
+{
+
+struct Row
+{
+    uint32 position;
+    uint32 duration;
+    ChannelID channel;
+    EventType type;
+};
+
+// digits of the longest position, duration, channel and type with their separators
+size_t const MAX_NUMBERS_LENGTH = 10 + 1 + 10 + 1 + 11 + 1 + 5 + 1;
+
+//-----------------------------------------------------------------------------
+/// @return the number of characters written to the buffer
+size_t formatRows (Row const* rows, size_t number_rows,
+                   QHash<EventType, QByteArray> const& names, char* buffer)
+{
+    char* out = buffer;
+    for (size_t index = 0; index < number_rows; index++)
+    {
+        Row const& row = rows[index];
+        out = std::to_chars (out, out + 10, row.position).ptr;
+        *out++ = ',';
+        out = std::to_chars (out, out + 10, row.duration).ptr;
+        *out++ = ',';
+        out = std::to_chars (out, out + 11, row.channel).ptr;
+        *out++ = ',';
+        out = std::to_chars (out, out + 5, row.type).ptr;
+        *out++ = ',';
+        QByteArray const& name = *names.find (row.type);
+        std::memcpy (out, name.constData (), name.size ());
+        out += name.size ();
+        *out++ = '\n';
+    }
+    return out - buffer;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+CSVEventWriter::CSVEventWriter ()
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+CSVEventWriter::CSVEventWriter (QString const& new_file_path)
+    : new_file_path_ (new_file_path)
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+QPair<FileSignalWriter*, QString> CSVEventWriter::createInstance (QString const& file_path)
+{
+    return QPair<FileSignalWriter*, QString> (new CSVEventWriter (file_path), "");
+}
+
+//-----------------------------------------------------------------------------
+QString CSVEventWriter::save (QSharedPointer<FileContext const> file_context,
+                              std::set<EventType> const& types)
+{
+    return saveEvents (file_context->getEventManager (), types);
+}
+
+//-----------------------------------------------------------------------------
+QString CSVEventWriter::saveEvents (QSharedPointer<EventManager const> event_manager,
+                                    std::set<EventType> const& types)
+{
+    using namespace CSVEventWriter_;
+
+    QFile file (new_file_path_);
+    if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate))
+        return QObject::tr("Exporting events to CSV failed!\nIs the target file open in another application?");
+
+    // commas in the names would split the rows
+    QHash<EventType, QByteArray> names;
+    qsizetype max_name_length = 0;
+    for (EventType type : types)
+    {
+        QByteArray name = event_manager->getNameOfEventType (type).remove (',').toUtf8 ();
+        max_name_length = std::max (max_name_length, name.size ());
+        names[type] = name;
+    }
+
+    QList<EventID> ids = event_manager->getEventsByPosition ();
+    std::vector<Row> rows;
+    rows.reserve (ids.size ());
+    event_manager->readEvents ([&] (EventStore const& store)
+    {
+        for (EventID id : ids)
+            if (store.contains (id) && names.contains (store.getType (id)))
+                rows.push_back ({store.getPosition (id), store.getDuration (id),
+                                 store.getChannel (id), store.getType (id)});
+    });
+
+    if (file.write ("position,duration,channel,type,name\n") < 0)
+        return file.errorString ();
+
+    // every thread formats a chunk into its own buffer, the chunks of a wave
+    // are written in order once all of them are formatted
+    QThreadPool* thread_pool = QThreadPool::globalInstance ();
+    size_t const number_chunks = std::max (1, thread_pool->maxThreadCount ());
+    size_t const max_row_length = MAX_NUMBERS_LENGTH + max_name_length + 1;
+    std::vector<std::vector<char> > buffers (std::min<size_t> (number_chunks, rows.size () / ROWS_PER_CHUNK_ + 1));
+    for (std::vector<char>& buffer : buffers)
+        buffer.resize (ROWS_PER_CHUNK_ * max_row_length);
+    std::vector<size_t> lengths (buffers.size ());
+
+    for (size_t wave = 0; wave < rows.size (); wave += buffers.size () * ROWS_PER_CHUNK_)
+    {
+        QSemaphore formatted;
+        size_t number_formatting = 0;
+        for (size_t chunk = 0; chunk < buffers.size (); chunk++)
+        {
+            size_t first_row = wave + chunk * ROWS_PER_CHUNK_;
+            if (first_row >= rows.size ())
+                break;
+            size_t number_rows = std::min<size_t> (ROWS_PER_CHUNK_, rows.size () - first_row);
+            thread_pool->start ([&, chunk, first_row, number_rows] ()
+            {
+                lengths[chunk] = formatRows (rows.data () + first_row, number_rows, names,
+                                             buffers[chunk].data ());
+                formatted.release ();
+            });
+            number_formatting++;
+        }
+        formatted.acquire (static_cast<int>(number_formatting));
+
+        for (size_t chunk = 0; chunk < number_formatting; chunk++)
+            if (file.write (buffers[chunk].data (), lengths[chunk]) != static_cast<qint64>(lengths[chunk]))
+                return file.errorString ();
+    }
+
+    file.close ();
+    if (file.error () != QFileDevice::NoError)
+        return file.errorString ();
+    return "";
+}
+
+}
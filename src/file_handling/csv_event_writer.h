@@ -0,0 +1,61 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef CSV_EVENT_WRITER_H
+#define CSV_EVENT_WRITER_H
+
+#include "file_signal_writer.h"
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// CSVEventWriter
+///
+/// exports the events in order of their positions as
+/// "position,duration,channel,type,name" rows
+///
+/// the rows are formatted in chunks on the thread pool and each chunk is
+/// written at once
+class CSVEventWriter : public FileSignalWriter
+{
+public:
+    //-------------------------------------------------------------------------
+    CSVEventWriter ();
+
+    //-------------------------------------------------------------------------
+    CSVEventWriter (QString const& new_file_path);
+
+    //-------------------------------------------------------------------------
+    virtual QPair<FileSignalWriter*, QString> createInstance (QString const& file_path);
+
+    //-------------------------------------------------------------------------
+    virtual ~CSVEventWriter () {}
+
+    //-------------------------------------------------------------------------
+    virtual QString saveEventsToSignalFile (QSharedPointer<EventManager const>,
+                                            std::set<EventType> const&) {return QObject::tr("not implemented!");}
+
+    //-------------------------------------------------------------------------
+    virtual QString save (QSharedPointer<FileContext const> file_context,
+                          std::set<EventType> const& types);
+
+    //-------------------------------------------------------------------------
+    /// writes the events of the given types
+    /// @return an error message or an empty string
+    QString saveEvents (QSharedPointer<EventManager const> event_manager,
+                        std::set<EventType> const& types);
+
+private:
+    static int const ROWS_PER_CHUNK_;
+
+    QString new_file_path_;
+
+    Q_DISABLE_COPY(CSVEventWriter)
+};
+
+}
+
+#endif // CSV_EVENT_WRITER_H
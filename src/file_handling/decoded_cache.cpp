@@ -0,0 +1,479 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "decoded_cache.h"
+#include "base/native_rate_data_block.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <algorithm>
+#include <vector>
+
+namespace sigviewer
+{
+
+quint32 const DecodedCache::MAGIC_NUMBER_ = 0x53564443; // "SVDC"
+quint32 const DecodedCache::VERSION_ = 2;
+qint64 const DecodedCache::PAGE_SIZE_ = 4096;
+size_t const DecodedCache::WRITE_CHUNK_LENGTH_ = 1 << 16;
+int const DecodedCache::DEFAULT_MAX_SIZE_IN_MB_ = 4096;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+bool isEnabled ()
+{
+    QSettings settings;
+    return settings.value ("DecodedCache/enabled", true).toBool ();
+}
+
+//-----------------------------------------------------------------------------
+/// fills the file with zeros up to the next multiple of page_size
+bool alignToPage (QSaveFile& file, qint64 page_size)
+{
+    qint64 padding = (page_size - file.pos () % page_size) % page_size;
+    return file.write (QByteArray (padding, 0)) == padding;
+}
+
+//-----------------------------------------------------------------------------
+/// writes the values as little endian float32 values at the next page boundary
+///
+/// @param copy_to copies the given range of the values into the buffer
+/// @param position set to the position of the first value in the file
+bool writeArray (QSaveFile& file, size_t number_values,
+                 std::function<void (size_t, size_t, float32*)> const& copy_to,
+                 qint64 page_size, std::vector<float32>& buffer,
+                 std::function<bool ()> const& is_cancelled, quint64& position)
+{
+    if (!alignToPage (file, page_size))
+        return false;
+    position = file.pos ();
+
+    for (size_t start = 0; start < number_values; start += buffer.size ())
+    {
+        if (is_cancelled ())
+            return false;
+        size_t length = std::min (buffer.size (), number_values - start);
+        copy_to (start, length, buffer.data ());
+        for (size_t index = 0; index < length; index++)
+            buffer[index] = qToLittleEndian (buffer[index]);
+        qint64 bytes = length * sizeof (float32);
+        if (file.write (reinterpret_cast<char const*>(buffer.data ()), bytes) != bytes)
+            return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool writeArray (QSaveFile& file, DataBlock const& data, qint64 page_size,
+                 std::vector<float32>& buffer, std::function<bool ()> const& is_cancelled,
+                 quint64& position)
+{
+    return writeArray (file, data.size (),
+                       [&data] (size_t start, size_t length, float32* destination)
+                       {data.copyTo (start, length, destination);},
+                       page_size, buffer, is_cancelled, position);
+}
+
+//-----------------------------------------------------------------------------
+/// channels at another rate than the file are stored with their native
+/// samples, as sampling them onto the samples of the file loses their peaks
+bool writeArray (QSaveFile& file, NativeRateDataBlock const& data, qint64 page_size,
+                 std::vector<float32>& buffer, std::function<bool ()> const& is_cancelled,
+                 quint64& position)
+{
+    std::vector<float32> const& samples = data.getNativeSamples ();
+    return writeArray (file, samples.size (),
+                       [&samples] (size_t start, size_t length, float32* destination)
+                       {std::copy_n (samples.begin () + start, length, destination);},
+                       page_size, buffer, is_cancelled, position);
+}
+
+}
+
+//-----------------------------------------------------------------------------
+DecodedCache::DecodedCache ()
+    : number_samples_ (0),
+      sample_rate_ (0),
+      has_min_max_values_ (false)
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DecodedCache const> DecodedCache::open (QString const& file_path)
+{
+    if (!isEnabled ())
+        return QSharedPointer<DecodedCache const> (0);
+
+    QString file_key = getFileKey (file_path);
+    QString cache_file_path = getCacheFilePath (file_path);
+    if (file_key.isEmpty () || !QFile::exists (cache_file_path))
+        return QSharedPointer<DecodedCache const> (0);
+
+    QSharedPointer<DecodedCache> cache (new DecodedCache);
+    if (!cache->load (cache_file_path, file_key))
+        return QSharedPointer<DecodedCache const> (0);
+    return cache;
+}
+
+//-----------------------------------------------------------------------------
+bool DecodedCache::write (QString const& file_path, ChannelManager const& channel_manager,
+                          QList<QSharedPointer<SignalEvent const> > const& events,
+                          QByteArray const& reader_data,
+                          std::function<bool ()> const& is_cancelled)
+{
+    if (!isEnabled ())
+        return false;
+
+    QString file_key = getFileKey (file_path);
+    std::set<ChannelID> channels = channel_manager.getChannels ();
+    size_t number_samples = channel_manager.getNumberSamples ();
+    if (file_key.isEmpty () || channels.empty () || number_samples == 0)
+        return false;
+
+    // the downsampled versions add a sixth of the channel data
+    QSettings settings;
+    qint64 max_size = settings.value ("DecodedCache/max_size_mb", DEFAULT_MAX_SIZE_IN_MB_).toLongLong () << 20;
+    qint64 channel_size = static_cast<qint64>(number_samples) * sizeof (float32);
+    if (static_cast<qint64>(channels.size ()) * (channel_size + channel_size / 6) > max_size)
+        return false;
+
+    QString cache_file_path = getCacheFilePath (file_path);
+    if (!QDir ().mkpath (QFileInfo (cache_file_path).absolutePath ()))
+        return false;
+
+    QSaveFile file (cache_file_path);
+    if (!file.open (QIODevice::WriteOnly))
+        return false;
+
+    // the first page is reserved for the header, which refers to the metadata
+    // written after all arrays
+    if (file.write (QByteArray (PAGE_SIZE_, 0)) != PAGE_SIZE_)
+        return false;
+
+    std::vector<float32> buffer (WRITE_CHUNK_LENGTH_);
+    QMap<qint32, quint64> channel_positions;
+    QMap<qint32, QSharedPointer<NativeRateDataBlock const> > native_rate_channels;
+    for (ChannelID id : channels)
+    {
+        QSharedPointer<DataBlock const> data = channel_manager.getData (id, 0, number_samples);
+        if (data.isNull ())
+            return false;
+
+        QSharedPointer<NativeRateDataBlock const> native_rate_data = data.dynamicCast<NativeRateDataBlock const> ();
+        if (native_rate_data.isNull ())
+        {
+            if (!writeArray (file, *data, PAGE_SIZE_, buffer, is_cancelled, channel_positions[id]))
+                return false;
+        }
+        else
+        {
+            native_rate_channels[id] = native_rate_data;
+            if (!writeArray (file, *native_rate_data, PAGE_SIZE_, buffer, is_cancelled, channel_positions[id]))
+                return false;
+        }
+    }
+
+    // only levels available for all channels are stored
+    QMap<quint32, QMap<qint32, QPair<quint64, quint64> > > level_positions;
+    for (unsigned factor : channel_manager.getDownsamplingFactors (*channels.begin ()))
+    {
+        bool complete = true;
+        for (ChannelID id : channels)
+            complete = complete && !channel_manager.getDownsampledMin (id, factor).isNull () &&
+                       !channel_manager.getDownsampledMax (id, factor).isNull ();
+        if (!complete)
+            continue;
+
+        QMap<qint32, QPair<quint64, quint64> >& positions = level_positions[factor];
+        for (ChannelID id : channels)
+        {
+            if (!writeArray (file, *channel_manager.getDownsampledMin (id, factor), PAGE_SIZE_,
+                             buffer, is_cancelled, positions[id].first) ||
+                !writeArray (file, *channel_manager.getDownsampledMax (id, factor), PAGE_SIZE_,
+                             buffer, is_cancelled, positions[id].second))
+                return false;
+        }
+    }
+
+    QByteArray metadata;
+    QDataStream metadata_stream (&metadata, QIODevice::WriteOnly);
+    metadata_stream.setVersion (QDataStream::Qt_6_0);
+    metadata_stream << static_cast<quint64>(number_samples) << channel_manager.getSampleRate ();
+    metadata_stream << channel_positions;
+
+    metadata_stream << static_cast<quint32>(native_rate_channels.size ());
+    for (auto channel = native_rate_channels.cbegin (); channel != native_rate_channels.cend (); ++channel)
+        metadata_stream << channel.key ()
+                        << static_cast<quint64>(channel.value ()->getNativeSamples ().size ())
+                        << channel.value ()->getNativeSampleRatePerUnit ()
+                        << channel.value ()->getOffset ();
+
+    std::map<ChannelID, float64> min_values;
+    std::map<ChannelID, float64> max_values;
+    bool has_min_max_values = channel_manager.getMinMaxValues (min_values, max_values);
+    metadata_stream << has_min_max_values;
+    if (has_min_max_values)
+        for (ChannelID id : channels)
+            metadata_stream << static_cast<qint32>(id) << min_values[id] << max_values[id];
+
+    metadata_stream << level_positions;
+
+    metadata_stream << static_cast<quint32>(events.size ());
+    for (QSharedPointer<SignalEvent const> const& event : events)
+        metadata_stream << static_cast<quint64>(event->getPosition ())
+                        << static_cast<quint16>(event->getType ())
+                        << static_cast<qint32>(event->getChannel ())
+                        << static_cast<quint64>(event->getDuration ())
+                        << static_cast<qint32>(event->getStream ())
+                        << event->getSampleRate ();
+
+    metadata_stream << reader_data;
+
+    if (!alignToPage (file, PAGE_SIZE_))
+        return false;
+    quint64 metadata_position = file.pos ();
+    if (file.write (metadata) != metadata.size ())
+        return false;
+
+    QByteArray header;
+    QDataStream header_stream (&header, QIODevice::WriteOnly);
+    header_stream.setVersion (QDataStream::Qt_6_0);
+    header_stream << MAGIC_NUMBER_ << VERSION_ << file_key
+                  << metadata_position << static_cast<quint64>(metadata.size ());
+    if (header.size () > PAGE_SIZE_ || !file.seek (0) || file.write (header) != header.size ())
+        return false;
+
+    if (is_cancelled () || !file.commit ())
+        return false;
+
+    removeOldCaches (cache_file_path);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+QString DecodedCache::getFileKey (QString const& file_path)
+{
+    QFileInfo file_info (file_path);
+    if (!file_info.exists ())
+        return QString ();
+    return QString ("%1|%2|%3").arg (file_info.canonicalFilePath ())
+                               .arg (file_info.size ())
+                               .arg (file_info.lastModified ().toMSecsSinceEpoch ());
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> DecodedCache::getChannel (ChannelID id) const
+{
+    return channels_.value (id);
+}
+
+//-----------------------------------------------------------------------------
+bool DecodedCache::getMinMaxValues (std::map<ChannelID, float64>& min_values,
+                                    std::map<ChannelID, float64>& max_values) const
+{
+    if (!has_min_max_values_)
+        return false;
+
+    min_values = min_values_;
+    max_values = max_values_;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> DecodedCache::getDownsampledMin (ChannelID id, unsigned factor) const
+{
+    return downsampled_min_.value (factor).value (id);
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> DecodedCache::getDownsampledMax (ChannelID id, unsigned factor) const
+{
+    return downsampled_max_.value (factor).value (id);
+}
+
+//-----------------------------------------------------------------------------
+bool DecodedCache::load (QString const& cache_file_path, QString const& file_key)
+{
+    file_ = QSharedPointer<MappedFile const> (new MappedFile (cache_file_path));
+    if (!file_->data () || file_->size () < PAGE_SIZE_)
+        return false;
+    quint64 file_size = file_->size ();
+    char const* data = reinterpret_cast<char const*>(file_->data ());
+
+    QByteArray header = QByteArray::fromRawData (data, PAGE_SIZE_);
+    QDataStream header_stream (header);
+    header_stream.setVersion (QDataStream::Qt_6_0);
+    quint32 magic_number = 0;
+    quint32 version = 0;
+    QString key;
+    quint64 metadata_position = 0;
+    quint64 metadata_size = 0;
+    header_stream >> magic_number >> version >> key >> metadata_position >> metadata_size;
+    if (header_stream.status () != QDataStream::Ok || magic_number != MAGIC_NUMBER_ ||
+        version != VERSION_ || key != file_key ||
+        metadata_position > file_size || metadata_size > file_size - metadata_position)
+        return false;
+
+    QByteArray metadata = QByteArray::fromRawData (data + metadata_position, metadata_size);
+    QDataStream metadata_stream (metadata);
+    metadata_stream.setVersion (QDataStream::Qt_6_0);
+
+    quint64 number_samples = 0;
+    QMap<qint32, quint64> channel_positions;
+    metadata_stream >> number_samples >> sample_rate_ >> channel_positions;
+    number_samples_ = number_samples;
+    if (metadata_stream.status () != QDataStream::Ok || number_samples_ == 0 || channel_positions.isEmpty ())
+        return false;
+
+    // the native samples are copied out of the mapping, as NativeRateDataBlock
+    // holds its samples in memory
+    quint32 number_native_rate_channels = 0;
+    metadata_stream >> number_native_rate_channels;
+    for (quint32 index = 0; index < number_native_rate_channels; index++)
+    {
+        qint32 id = 0;
+        quint64 number_native_samples = 0;
+        float64 native_sample_rate = 0;
+        float64 offset = 0;
+        metadata_stream >> id >> number_native_samples >> native_sample_rate >> offset;
+        if (metadata_stream.status () != QDataStream::Ok || !channel_positions.contains (id) ||
+            native_sample_rate <= 0)
+            return false;
+
+        QSharedPointer<DataBlock const> native_samples = createBlock (channel_positions[id], number_native_samples,
+                                                                      native_sample_rate);
+        if (native_samples.isNull ())
+            return false;
+        std::vector<float32> samples (number_native_samples);
+        native_samples->copyTo (0, samples.size (), samples.data ());
+        channels_[id] = QSharedPointer<DataBlock const> (new NativeRateDataBlock (std::move (samples), native_sample_rate,
+                                                                                 offset, number_samples_, sample_rate_));
+    }
+
+    for (auto position = channel_positions.cbegin (); position != channel_positions.cend (); ++position)
+    {
+        if (channels_.contains (position.key ()))
+            continue;
+        channels_[position.key ()] = createBlock (position.value (), number_samples_, sample_rate_);
+        if (channels_[position.key ()].isNull ())
+            return false;
+    }
+
+    metadata_stream >> has_min_max_values_;
+    if (has_min_max_values_)
+    {
+        for (int index = 0; index < channel_positions.size (); index++)
+        {
+            qint32 id = 0;
+            float64 min = 0;
+            float64 max = 0;
+            metadata_stream >> id >> min >> max;
+            min_values_[id] = min;
+            max_values_[id] = max;
+        }
+    }
+
+    QMap<quint32, QMap<qint32, QPair<quint64, quint64> > > level_positions;
+    metadata_stream >> level_positions;
+    for (auto level = level_positions.cbegin (); level != level_positions.cend (); ++level)
+    {
+        unsigned factor = level.key ();
+        if (factor == 0)
+            return false;
+        size_t length = (number_samples_ + factor - 1) / factor;
+        for (auto position = level.value ().cbegin (); position != level.value ().cend (); ++position)
+        {
+            QSharedPointer<DataBlock const> min = createBlock (position.value ().first, length, sample_rate_ / factor);
+            QSharedPointer<DataBlock const> max = createBlock (position.value ().second, length, sample_rate_ / factor);
+            if (min.isNull () || max.isNull ())
+                return false;
+            downsampled_min_[factor][position.key ()] = min;
+            downsampled_max_[factor][position.key ()] = max;
+        }
+    }
+
+    quint32 number_events = 0;
+    metadata_stream >> number_events;
+    for (quint32 index = 0; index < number_events && metadata_stream.status () == QDataStream::Ok; index++)
+    {
+        quint64 position = 0;
+        quint16 type = 0;
+        qint32 channel = 0;
+        quint64 duration = 0;
+        qint32 stream = 0;
+        float64 sample_rate = 0;
+        metadata_stream >> position >> type >> channel >> duration >> stream >> sample_rate;
+        events_.append (QSharedPointer<SignalEvent const> (
+                            new SignalEvent (position, type, sample_rate, stream, channel, duration)));
+    }
+
+    metadata_stream >> reader_data_;
+    return metadata_stream.status () == QDataStream::Ok;
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> DecodedCache::createBlock (quint64 position, size_t length,
+                                                           float64 sample_rate) const
+{
+    quint64 file_size = file_->size ();
+    if (length == 0 || position % sizeof (float32) != 0 || position > file_size ||
+        length > (file_size - position) / sizeof (float32))
+        return QSharedPointer<DataBlock const> (0);
+
+    MappedChannelLayout layout;
+    layout.first_sample_position = position;
+    layout.record_size = length * sizeof (float32);
+    layout.samples_per_record = length;
+    layout.format = MappedChannelLayout::FLOAT32;
+    layout.scale = 1;
+    layout.offset = 0;
+    layout.overflow_detection = false;
+    layout.digital_min = 0;
+    layout.digital_max = 0;
+    return QSharedPointer<DataBlock const> (new MappedDataBlock (file_, layout, length, sample_rate));
+}
+
+//-----------------------------------------------------------------------------
+QString DecodedCache::getCacheFilePath (QString const& file_path)
+{
+    QByteArray hash = QCryptographicHash::hash (QFileInfo (file_path).canonicalFilePath ().toUtf8 (),
+                                                QCryptographicHash::Sha1);
+    return QStandardPaths::writableLocation (QStandardPaths::CacheLocation) +
+           "/decoded/" + QString::fromLatin1 (hash.toHex ()) + ".cache";
+}
+
+//-----------------------------------------------------------------------------
+void DecodedCache::removeOldCaches (QString const& keep_file_path)
+{
+    QSettings settings;
+    qint64 max_size = settings.value ("DecodedCache/max_size_mb", DEFAULT_MAX_SIZE_IN_MB_).toLongLong () << 20;
+
+    // the most recently written caches are kept
+    QFileInfo keep_file (keep_file_path);
+    QFileInfoList caches = QDir (keep_file.absolutePath ()).entryInfoList (QStringList () << "*.cache",
+                                                                           QDir::Files, QDir::Time);
+    qint64 size = keep_file.size ();
+    for (QFileInfo const& cache : caches)
+    {
+        if (cache.absoluteFilePath () == keep_file.absoluteFilePath ())
+            continue;
+        size += cache.size ();
+        if (size > max_size)
+            QFile::remove (cache.absoluteFilePath ());
+    }
+}
+
+}
@@ -0,0 +1,136 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef DECODED_CACHE_H
+#define DECODED_CACHE_H
+
+#include "channel_manager.h"
+#include "base/mapped_data_block.h"
+#include "base/signal_event.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QSharedPointer>
+#include <QString>
+
+#include <functional>
+#include <map>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// DecodedCache
+///
+/// sidecar file in the cache directory of the user holding the decoded
+/// channels of a signal file together with their extrema, their downsampled
+/// min/max versions, the events and reader specific data
+///
+/// all arrays are stored channel-major as float32 at page aligned positions
+/// and are used directly out of a memory mapping of the cache, so reopening a
+/// file which has to be parsed and resampled completely (e.g. XDF) only takes
+/// the time to map the cache; channels at another rate than the file (see
+/// NativeRateDataBlock) are stored with their native samples, which are read
+/// into memory when the cache is opened; a cache is only used as long as the
+/// path, the size and the modification time of the signal file are unchanged
+class DecodedCache
+{
+public:
+    //-------------------------------------------------------------------------
+    /// @return 0 if caching is disabled or there is no valid cache of the file
+    static QSharedPointer<DecodedCache const> open (QString const& file_path);
+
+    //-------------------------------------------------------------------------
+    /// writes the cache of the given file out of the data of the channel
+    /// manager; it is written to a temporary file first, so an interrupted
+    /// write never leaves a broken cache behind
+    ///
+    /// @param is_cancelled polled while writing, the write is aborted if it
+    ///                     returns true
+    /// @return true if the cache has been written
+    static bool write (QString const& file_path, ChannelManager const& channel_manager,
+                       QList<QSharedPointer<SignalEvent const> > const& events,
+                       QByteArray const& reader_data,
+                       std::function<bool ()> const& is_cancelled);
+
+    //-------------------------------------------------------------------------
+    /// @return "canonical path|size|modification time" of the file or an
+    ///         empty string if it does not exist
+    static QString getFileKey (QString const& file_path);
+
+    //-------------------------------------------------------------------------
+    size_t getNumberSamples () const {return number_samples_;}
+
+    //-------------------------------------------------------------------------
+    float64 getSampleRate () const {return sample_rate_;}
+
+    //-------------------------------------------------------------------------
+    /// @return 0 if the channel is not cached
+    QSharedPointer<DataBlock const> getChannel (ChannelID id) const;
+
+    //-------------------------------------------------------------------------
+    /// @return false if the extrema have not been cached
+    bool getMinMaxValues (std::map<ChannelID, float64>& min_values,
+                          std::map<ChannelID, float64>& max_values) const;
+
+    //-------------------------------------------------------------------------
+    QList<unsigned> getDownsamplingFactors () const {return downsampled_min_.keys ();}
+
+    //-------------------------------------------------------------------------
+    QSharedPointer<DataBlock const> getDownsampledMin (ChannelID id, unsigned factor) const;
+
+    //-------------------------------------------------------------------------
+    QSharedPointer<DataBlock const> getDownsampledMax (ChannelID id, unsigned factor) const;
+
+    //-------------------------------------------------------------------------
+    QList<QSharedPointer<SignalEvent const> > getEvents () const {return events_;}
+
+    //-------------------------------------------------------------------------
+    /// data stored by the reader of the file to restore its state
+    QByteArray getReaderData () const {return reader_data_;}
+
+private:
+    //-------------------------------------------------------------------------
+    DecodedCache ();
+
+    //-------------------------------------------------------------------------
+    /// @return false if the cache is broken or belongs to another state of the file
+    bool load (QString const& cache_file_path, QString const& file_key);
+
+    //-------------------------------------------------------------------------
+    /// @return 0 if the array does not lie within the cache file
+    QSharedPointer<DataBlock const> createBlock (quint64 position, size_t length,
+                                                 float64 sample_rate) const;
+
+    //-------------------------------------------------------------------------
+    static QString getCacheFilePath (QString const& file_path);
+
+    //-------------------------------------------------------------------------
+    /// deletes the least recently written caches exceeding the maximum size
+    static void removeOldCaches (QString const& keep_file_path);
+
+    static quint32 const MAGIC_NUMBER_;
+    static quint32 const VERSION_;
+    static qint64 const PAGE_SIZE_;
+    static size_t const WRITE_CHUNK_LENGTH_;
+    static int const DEFAULT_MAX_SIZE_IN_MB_;
+
+    QSharedPointer<MappedFile const> file_;
+    size_t number_samples_;
+    float64 sample_rate_;
+    QMap<ChannelID, QSharedPointer<DataBlock const> > channels_;
+    bool has_min_max_values_;
+    std::map<ChannelID, float64> min_values_;
+    std::map<ChannelID, float64> max_values_;
+    QMap<unsigned, QMap<ChannelID, QSharedPointer<DataBlock const> > > downsampled_min_;
+    QMap<unsigned, QMap<ChannelID, QSharedPointer<DataBlock const> > > downsampled_max_;
+    QList<QSharedPointer<SignalEvent const> > events_;
+    QByteArray reader_data_;
+};
+
+}
+
+#endif // DECODED_CACHE_H
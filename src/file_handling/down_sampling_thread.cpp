@@ -5,36 +5,55 @@
 
 #include "down_sampling_thread.h"
 
-#include <fstream>
-
-#include "signal_processing/SPUC/butterworth.h"
 #include "base/fixed_data_block.h"
+#include "base/math_utils.h"
 #include "gui/background_processes.h"
 
-#include <vector>
-#include <QMessageBox>
-#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-namespace SigViewer_
+namespace sigviewer
 {
 
-QString DownSamplingThread::PROCESS_NAME_ ("Downsampling...");
+int const DownSamplingThread::DECODING_UPDATE_INTERVAL_IN_MS_ = 250;
+unsigned const DownSamplingThread::FIRST_FACTOR_ = 16;
+unsigned const DownSamplingThread::DOWNSAMPLING_STEP_ = 4;
+size_t const DownSamplingThread::MIN_DOWNSAMPLED_LENGTH_ = 1024;
+size_t const DownSamplingThread::SECTION_SIZE_IN_BYTES_ = 8 << 20;
+QString const DownSamplingThread::PROCESS_NAME_ ("Downsampling...");
+
+namespace
+{
 
 //-----------------------------------------------------------------------------
-DownSamplingThread::DownSamplingThread (QList<QSharedPointer<DataBlock> > data, unsigned downsampling_step, unsigned downsampling_max) :
-    basis_data_ (data),
-    data_ (data),
-    downsampling_step_ (downsampling_step),
-    downsampling_max_ (downsampling_max)
+/// writes the minimum of every "factor" values of min_source to min_out and
+/// the maximum of every "factor" values of max_source to max_out; bins without
+/// any value other than NAN become NAN
+void reduceMinMax (float32 const* min_source, float32 const* max_source,
+                   size_t length, unsigned factor,
+                   float32* min_out, float32* max_out)
 {
+    for (size_t bin_start = 0; bin_start < length; bin_start += factor)
+    {
+        size_t bin_length = std::min<size_t> (factor, length - bin_start);
+        float32 min = std::numeric_limits<float32>::quiet_NaN ();
+        float32 max = std::numeric_limits<float32>::quiet_NaN ();
+        float32 unused = 0;
+        MathUtils_::minMax (min_source + bin_start, bin_length, min, unused);
+        MathUtils_::minMax (max_source + bin_start, bin_length, unused, max);
+        *min_out++ = min;
+        *max_out++ = max;
+    }
+}
 
 }
 
 //-----------------------------------------------------------------------------
-DownSamplingThread::DownSamplingThread (QSharedPointer<ChannelManager> channel_manager, unsigned downsampling_step, unsigned downsampling_max)
+DownSamplingThread::DownSamplingThread (ChannelManager& channel_manager)
     : channel_manager_ (channel_manager),
-      downsampling_step_ (downsampling_step),
-      downsampling_max_ (downsampling_max)
+      cancelled_ (0),
+      processed_sections_ (0)
 {
 
 }
@@ -42,126 +61,183 @@ DownSamplingThread::DownSamplingThread (QSharedPointer<ChannelManager> channel_m
 //-----------------------------------------------------------------------------
 DownSamplingThread::~DownSamplingThread ()
 {
-    BackgroundProcesses::instance().removeProcess (PROCESS_NAME_);
+    cancel ();
 }
 
 //-----------------------------------------------------------------------------
-void DownSamplingThread::run ()
+void DownSamplingThread::cancel ()
 {
-    running_ = true;
+    cancelled_.storeRelaxed (1);
+    pool_.clear ();
+    wait ();
+}
 
-    qDebug () << "DownSamplingThread::run started downsampling; QThread::currentThread = " << QThread::currentThread();
+//-----------------------------------------------------------------------------
+bool DownSamplingThread::isCancelled () const
+{
+    return cancelled_.loadRelaxed () != 0;
+}
 
-    if (!channel_manager_.isNull())
-        minMaxDownsampling ();
-    else
-        downsampleAllOnBasisData ();
-    //downsampleOnDownsampledData ();
+//-----------------------------------------------------------------------------
+void DownSamplingThread::run ()
+{
+    // the downsampled versions need all samples; until the reader has
+    // decoded them, the view is updated with the samples decoded so far
+    bool decoding = false;
+    while (!channel_manager_.waitUntilDecoded (DECODING_UPDATE_INTERVAL_IN_MS_))
+    {
+        if (isCancelled ())
+            return;
+        emit decodedDataAvailable ();
+        decoding = true;
+    }
+    if (decoding)
+        emit decodedDataAvailable ();
+
+    size_t number_samples = channel_manager_.getNumberSamples ();
+    QList<unsigned> factors;
+    for (unsigned factor = FIRST_FACTOR_;
+         number_samples / factor >= MIN_DOWNSAMPLED_LENGTH_;
+         factor *= DOWNSAMPLING_STEP_)
+        factors.append (factor);
+
+    std::set<ChannelID> channel_set = channel_manager_.getChannels ();
+    QVector<ChannelID> channels (channel_set.begin (), channel_set.end ());
+    if (channels.isEmpty ())
+        return;
+
+    // nothing is read if all versions are available already (e.g. out of a
+    // cache)
+    QList<unsigned> available_factors = channel_manager_.getDownsamplingFactors (channels.first ());
+    bool complete = true;
+    for (unsigned factor : factors)
+        complete = complete && available_factors.contains (factor);
+    if (factors.isEmpty () || complete)
+        return;
+
+    size_t section_length = getSectionLength (factors.first (), channels.size ());
+    processed_sections_.storeRelaxed (0);
+    BackgroundProcesses::instance().addProcess (PROCESS_NAME_,
+                                                (number_samples + section_length - 1) / section_length);
+
+    if (downsample (channels, factors))
+        emit downsampledDataAvailable ();
 
-    qDebug () << "DownSamplingThread::run FINISHED!";
+    BackgroundProcesses::instance().removeProcess (PROCESS_NAME_);
 
-    running_ = false;
+    if (!isCancelled ())
+        emit downsamplingFinished ();
 }
 
-//-------------------------------------------------------------------------
-void DownSamplingThread::minMaxDownsampling ()
+//-----------------------------------------------------------------------------
+size_t DownSamplingThread::getSectionLength (unsigned factor, int number_channels) const
 {
-
+    size_t length = SECTION_SIZE_IN_BYTES_ / (std::max (1, number_channels) * sizeof (float32));
+    return std::max<size_t> (1, length / factor) * factor;
 }
 
-//-------------------------------------------------------------------------
-void DownSamplingThread::downsampleAllOnBasisData ()
+//-----------------------------------------------------------------------------
+bool DownSamplingThread::downsample (QVector<ChannelID> const& channels, QList<unsigned> const& factors)
 {
-    QMap<unsigned, QVector<QSharedPointer<QVector<float32> > > > raw_downsampled_data;
-    QMap<unsigned, QVector<QSharedPointer<SPUC::butterworth<float32> > > > low_pass_filters;
-    QMap<unsigned, QVector<float32> > sample_rates;
-    unsigned max_channel_length = 0;
-
-    for (unsigned downsampling_factor = downsampling_step_;
-         downsampling_factor < downsampling_max_;
-         downsampling_factor *= downsampling_step_)
+    size_t number_samples = channel_manager_.getNumberSamples ();
+    unsigned factor = factors.first ();
+    size_t length = (number_samples + factor - 1) / factor;
+
+    QVector<QSharedPointer<QVector<float32> > > min_values;
+    QVector<QSharedPointer<QVector<float32> > > max_values;
+    QVector<float32*> min_outputs;
+    QVector<float32*> max_outputs;
+    for (int index = 0; index < channels.size (); index++)
     {
-        for (int channel = 0; channel < data_.size(); channel++)
-        {
-            max_channel_length = std::max (max_channel_length, basis_data_[channel]->size());
-            sample_rates[downsampling_factor].append (basis_data_[channel]->getSampleRatePerUnit() / downsampling_factor);
-
-            QSharedPointer<QVector<float32> > raw_data_vector (new QVector<float32> (static_cast<int>(basis_data_[channel]->size () / downsampling_factor) + 1));
-
-            QSharedPointer<DataBlock> downsampled_data (new FixedDataBlock (raw_data_vector, sample_rates[downsampling_factor][channel]));
-            basis_data_[channel]->addDownSampledVersion (downsampled_data, downsampling_factor);
-
-            raw_downsampled_data[downsampling_factor].append (raw_data_vector);
-            low_pass_filters[downsampling_factor].append (QSharedPointer<SPUC::butterworth<float32> > (new SPUC::butterworth<float32> (0.5 / downsampling_factor, 4, 3)));
-        }
+        min_values.append (QSharedPointer<QVector<float32> > (new QVector<float32> (length, NAN)));
+        max_values.append (QSharedPointer<QVector<float32> > (new QVector<float32> (length, NAN)));
+        min_outputs.append (min_values.last ()->data ());
+        max_outputs.append (max_values.last ()->data ());
     }
 
-    BackgroundProcesses::instance().addProcess (PROCESS_NAME_, max_channel_length);
-
-    for (unsigned sample_index = 0; sample_index < max_channel_length; sample_index++)
+    // all channels of a section are processed at once, so readers have to
+    // read every part of a file only once
+    size_t section_length = getSectionLength (factor, channels.size ());
+    for (size_t start = 0; start < number_samples; start += section_length)
     {
-        for (int channel = 0; channel < basis_data_.size(); channel++)
+        pool_.start ([this, &channels, &min_outputs, &max_outputs, start, section_length, number_samples, factor] ()
         {
-            if (basis_data_[channel]->size() > sample_index)
+            size_t length = std::min (section_length, number_samples - start);
+            for (int index = 0; index < channels.size () && !isCancelled (); index++)
             {
-                foreach (unsigned downsampling_factor, low_pass_filters.keys())
+                QSharedPointer<DataBlock const> data = channel_manager_.getData (channels.at (index), start, length);
+                if (data.isNull ())
+                    continue;
+                float32* min_out = min_outputs.at (index) + start / factor;
+                float32* max_out = max_outputs.at (index) + start / factor;
+                // bins without any covered sample stay NAN
+                size_t bin_start = 0;
+                for (DataBlock::Range const& range : data->getCoveredRanges (0, length))
                 {
-                    float32 value = low_pass_filters[downsampling_factor][channel]->clock (basis_data_[channel]->operator [](sample_index));
-                    if ((sample_index + 1) % downsampling_factor == 0)
-                        raw_downsampled_data[downsampling_factor][channel]->operator []((sample_index + 1) / downsampling_factor) = value;
+                    bin_start = std::max (bin_start, range.begin / factor * factor);
+                    for (; bin_start < range.end; bin_start += factor)
+                        data->getMinMax (bin_start, std::min<size_t> (factor, length - bin_start),
+                                         min_out[bin_start / factor], max_out[bin_start / factor]);
                 }
             }
-        }
-        if (sample_index % 100 == 0)
-            BackgroundProcesses::instance().setProcessState (PROCESS_NAME_, sample_index);
+            BackgroundProcesses::instance().setProcessState (PROCESS_NAME_, ++processed_sections_);
+        });
     }
-    BackgroundProcesses::instance().removeProcess (PROCESS_NAME_);
-}
+    pool_.waitForDone ();
+    if (isCancelled ())
+        return false;
 
-//-------------------------------------------------------------------------
-void DownSamplingThread::downsampleOnDownsampledData ()
-{
-    for (unsigned downsampling_factor = downsampling_step_;
-         downsampling_factor < downsampling_max_;
-         downsampling_factor *= downsampling_step_)
+    // every further factor is calculated out of the previous one
+    for (int index = 0; index < channels.size (); index++)
     {
-        unsigned max_channel_length = 0;
-        QVector<QSharedPointer<QVector<float32> > > raw_downsampled_data;
-        QVector<QSharedPointer<SPUC::butterworth<float32> > > low_pass_filters;
-        QVector<float32> sample_rates_;
-
-        for (int channel = 0; channel < data_.size(); channel++)
-        {
-            max_channel_length = std::max (max_channel_length, data_[channel]->size());
-            raw_downsampled_data.append (QSharedPointer<QVector<float32> > (new QVector<float32> (static_cast<int>(data_[channel]->size () / downsampling_step_) + 1)));
-            low_pass_filters.append (QSharedPointer<SPUC::butterworth<float32> > (new SPUC::butterworth<float32> (0.9 / downsampling_step_, 4, 3)));
-            sample_rates_.append (data_[channel]->getSampleRatePerUnit() / downsampling_step_);
-        }
-
-        for (unsigned sample_index = 0; sample_index < max_channel_length; sample_index++)
-        {
-            for (int channel = 0; channel < data_.size(); channel++)
-            {
-                if (data_[channel]->size() > sample_index)
-                {
-                    float32 value = low_pass_filters[channel]->clock (data_[channel]->operator [](sample_index));
-                    if ((sample_index + 1) % downsampling_step_ == 0)
-                        raw_downsampled_data[channel]->operator []((sample_index + 1) / downsampling_step_) = value;
-                }
-            }
-        }
-
-        data_.clear ();
-        low_pass_filters.clear();
-        for (int channel = 0; channel < raw_downsampled_data.size(); channel++)
+        pool_.start ([this, &channels, &factors, &min_values, &max_values, index] ()
         {
-            QSharedPointer<DataBlock> downsampled_data (new FixedDataBlock (raw_downsampled_data[channel], sample_rates_[channel]));
-            basis_data_[channel]->addDownSampledVersion (downsampled_data, downsampling_factor);
-            data_.append (downsampled_data);
-        }
+            publishDownsampledChannel (channels.at (index), factors,
+                                       min_values.at (index), max_values.at (index));
+        });
     }
+    pool_.waitForDone ();
+    return !isCancelled ();
 }
 
+//-----------------------------------------------------------------------------
+void DownSamplingThread::publishDownsampledChannel (ChannelID id, QList<unsigned> const& factors,
+                                                    QSharedPointer<QVector<float32> > min_values,
+                                                    QSharedPointer<QVector<float32> > max_values)
+{
+    size_t number_samples = channel_manager_.getNumberSamples ();
+    float64 sample_rate = channel_manager_.getSampleRate ();
+    unsigned factor = factors.first ();
+
+    if (channel_manager_.getDownsampledMin (id, factor).isNull ())
+        channel_manager_.addDownsampledMinMaxVersion (id,
+            QSharedPointer<DataBlock const> (new FixedDataBlock (min_values, sample_rate / factor)),
+            QSharedPointer<DataBlock const> (new FixedDataBlock (max_values, sample_rate / factor)),
+            factor);
 
+    for (int index = 1; index < factors.size (); index++)
+    {
+        if (isCancelled ())
+            return;
+
+        unsigned step = factors[index] / factor;
+        factor = factors[index];
+        size_t length = (number_samples + factor - 1) / factor;
+
+        QSharedPointer<QVector<float32> > new_min_values (new QVector<float32> (length));
+        QSharedPointer<QVector<float32> > new_max_values (new QVector<float32> (length));
+        reduceMinMax (min_values->constData (), max_values->constData (),
+                      min_values->size (), step,
+                      new_min_values->data (), new_max_values->data ());
+
+        min_values = new_min_values;
+        max_values = new_max_values;
+        if (channel_manager_.getDownsampledMin (id, factor).isNull ())
+            channel_manager_.addDownsampledMinMaxVersion (id,
+                QSharedPointer<DataBlock const> (new FixedDataBlock (min_values, sample_rate / factor)),
+                QSharedPointer<DataBlock const> (new FixedDataBlock (max_values, sample_rate / factor)),
+                factor);
+    }
+}
 
 }
@@ -6,58 +6,95 @@
 #ifndef DOWN_SAMPLING_THREAD_H
 #define DOWN_SAMPLING_THREAD_H
 
-#include "base/data_block.h"
 #include "channel_manager.h"
 
 #include <QThread>
-#include <QMutex>
-#include <QSharedPointer>
-#include <QVector>
+#include <QThreadPool>
+#include <QAtomicInt>
 #include <QList>
+#include <QVector>
 
-namespace SigViewer_
+namespace sigviewer
 {
 
+//-----------------------------------------------------------------------------
+/// DownSamplingThread
+///
+/// builds min/max downsampled versions (factors 16, 64, 256, ...) of all
+/// channels of a ChannelManager in the background; the signal is read once,
+/// in sections processed in parallel, for the finest version, and every
+/// coarser version is calculated out of the previous one and published to the
+/// ChannelManager at once
+///
+/// the versions are held in memory and take 2/3 byte per sample and channel,
+/// i.e. a sixth of the samples as float32; finer zoom levels are drawn out
+/// of the samples
 class DownSamplingThread : public QThread
 {
     Q_OBJECT
 public:
     //-------------------------------------------------------------------------
-    DownSamplingThread (QList<QSharedPointer<DataBlock> > data, unsigned downsampling_step, unsigned downsampling_max);
+    /// @param channel_manager must outlive the thread
+    DownSamplingThread (ChannelManager& channel_manager);
+
+    //-------------------------------------------------------------------------
+    virtual ~DownSamplingThread ();
 
     //-------------------------------------------------------------------------
-    DownSamplingThread (QSharedPointer<ChannelManager> channel_manager, unsigned downsampling_step, unsigned downsampling_max);
+    /// stops the downsampling and waits until the thread has finished
+    void cancel ();
 
     //-------------------------------------------------------------------------
-    virtual ~DownSamplingThread ();
+    bool isCancelled () const;
 
 signals:
     //-------------------------------------------------------------------------
-    void downsamplingDataFinished (QSharedPointer<DataBlock> data, ChannelID channel, unsigned factor);
+    /// emitted periodically while the reader decodes the samples in the
+    /// background; downsampling starts once all samples are decoded
+    void decodedDataAvailable ();
 
-private:
     //-------------------------------------------------------------------------
-    virtual void run ();
+    /// emitted whenever new downsampled versions have been published
+    void downsampledDataAvailable ();
+
+    //-------------------------------------------------------------------------
+    /// emitted from the thread itself once all downsampled versions have been
+    /// published
+    void downsamplingFinished ();
 
+private:
     //-------------------------------------------------------------------------
-    void minMaxDownsampling ();
+    virtual void run ();
 
     //-------------------------------------------------------------------------
-    void downsampleAllOnBasisData ();
+    /// length of the sections of the signal processed at once, a multiple of
+    /// the given factor
+    size_t getSectionLength (unsigned factor, int number_channels) const;
 
     //-------------------------------------------------------------------------
-    void downsampleOnDownsampledData ();
+    /// calculates the first factor out of the channel data and every further
+    /// factor out of the previous one; versions which are available already
+    /// (e.g. out of a cache) are not replaced
+    ///
+    /// @return false if cancelled
+    bool downsample (QVector<ChannelID> const& channels, QList<unsigned> const& factors);
 
     //-------------------------------------------------------------------------
-    QSharedPointer<ChannelManager> channel_manager_;
-    QList<QSharedPointer<DataBlock> > basis_data_;
-    QList<QSharedPointer<DataBlock> > data_;
-    QList<QSharedPointer<DataBlock> > new_data_;
-    unsigned downsampling_step_;
-    unsigned downsampling_max_;
-    bool running_;
-
-    static QString PROCESS_NAME_;
+    void publishDownsampledChannel (ChannelID id, QList<unsigned> const& factors,
+                                    QSharedPointer<QVector<float32> > min_values,
+                                    QSharedPointer<QVector<float32> > max_values);
+
+    ChannelManager& channel_manager_;
+    QThreadPool pool_;
+    QAtomicInt cancelled_;
+    QAtomicInt processed_sections_;
+
+    static int const DECODING_UPDATE_INTERVAL_IN_MS_;
+    static unsigned const FIRST_FACTOR_;
+    static unsigned const DOWNSAMPLING_STEP_;
+    static size_t const MIN_DOWNSAMPLED_LENGTH_;
+    static size_t const SECTION_SIZE_IN_BYTES_;
+    static QString const PROCESS_NAME_;
 };
 
 }
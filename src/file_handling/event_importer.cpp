@@ -0,0 +1,250 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "event_importer.h"
+
+#include "biosig.h"
+#undef isfinite
+
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace sigviewer
+{
+
+size_t const EventImporter::MIN_BYTES_PER_THREAD_ = 1 << 20;
+
+namespace EventImporter_
+{
+
+//-----------------------------------------------------------------------------
+char const* skipSpaces (char const* position, char const* end)
+{
+    while (position < end && *position == ' ')
+        position++;
+    return position;
+}
+
+//-----------------------------------------------------------------------------
+/// tabs take precedence, semicolons are only used if there is no comma
+char detectDelimiter (char const* begin, char const* end)
+{
+    if (std::memchr (begin, '\t', end - begin))
+        return '\t';
+    if (std::memchr (begin, ';', end - begin) && !std::memchr (begin, ',', end - begin))
+        return ';';
+    return ',';
+}
+
+//-----------------------------------------------------------------------------
+/// parses a number followed by the delimiter or, for the last field, by the
+/// end of the line
+template<typename Number>
+bool parseField (char const*& position, char const* end, char delimiter,
+                 bool last_field, Number& value)
+{
+    position = skipSpaces (position, end);
+    std::from_chars_result result = std::from_chars (position, end, value);
+    if (result.ec != std::errc ())
+        return false;
+
+    position = skipSpaces (result.ptr, end);
+    if (position == end)
+        return last_field;
+    if (*position != delimiter)
+        return false;
+    position++;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool parseLine (char const* begin, char const* end, char delimiter, EventColumns& events)
+{
+    uint32 position = 0;
+    uint32 duration = 0;
+    ChannelID channel = UNDEFINED_CHANNEL;
+    EventType type = 0;
+    if (!parseField (begin, end, delimiter, false, position) ||
+        !parseField (begin, end, delimiter, false, duration) ||
+        !parseField (begin, end, delimiter, false, channel) ||
+        !parseField (begin, end, delimiter, true, type))
+        return false;
+
+    events.append (position, duration, type, channel);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/// @return the number of lines which were no events
+size_t parseLines (char const* begin, char const* end, char delimiter, EventColumns& events)
+{
+    size_t skipped_lines = 0;
+    while (begin < end)
+    {
+        char const* line_end = static_cast<char const*> (std::memchr (begin, '\n', end - begin));
+        if (!line_end)
+            line_end = end;
+        char const* content_end = line_end;
+        if (content_end > begin && content_end[-1] == '\r')
+            content_end--;
+
+        if (content_end > begin && !parseLine (begin, content_end, delimiter, events))
+            skipped_lines++;
+        begin = line_end + 1;
+    }
+    return skipped_lines;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+QString EventImporter::readEvents (QString const& file_path, double sample_rate,
+                                  EventColumns& events, size_t& skipped_lines)
+{
+    skipped_lines = 0;
+    QString suffix = QFileInfo (file_path).suffix ().toLower ();
+    if (suffix == "csv" || suffix == "tsv" || suffix == "txt")
+        return readTable (file_path, events, skipped_lines);
+    else
+        return readBioSig (file_path, sample_rate, events);
+}
+
+//-----------------------------------------------------------------------------
+size_t EventImporter::parseTable (char const* begin, char const* end, EventColumns& events)
+{
+    using namespace EventImporter_;
+
+    if (end - begin >= 3 && std::memcmp (begin, "\xEF\xBB\xBF", 3) == 0)
+        begin += 3;
+
+    char const* first_line_end = static_cast<char const*> (std::memchr (begin, '\n', end - begin));
+    if (!first_line_end)
+        first_line_end = end;
+    char delimiter = detectDelimiter (begin, first_line_end);
+
+    // a header does not start with a number
+    char const* first_character = skipSpaces (begin, first_line_end);
+    if (first_character < first_line_end && *first_character != '-' &&
+        (*first_character < '0' || *first_character > '9'))
+        begin = std::min (first_line_end + 1, end);
+
+    // every thread parses a part ending at a line end
+    size_t number_parts = std::clamp<size_t> ((end - begin) / MIN_BYTES_PER_THREAD_, 1,
+                                              std::max (1, QThreadPool::globalInstance ()->maxThreadCount ()));
+    std::vector<char const*> part_begins (1, begin);
+    for (size_t part = 1; part < number_parts; part++)
+    {
+        char const* part_begin = std::max (part_begins.back (), begin + part * ((end - begin) / number_parts));
+        char const* line_end = static_cast<char const*> (std::memchr (part_begin, '\n', end - part_begin));
+        part_begins.push_back (line_end ? line_end + 1 : end);
+    }
+    part_begins.push_back (end);
+
+    std::vector<EventColumns> parts (number_parts);
+    std::vector<size_t> skipped_lines (number_parts, 0);
+    QSemaphore parsed;
+    for (size_t part = 1; part < number_parts; part++)
+    {
+        QThreadPool::globalInstance ()->start ([&, part] ()
+        {
+            skipped_lines[part] = parseLines (part_begins[part], part_begins[part + 1],
+                                              delimiter, parts[part]);
+            parsed.release ();
+        });
+    }
+    skipped_lines[0] = parseLines (part_begins[0], part_begins[1], delimiter, parts[0]);
+    parsed.acquire (static_cast<int>(number_parts - 1));
+
+    size_t number_events = events.size ();
+    for (EventColumns const& part : parts)
+        number_events += part.size ();
+    events.reserve (number_events);
+
+    size_t number_skipped_lines = 0;
+    for (size_t part = 0; part < number_parts; part++)
+    {
+        events.positions.insert (events.positions.end (), parts[part].positions.begin (), parts[part].positions.end ());
+        events.durations.insert (events.durations.end (), parts[part].durations.begin (), parts[part].durations.end ());
+        events.types.insert (events.types.end (), parts[part].types.begin (), parts[part].types.end ());
+        events.channels.insert (events.channels.end (), parts[part].channels.begin (), parts[part].channels.end ());
+        number_skipped_lines += skipped_lines[part];
+    }
+    return number_skipped_lines;
+}
+
+//-----------------------------------------------------------------------------
+QString EventImporter::readTable (QString const& file_path, EventColumns& events,
+                                  size_t& skipped_lines)
+{
+    QFile file (file_path);
+    if (!file.open (QIODevice::ReadOnly))
+        return QObject::tr("Cannot open file.\nIs the target file open in another application?");
+    if (file.size () == 0)
+        return "";
+
+    uchar* data = file.map (0, file.size ());
+    if (data)
+    {
+        char const* begin = reinterpret_cast<char const*> (data);
+        skipped_lines = parseTable (begin, begin + file.size (), events);
+        file.unmap (data);
+    }
+    else
+    {
+        QByteArray content = file.readAll ();
+        skipped_lines = parseTable (content.constData (), content.constData () + content.size (), events);
+    }
+    return "";
+}
+
+//-----------------------------------------------------------------------------
+QString EventImporter::readBioSig (QString const& file_path, double sample_rate,
+                                   EventColumns& events)
+{
+    HDRTYPE* header = sopen (file_path.toStdString ().c_str (), "r", NULL);
+    if (serror2 (header))
+    {
+        destructHDR (header);
+        return QObject::tr("Cannot open file.\nIs the target file open in another application?");
+    }
+
+    // the sample rate of the events may be NaN if the file does not specify it
+    double transition_rate = sample_rate / biosig_get_eventtable_samplerate (header);
+    size_t number_events = biosig_get_number_of_events (header);
+    events.reserve (events.size () + number_events);
+    for (size_t index = 0; index < number_events; index++)
+    {
+        uint16_t type;
+        uint32_t position;
+        uint16_t channel;
+        uint32_t duration;
+        gdf_time timestamp;
+        char const* description;
+        biosig_get_nth_event (header, index, &type, &position, &channel, &duration,
+                              &timestamp, &description);
+        if (transition_rate > 0)
+        {
+            position = std::lround (position * transition_rate);
+            duration = std::lround (duration * transition_rate);
+        }
+
+        // biosig counts the channels from 1 and uses 0 for all channels
+        events.append (position, duration, type, static_cast<ChannelID> (channel) - 1);
+    }
+    sclose (header);
+    destructHDR (header);
+    return "";
+}
+
+}
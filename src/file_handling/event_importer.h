@@ -0,0 +1,60 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef EVENT_IMPORTER_H
+#define EVENT_IMPORTER_H
+
+#include "base/sigviewer_user_types.h"
+#include "event_store.h"
+
+#include <QString>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// EventImporter
+///
+/// reads events out of event files to be added to an EventManager at once
+///
+/// CSV and TSV files have the columns "position,duration,channel,type" as
+/// written by the CSV export, in samples and with -1 as channel of events
+/// belonging to all channels; further columns are ignored, as is a header
+/// line; the file is mapped into memory and its lines are parsed in parallel
+///
+/// other files, e.g. EVT, are read by biosig
+class EventImporter
+{
+public:
+    //-------------------------------------------------------------------------
+    /// @param sample_rate the sample rate of the event positions in the
+    ///        signal; positions of files with another rate are converted
+    /// @param events receives the events in the order of the file
+    /// @param skipped_lines set to the number of lines of a CSV or TSV file
+    ///        which could not be read as events (e.g. broken or truncated)
+    /// @return an error message or an empty string
+    static QString readEvents (QString const& file_path, double sample_rate,
+                               EventColumns& events, size_t& skipped_lines);
+
+    //-------------------------------------------------------------------------
+    /// parses CSV or TSV text, the delimiter is detected
+    /// @return the number of lines which were no events, without the header
+    static size_t parseTable (char const* begin, char const* end, EventColumns& events);
+
+private:
+    //-------------------------------------------------------------------------
+    static QString readTable (QString const& file_path, EventColumns& events,
+                              size_t& skipped_lines);
+
+    //-------------------------------------------------------------------------
+    static QString readBioSig (QString const& file_path, double sample_rate,
+                               EventColumns& events);
+
+    static size_t const MIN_BYTES_PER_THREAD_;
+};
+
+}
+
+#endif // EVENT_IMPORTER_H
@@ -0,0 +1,192 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "event_interval_index.h"
+
+#include <algorithm>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+EventIntervalIndex::EventIntervalIndex ()
+    : max_ends_valid_ (true)
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+void EventIntervalIndex::insert (EventID id, uint32 position, uint32 duration, ChannelID channel)
+{
+    Entry entry = {position, static_cast<uint64>(position) + duration, channel, id};
+
+    // events are usually added in order of their position
+    if (entries_.empty () || entries_.back ().begin <= position)
+        entries_.push_back (entry);
+    else
+    {
+        auto next = std::upper_bound (entries_.begin (), entries_.end (), position,
+                                      [] (uint32 position, Entry const& entry)
+                                      {return position < entry.begin;});
+        entries_.insert (next, entry);
+    }
+    max_ends_valid_ = false;
+}
+
+//-----------------------------------------------------------------------------
+void EventIntervalIndex::insert (EventStore const& store, QList<EventID> const& ids)
+{
+    auto by_begin = [] (Entry const& entry, Entry const& other) {return entry.begin < other.begin;};
+
+    size_t old_size = entries_.size ();
+    entries_.reserve (old_size + ids.size ());
+    for (EventID id : ids)
+        entries_.push_back ({store.getPosition (id),
+                             static_cast<uint64>(store.getPosition (id)) + store.getDuration (id),
+                             store.getChannel (id), id});
+    std::stable_sort (entries_.begin () + old_size, entries_.end (), by_begin);
+    std::inplace_merge (entries_.begin (), entries_.begin () + old_size, entries_.end (), by_begin);
+    max_ends_valid_ = false;
+}
+
+//-----------------------------------------------------------------------------
+void EventIntervalIndex::remove (EventID id, uint32 position)
+{
+    auto entry = std::lower_bound (entries_.begin (), entries_.end (), position,
+                                   [] (Entry const& entry, uint32 position)
+                                   {return entry.begin < position;});
+    for (; entry != entries_.end () && entry->begin == position; ++entry)
+    {
+        if (entry->id == id)
+        {
+            entries_.erase (entry);
+            max_ends_valid_ = false;
+            return;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void EventIntervalIndex::remove (QSet<EventID> const& ids)
+{
+    entries_.erase (std::remove_if (entries_.begin (), entries_.end (),
+                                    [&ids] (Entry const& entry) {return ids.contains (entry.id);}),
+                    entries_.end ());
+    max_ends_valid_ = false;
+}
+
+//-----------------------------------------------------------------------------
+void EventIntervalIndex::clear ()
+{
+    entries_.clear ();
+    max_ends_.clear ();
+    max_ends_valid_ = true;
+}
+
+//-----------------------------------------------------------------------------
+void EventIntervalIndex::update ()
+{
+    if (max_ends_valid_)
+        return;
+    max_ends_.resize (entries_.size ());
+    buildMaxEnds (0, entries_.size ());
+    max_ends_valid_ = true;
+}
+
+//-----------------------------------------------------------------------------
+std::set<EventID> EventIntervalIndex::getEventsAt (uint32 position, ChannelID channel_id) const
+{
+    std::set<EventID> events;
+    auto collect = [&events, channel_id] (Entry const& entry)
+    {
+        if (entry.channel == channel_id || entry.channel == UNDEFINED_CHANNEL)
+            events.insert (entry.id);
+    };
+    visit (position, position, collect);
+    return events;
+}
+
+//-----------------------------------------------------------------------------
+QList<EventID> EventIntervalIndex::getEvents (uint32 begin, uint32 end) const
+{
+    QList<EventID> events;
+    auto collect = [&events] (Entry const& entry)
+    {
+        events.append (entry.id);
+    };
+    visit (begin, end, collect);
+    return events;
+}
+
+//-----------------------------------------------------------------------------
+QList<EventID> EventIntervalIndex::getEvents (uint32 begin, uint32 end, ChannelID channel_id) const
+{
+    QList<EventID> events;
+    auto collect = [&events, channel_id] (Entry const& entry)
+    {
+        if (entry.channel == channel_id || entry.channel == UNDEFINED_CHANNEL)
+            events.append (entry.id);
+    };
+    visit (begin, end, collect);
+    return events;
+}
+
+//-----------------------------------------------------------------------------
+template<typename Visitor>
+void EventIntervalIndex::visit (uint64 begin, uint64 end, Visitor& visitor) const
+{
+    if (max_ends_valid_)
+    {
+        visit (0, entries_.size (), begin, end, visitor);
+        return;
+    }
+
+    // the maxima are outdated, e.g. while changes are batched
+    for (Entry const& entry : entries_)
+    {
+        if (entry.begin > end)
+            return;
+        if (entry.end >= begin)
+            visitor (entry);
+    }
+}
+
+//-----------------------------------------------------------------------------
+template<typename Visitor>
+void EventIntervalIndex::visit (size_t first, size_t last, uint64 begin, uint64 end,
+                                Visitor& visitor) const
+{
+    if (first >= last)
+        return;
+
+    size_t middle = first + (last - first) / 2;
+    if (max_ends_[middle] < begin)
+        return;
+
+    visit (first, middle, begin, end, visitor);
+
+    // all following entries start after the range too
+    if (entries_[middle].begin > end)
+        return;
+    if (entries_[middle].end >= begin)
+        visitor (entries_[middle]);
+
+    visit (middle + 1, last, begin, end, visitor);
+}
+
+//-----------------------------------------------------------------------------
+uint64 EventIntervalIndex::buildMaxEnds (size_t first, size_t last)
+{
+    if (first >= last)
+        return 0;
+
+    size_t middle = first + (last - first) / 2;
+    max_ends_[middle] = std::max ({entries_[middle].end,
+                                   buildMaxEnds (first, middle),
+                                   buildMaxEnds (middle + 1, last)});
+    return max_ends_[middle];
+}
+
+}
@@ -0,0 +1,111 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef EVENT_INTERVAL_INDEX_H
+#define EVENT_INTERVAL_INDEX_H
+
+#include "base/sigviewer_user_types.h"
+#include "event_store.h"
+
+#include <QList>
+#include <QSet>
+
+#include <set>
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// EventIntervalIndex
+///
+/// finds the events covering a sample or overlapping a range of samples in
+/// O(log n + k); an event covers the samples [position, position + duration]
+///
+/// the events are kept sorted by their position and are searched as an
+/// implicit balanced tree, in which every node knows the maximum end of its
+/// subtree; these maxima are rebuilt by update, which takes O(n) as does
+/// every single insert or remove, so changes of many events should be made
+/// at once; until update is called after a change, queries scan all events
+///
+/// not thread safe; queries do not change the index and may run concurrently
+class EventIntervalIndex
+{
+public:
+    //-------------------------------------------------------------------------
+    EventIntervalIndex ();
+
+    //-------------------------------------------------------------------------
+    void insert (EventID id, uint32 position, uint32 duration, ChannelID channel);
+
+    //-------------------------------------------------------------------------
+    /// inserts the given events of the store at once in O(n + k log k)
+    void insert (EventStore const& store, QList<EventID> const& ids);
+
+    //-------------------------------------------------------------------------
+    /// @param position the position the event had when it was inserted
+    void remove (EventID id, uint32 position);
+
+    //-------------------------------------------------------------------------
+    /// removes the given events at once in O(n)
+    void remove (QSet<EventID> const& ids);
+
+    //-------------------------------------------------------------------------
+    void clear ();
+
+    //-------------------------------------------------------------------------
+    /// prepares the index for queries in O(log n + k) after changes
+    void update ();
+
+    //-------------------------------------------------------------------------
+    size_t size () const {return entries_.size ();}
+
+    //-------------------------------------------------------------------------
+    /// @return events covering the position which belong to the given channel
+    ///         or to all channels
+    std::set<EventID> getEventsAt (uint32 position, ChannelID channel_id) const;
+
+    //-------------------------------------------------------------------------
+    /// @return events overlapping the samples [begin, end], sorted by position
+    QList<EventID> getEvents (uint32 begin, uint32 end) const;
+
+    //-------------------------------------------------------------------------
+    /// @return events overlapping the samples [begin, end] which belong to
+    ///         the given channel or to all channels, sorted by position
+    QList<EventID> getEvents (uint32 begin, uint32 end, ChannelID channel_id) const;
+
+private:
+    struct Entry
+    {
+        uint32 begin;
+        uint64 end;
+        ChannelID channel;
+        EventID id;
+    };
+
+    //-------------------------------------------------------------------------
+    /// calls visitor for every entry overlapping [begin, end] in order of
+    /// their positions
+    template<typename Visitor>
+    void visit (uint64 begin, uint64 end, Visitor& visitor) const;
+
+    //-------------------------------------------------------------------------
+    /// visits the tree of the entries [first, last)
+    template<typename Visitor>
+    void visit (size_t first, size_t last, uint64 begin, uint64 end,
+                Visitor& visitor) const;
+
+    //-------------------------------------------------------------------------
+    /// @return the maximum end of the entries [first, last)
+    uint64 buildMaxEnds (size_t first, size_t last);
+
+    std::vector<Entry> entries_;
+    std::vector<uint64> max_ends_;
+    bool max_ends_valid_;
+};
+
+}
+
+#endif // EVENT_INTERVAL_INDEX_H
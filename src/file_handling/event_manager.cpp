@@ -6,6 +6,10 @@
 #include "event_manager.h"
 
 #include <QDebug>
+#include <QSet>
+
+#include <algorithm>
+#include <limits>
 
 namespace sigviewer
 {
@@ -13,29 +17,24 @@ namespace sigviewer
 //-----------------------------------------------------------------------------
 EventManager::EventManager (FileSignalReader const& reader)
     : max_event_position_ (reader.getBasicHeader()->getNumberOfSamples()),
-      caller_mutex_ (new QMutex)
+      batch_depth_ (0)
 {
     file_type_ = reader.getBasicHeader()->getFileTypeString();
+    xdf_ = reader.getBasicHeader()->getXdf();
+    sample_rate_ = reader.getBasicHeader()->getEventSamplerate();
 
     QList<QSharedPointer<SignalEvent const> > signal_events = reader.getEvents ();
-    next_free_id_ = 0;
+    store_.reserve (signal_events.size());
     for (int index = 0; index < signal_events.size(); index++)
     {
-        event_map_.insert (next_free_id_,
-                           QSharedPointer<SignalEvent> (
-                                   new SignalEvent(*(signal_events[index]),
-                                                   next_free_id_)));
-        mutex_map_.insert (next_free_id_,
-                           QSharedPointer<QMutex> (
-                                   new QMutex));
-
-        position_event_map_.insert (signal_events[index]->getPosition (), next_free_id_);
+        addEvent (signal_events[index]->getPosition (), signal_events[index]->getDuration (),
+                  signal_events[index]->getType (), signal_events[index]->getChannel (),
+                  signal_events[index]->getStream (), UNDEFINED_EVENT_ID);
         if (!event_table_reader_.entryExists (signal_events[index]->getType()))
             event_table_reader_.addEntry (signal_events[index]->getType());
-
-        next_free_id_++;
     }
-    sample_rate_ = reader.getBasicHeader()->getEventSamplerate();
+    interval_index_.update ();
+
     QMap<unsigned, QString> event_names = reader.getBasicHeader()->getNamesOfUserSpecificEvents();
     for (QMap<unsigned, QString>::iterator name_iter = event_names.begin();
          name_iter != event_names.end();
@@ -47,44 +46,62 @@ EventManager::EventManager (FileSignalReader const& reader)
 EventManager::~EventManager ()
 {
     event_table_reader_.restoreEventNames ();
-    delete caller_mutex_;
 }
 
 //-----------------------------------------------------------------------------
 QSharedPointer<SignalEvent const> EventManager::getEvent (EventID id) const
 {
-    QMutexLocker locker (caller_mutex_);
-    EventMap::ConstIterator event_it = event_map_.find (id);
-    if (event_it == event_map_.end())
+    QReadLocker locker (&lock_);
+    if (!store_.contains (id))
         return QSharedPointer<SignalEvent const> (0);
     else
-        return event_it.value();
+        return QSharedPointer<SignalEvent const> (new SignalEvent (createSignalEvent (id)));
+}
+
+//-----------------------------------------------------------------------------
+bool EventManager::getEvent (EventID id, SignalEvent& event) const
+{
+    QReadLocker locker (&lock_);
+    if (!store_.contains (id))
+        return false;
+    event = createSignalEvent (id);
+    return true;
 }
 
 //-----------------------------------------------------------------------------
 QSharedPointer<SignalEvent> EventManager::getAndLockEventForEditing (EventID id)
 {
-    QMutexLocker locker (caller_mutex_);
-    EventMap::Iterator event_it = event_map_.find (id);
-    if (event_it == event_map_.end())
+    QWriteLocker locker (&lock_);
+    if (!store_.contains (id))
         return QSharedPointer<SignalEvent> (0);
-    else
-    {
-        temp_event_position_map_.insert (id, event_it.value()->getPosition ());
-        mutex_map_[id]->lock ();
-        return event_it.value();
-    }
+
+    // an event being edited already is shared by its editors
+    QSharedPointer<SignalEvent>& editing_event = editing_events_[id];
+    if (editing_event.isNull ())
+        editing_event = QSharedPointer<SignalEvent> (new SignalEvent (createSignalEvent (id)));
+    return editing_event;
 }
 
 //-----------------------------------------------------------------------------
 void EventManager::updateAndUnlockEvent (EventID id)
 {
-    if (!mutex_map_.contains (id))
-        return;
-    position_event_map_.remove (temp_event_position_map_[id], id);
-    temp_event_position_map_.remove (id);
-    position_event_map_.insert (event_map_[id]->getPosition (), id);
-    mutex_map_[id]->unlock ();
+    {
+        QWriteLocker locker (&lock_);
+        QSharedPointer<SignalEvent> event = editing_events_.take (id);
+        if (event.isNull () || !store_.contains (id))
+            return;
+
+        type_index_.remove (id, store_.getType (id), store_.getPosition (id));
+        interval_index_.remove (id, store_.getPosition (id));
+        store_.set (id, event->getPosition (), event->getDuration (),
+                    event->getType (), event->getChannel ());
+        type_index_.insert (id, event->getType (), event->getPosition ());
+        interval_index_.insert (id, event->getPosition (), event->getDuration (),
+                                event->getChannel ());
+        if (recordChange (id, EVENT_CHANGED))
+            return;
+        interval_index_.update ();
+    }
     emit eventChanged (id);
     emit changed ();
 }
@@ -94,21 +111,21 @@ QSharedPointer<SignalEvent const> EventManager::createEvent (
         ChannelID channel_id, unsigned pos, unsigned duration,
         EventType type, int stream_id, EventID id)
 {
-    if (id == UNDEFINED_EVENT_ID)
+    bool batched = false;
     {
-        id = next_free_id_;
-        next_free_id_++;
-    }
-    else
-        if (event_map_.contains(id))
+        QWriteLocker locker (&lock_);
+        id = addEvent (pos, duration, type, channel_id, stream_id, id);
+        if (id == UNDEFINED_EVENT_ID)
             return QSharedPointer<SignalEvent>(0);
+        batched = recordChange (id, EVENT_CREATED);
+        if (!batched)
+            interval_index_.update ();
+    }
 
-    QSharedPointer<SignalEvent> new_event (
+    QSharedPointer<SignalEvent const> new_event (
             new SignalEvent(pos, type, sample_rate_, stream_id, channel_id, duration, id));
-    event_map_[id] = new_event;
-    mutex_map_[id] = QSharedPointer<QMutex> (new QMutex);
-    position_event_map_.insert (pos, id);
-
+    if (batched)
+        return new_event;
     emit eventCreated (new_event);
     emit changed ();
     return new_event;
@@ -117,46 +134,162 @@ QSharedPointer<SignalEvent const> EventManager::createEvent (
 //-----------------------------------------------------------------------------
 void EventManager::removeEvent (EventID id)
 {
-    qDebug () << "EventManager::removeEvent " << id;
-    EventMap::iterator event_iter = event_map_.find (id);
-    if (event_iter == event_map_.end())
-        return;
-
-    position_event_map_.remove (event_map_[id]->getPosition(), id);
-    event_map_.remove (id);
-    mutex_map_.remove (id);
-    qDebug () << "EventManager::removeEvent " << id << " emitting";
+    {
+        QWriteLocker locker (&lock_);
+        if (!store_.contains (id))
+            return;
+
+        type_index_.remove (id, store_.getType (id), store_.getPosition (id));
+        interval_index_.remove (id, store_.getPosition (id));
+        store_.remove (id);
+        editing_events_.remove (id);
+        if (recordChange (id, EVENT_REMOVED))
+            return;
+        interval_index_.update ();
+    }
     emit eventRemoved (id);
     emit changed ();
-    qDebug () << "EventManager::removeEvent " << id << " finished";
 }
 
 //-----------------------------------------------------------------------------
-std::set<EventID> EventManager::getEventsAt (unsigned pos,
-                                                 ChannelID channel_id) const
+QList<EventID> EventManager::addEvents (EventColumns const& events, QList<EventID> const& ids)
+{
+    EventChanges changes;
+    {
+        QWriteLocker locker (&lock_);
+        store_.reserve (store_.size () + events.size ());
+        changes.created.reserve (events.size ());
+        for (size_t index = 0; index < events.size (); index++)
+        {
+            EventID id = UNDEFINED_EVENT_ID;
+            if (index < static_cast<size_t>(ids.size ()))
+                id = ids[index];
+            id = store_.add (events.positions[index], events.durations[index], events.types[index],
+                             events.channels[index], UNDEFINED_STREAM_ID, id);
+            if (id != UNDEFINED_EVENT_ID)
+                changes.created.append (id);
+        }
+        type_index_.insert (store_, changes.created);
+        interval_index_.insert (store_, changes.created);
+
+        if (batch_depth_ > 0)
+        {
+            for (EventID id : changes.created)
+                recordChange (id, EVENT_CREATED);
+            return changes.created;
+        }
+        interval_index_.update ();
+    }
+
+    if (changes.created.size ())
+    {
+        QList<EventID> created = changes.created;
+        std::sort (changes.created.begin (), changes.created.end ());
+        emit eventsChanged (changes);
+        emit changed ();
+        return created;
+    }
+    return changes.created;
+}
+
+//-----------------------------------------------------------------------------
+void EventManager::removeEvents (QList<EventID> const& ids)
 {
-    QMutexLocker locker (caller_mutex_);
-    std::set<EventID> events;
-    QSharedPointer<SignalEvent const> event_ptr;
-    foreach (uint32 position, position_event_map_.keys())
+    EventChanges changes;
     {
-        foreach (EventID event, position_event_map_.values (position))
+        QWriteLocker locker (&lock_);
+        QSet<EventID> removed;
+        removed.reserve (ids.size ());
+        for (EventID id : ids)
+            if (store_.contains (id))
+                removed.insert (id);
+        if (removed.isEmpty ())
+            return;
+
+        type_index_.remove (removed);
+        interval_index_.remove (removed);
+        for (EventID id : removed)
+        {
+            store_.remove (id);
+            if (!editing_events_.isEmpty ())
+                editing_events_.remove (id);
+        }
+
+        if (batch_depth_ > 0)
         {
-            event_ptr = event_map_[event];
-            if (event_ptr->getPosition() <= pos &&
-                event_ptr->getPosition () + event_ptr->getDuration() >= pos &&
-                (event_ptr->getChannel() == channel_id ||
-                 event_ptr->getChannel() == UNDEFINED_CHANNEL))
-                events.insert (event);
+            for (EventID id : removed)
+                recordChange (id, EVENT_REMOVED);
+            return;
         }
+        interval_index_.update ();
+        changes.removed = QList<EventID> (removed.begin (), removed.end ());
+        std::sort (changes.removed.begin (), changes.removed.end ());
     }
-    return events;
+
+    emit eventsChanged (changes);
+    emit changed ();
+}
+
+//-----------------------------------------------------------------------------
+void EventManager::beginBatch ()
+{
+    QWriteLocker locker (&lock_);
+    batch_depth_++;
+}
+
+//-----------------------------------------------------------------------------
+void EventManager::commitBatch ()
+{
+    EventChanges changes;
+    {
+        QWriteLocker locker (&lock_);
+        if (batch_depth_ == 0 || --batch_depth_ > 0)
+            return;
+
+        for (auto const& change : batch_changes_)
+        {
+            if (change.second == EVENT_CREATED)
+                changes.created.append (change.first);
+            else if (change.second == EVENT_REMOVED)
+                changes.removed.append (change.first);
+            else
+                changes.changed.append (change.first);
+        }
+        batch_changes_.clear ();
+        interval_index_.update ();
+    }
+    if (changes.created.isEmpty () && changes.removed.isEmpty () && changes.changed.isEmpty ())
+        return;
+
+    emit eventsChanged (changes);
+    emit changed ();
+}
+
+//-----------------------------------------------------------------------------
+std::set<EventID> EventManager::getEventsAt (unsigned pos,
+                                                 ChannelID channel_id) const
+{
+    QReadLocker locker (&lock_);
+    return interval_index_.getEventsAt (pos, channel_id);
+}
+
+//-----------------------------------------------------------------------------
+QList<EventID> EventManager::getEventsInRange (unsigned begin, unsigned end) const
+{
+    QReadLocker locker (&lock_);
+    return interval_index_.getEvents (begin, end);
+}
+
+//-----------------------------------------------------------------------------
+QList<EventID> EventManager::getEventsByPosition () const
+{
+    QReadLocker locker (&lock_);
+    return interval_index_.getEvents (0, std::numeric_limits<uint32>::max ());
 }
 
 //-----------------------------------------------------------------------------
 double EventManager::getSampleRate () const
 {
-    QMutexLocker locker (caller_mutex_);
     return sample_rate_;
 }
 
@@ -170,15 +303,16 @@ unsigned EventManager::getMaxEventPosition () const
 //-----------------------------------------------------------------------------
 QString EventManager::getNameOfEventType (EventType type) const
 {
-    QMutexLocker locker (caller_mutex_);
+    QReadLocker locker (&lock_);
     return event_table_reader_.getEventName (type);
 }
 
 //-------------------------------------------------------------------------
 QString EventManager::getNameOfEvent (EventID event) const
 {
-    if (event_map_.contains (event))
-        return event_table_reader_.getEventName (event_map_[event]->getType ());
+    QReadLocker locker (&lock_);
+    if (store_.contains (event))
+        return event_table_reader_.getEventName (store_.getType (event));
     else
         return "";
 }
@@ -186,22 +320,22 @@ QString EventManager::getNameOfEvent (EventID event) const
 //-----------------------------------------------------------------------------
 QList<EventID> EventManager::getAllEvents () const
 {
-    QMutexLocker locker (caller_mutex_);
-    return event_map_.keys ();
+    QReadLocker locker (&lock_);
+    return store_.getIds ();
 }
 
 //-----------------------------------------------------------------------------
 unsigned EventManager::getNumberOfEvents () const
 {
-    QMutexLocker locker (caller_mutex_);
-    return event_map_.size ();
+    QReadLocker locker (&lock_);
+    return store_.size ();
 }
 
 
 //-----------------------------------------------------------------------------
 std::set<EventType> EventManager::getEventTypes (QString group_id) const
 {
-    QMutexLocker locker (caller_mutex_);
+    QReadLocker locker (&lock_);
     if (group_id.size ())
         return event_table_reader_.getEventsOfGroup (group_id);
     else
@@ -223,65 +357,28 @@ std::set<QString> EventManager::getEventTypeGroupIDs () const
 //-----------------------------------------------------------------------------
 QList<EventID> EventManager::getEvents (EventType type) const
 {
-    QMutexLocker locker (caller_mutex_);
-    QList<EventID> events;
-    for (EventMap::ConstIterator event_iter = event_map_.begin ();
-         event_iter != event_map_.end ();
-         ++event_iter)
-        if (event_iter.value ()->getType () == type)
-        {
-            events.push_back (event_iter.key ());
-        }
-    return events;
+    QReadLocker locker (&lock_);
+    return type_index_.getEvents (type);
 }
 
 //-------------------------------------------------------------------------
 EventID EventManager::getNextEventOfSameType (EventID id) const
 {
-    QMutexLocker locker (caller_mutex_);
-    if (!event_map_.contains(id))
+    QReadLocker locker (&lock_);
+    if (!store_.contains (id))
         return UNDEFINED_EVENT_ID;
 
-    EventType type = event_map_[id]->getType ();
-    PositionMap::const_iterator iter = position_event_map_.find (event_map_[id]->getPosition ());
-    ++iter;
-    while (iter != position_event_map_.end ())
-    {
-        foreach (EventID next_event_id, position_event_map_.values (iter.key()))
-            if (event_map_[next_event_id]->getType () == type
-                && next_event_id != id)
-                return next_event_id;
-        ++iter;
-    }
-    return UNDEFINED_EVENT_ID;
+    return type_index_.getNextEvent (id, store_.getType (id), store_.getPosition (id));
 }
 
 //-------------------------------------------------------------------------
 EventID EventManager::getPreviousEventOfSameType (EventID id) const
 {
-    QMutexLocker locker (caller_mutex_);
-    if (!event_map_.contains(id))
-        return UNDEFINED_EVENT_ID;
-
-    EventType type = event_map_[id]->getType ();
-    PositionMap::const_iterator iter = position_event_map_.find (event_map_[id]->getPosition ());
-    if (iter == position_event_map_.begin ())
+    QReadLocker locker (&lock_);
+    if (!store_.contains (id))
         return UNDEFINED_EVENT_ID;
-    --iter;
-    while (iter != position_event_map_.begin ())
-    {
-        foreach (EventID previous_event_id, position_event_map_.values (iter.key()))
-            if (event_map_[previous_event_id]->getType () == type
-                && previous_event_id != id)
-                return previous_event_id;
-        --iter;
-    }
-    foreach (EventID previous_event_id, position_event_map_.values (iter.key()))
-        if (event_map_[previous_event_id]->getType () == type
-            && previous_event_id != id)
-            return previous_event_id;
 
-    return UNDEFINED_EVENT_ID;
+    return type_index_.getPreviousEvent (id, store_.getType (id), store_.getPosition (id));
 }
 
 QString EventManager::getFileType() const
@@ -294,4 +391,43 @@ void EventManager::setEventName(EventType event_type_id, const QString &name)
     event_table_reader_.setEventName(event_type_id, name);
 }
 
+//-----------------------------------------------------------------------------
+EventID EventManager::addEvent (uint32 position, uint32 duration, EventType type,
+                                ChannelID channel, int stream, EventID id)
+{
+    id = store_.add (position, duration, type, channel, stream, id);
+    if (id == UNDEFINED_EVENT_ID)
+        return id;
+    type_index_.insert (id, type, position);
+    interval_index_.insert (id, position, duration, channel);
+    return id;
+}
+
+//-----------------------------------------------------------------------------
+bool EventManager::recordChange (EventID id, ChangeKind kind)
+{
+    if (batch_depth_ == 0)
+        return false;
+
+    auto change = batch_changes_.find (id);
+    if (change == batch_changes_.end ())
+        batch_changes_[id] = kind;
+    else if (change->second == EVENT_CREATED && kind == EVENT_REMOVED)
+        batch_changes_.erase (change);
+    else if (change->second == EVENT_REMOVED && kind == EVENT_CREATED)
+        change->second = EVENT_CHANGED;
+    else if (change->second == EVENT_CHANGED && kind == EVENT_REMOVED)
+        change->second = EVENT_REMOVED;
+    // a created event stays created if it is changed afterwards
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+SignalEvent EventManager::createSignalEvent (EventID id) const
+{
+    return SignalEvent (store_.getPosition (id), store_.getType (id), sample_rate_,
+                        store_.getStream (id), store_.getChannel (id),
+                        store_.getDuration (id), id);
+}
+
 }
@@ -10,18 +10,32 @@
 #include "base/signal_event.h"
 #include "file_signal_reader.h"
 #include "event_table_file_reader.h"
+#include "event_interval_index.h"
+#include "event_type_index.h"
+#include "event_store.h"
 
 #include <QObject>
 #include <QSharedPointer>
 #include <QList>
 #include <QMap>
-#include <QMutex>
+#include <QReadWriteLock>
 
+#include <map>
 #include <set>
 
 namespace sigviewer
 {
 
+//-----------------------------------------------------------------------------
+/// the events created, removed and changed by a batch of edits, each in
+/// ascending order of their ids
+struct EventChanges
+{
+    QList<EventID> created;
+    QList<EventID> removed;
+    QList<EventID> changed;
+};
+
 class EventManager : public QObject
 {
     Q_OBJECT
@@ -30,8 +44,28 @@ public:
 
     ~EventManager ();
 
+    //-------------------------------------------------------------------------
+    /// @return a copy of the event or 0 if it does not exist
     QSharedPointer<SignalEvent const> getEvent (EventID id) const;
 
+    //-------------------------------------------------------------------------
+    /// lightweight read access without allocating
+    /// @return false if the event does not exist
+    bool getEvent (EventID id, SignalEvent& event) const;
+
+    //-------------------------------------------------------------------------
+    /// calls function (EventStore const&) while the events must not be changed,
+    /// e.g. to read many events at once out of the columns of the store
+    template<typename Function>
+    void readEvents (Function function) const
+    {
+        QReadLocker locker (&lock_);
+        function (store_);
+    }
+
+    //-------------------------------------------------------------------------
+    /// @return an editable copy of the event; the changes are applied when
+    ///         updateAndUnlockEvent is called
     QSharedPointer<SignalEvent> getAndLockEventForEditing (EventID id);
 
     void updateAndUnlockEvent (EventID id);
@@ -45,8 +79,40 @@ public:
 
     void removeEvent (EventID id);
 
+    //-------------------------------------------------------------------------
+    /// adds many events at once; the indices are built in one pass and the
+    /// events are reported by a single eventsChanged
+    /// @param ids the ids to give the events, e.g. to restore them; the events
+    ///        after the given ids get new ones
+    /// @return the ids of the added events
+    QList<EventID> addEvents (EventColumns const& events,
+                              QList<EventID> const& ids = QList<EventID> ());
+
+    //-------------------------------------------------------------------------
+    /// removes many events at once, reported by a single eventsChanged
+    void removeEvents (QList<EventID> const& ids);
+
+    //-------------------------------------------------------------------------
+    /// starts a batch of edits; until the matching commitBatch the edits emit
+    /// neither eventCreated, eventRemoved, eventChanged nor changed, but are
+    /// reported at once by eventsChanged followed by changed
+    ///
+    /// batches may be nested, only the outermost commitBatch reports
+    void beginBatch ();
+
+    //-------------------------------------------------------------------------
+    void commitBatch ();
+
     std::set<EventID> getEventsAt (unsigned pos, ChannelID channel_id) const;
 
+    //-------------------------------------------------------------------------
+    /// @return events overlapping the samples [begin, end] sorted by position
+    QList<EventID> getEventsInRange (unsigned begin, unsigned end) const;
+
+    //-------------------------------------------------------------------------
+    /// @return all events sorted by position
+    QList<EventID> getEventsByPosition () const;
+
     double getSampleRate () const;
 
     unsigned getMaxEventPosition () const;
@@ -71,6 +137,11 @@ public:
 
     QString getFileType () const;
 
+    //-------------------------------------------------------------------------
+    /// @return the parsed streams of XDF files, which keep the events created
+    ///         by the user for saving; null for other files
+    QSharedPointer<Xdf> getXdf () const {return xdf_;}
+
     void setEventName (EventType event_type_id, QString const& name);
 
 signals:
@@ -78,24 +149,48 @@ signals:
     void eventCreated (QSharedPointer<SignalEvent const> event);
     void eventRemoved (EventID id);
     void changed ();
+    void eventsChanged (EventChanges const& changes);
 
 private:
+    enum ChangeKind
+    {
+        EVENT_CREATED,
+        EVENT_REMOVED,
+        EVENT_CHANGED
+    };
+
+    //-------------------------------------------------------------------------
+    /// merges the change into the changes of the running batch
+    /// @return false if no batch is running and the change has to be emitted
+    bool recordChange (EventID id, ChangeKind kind);
+
+    //-------------------------------------------------------------------------
+    /// adds the event to the store and the indices
+    /// @return the id of the event or UNDEFINED_EVENT_ID if the id is used
+    EventID addEvent (uint32 position, uint32 duration, EventType type,
+                      ChannelID channel, int stream, EventID id);
+
+    //-------------------------------------------------------------------------
+    /// @return a copy of the stored event
+    SignalEvent createSignalEvent (EventID id) const;
+
     EventTableFileReader event_table_reader_;
 
     unsigned const max_event_position_;
     double sample_rate_;
-    QMutex* caller_mutex_;
 
-    typedef QMap<EventID, QSharedPointer<SignalEvent> > EventMap;
-    typedef QMap<EventID, QSharedPointer<QMutex> > MutexMap;
-    typedef QMultiMap<uint32, EventID> PositionMap;
+    // guards the store and the indices, edits take the write lock
+    mutable QReadWriteLock lock_;
+
+    EventStore store_;
+    EventIntervalIndex interval_index_;
+    EventTypeIndex type_index_;
+    QMap<EventID, QSharedPointer<SignalEvent> > editing_events_;
 
-    EventMap event_map_;
-    MutexMap mutex_map_;
-    EventID next_free_id_;
-    PositionMap position_event_map_;
-    QMap<EventID, uint32> temp_event_position_map_;
+    int batch_depth_;
+    std::map<EventID, ChangeKind> batch_changes_;
     QString file_type_;
+    QSharedPointer<Xdf> xdf_;
 };
 
 }
@@ -0,0 +1,113 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "event_store.h"
+
+namespace sigviewer
+{
+
+int32 const EventStore::FREE_SLOT_ = -1;
+
+//-----------------------------------------------------------------------------
+EventStore::EventStore ()
+    : size_ (0)
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+void EventStore::reserve (size_t number_events)
+{
+    slots_.reserve (number_events);
+    positions_.reserve (number_events);
+    durations_.reserve (number_events);
+    types_.reserve (number_events);
+    channels_.reserve (number_events);
+    streams_.reserve (number_events);
+}
+
+//-----------------------------------------------------------------------------
+EventID EventStore::add (uint32 position, uint32 duration, EventType type,
+                         ChannelID channel, int stream, EventID id)
+{
+    if (id == UNDEFINED_EVENT_ID)
+        id = static_cast<EventID>(slots_.size ());
+    else if (id < 0 || contains (id))
+        return UNDEFINED_EVENT_ID;
+
+    if (static_cast<size_t>(id) >= slots_.size ())
+        slots_.resize (id + 1, FREE_SLOT_);
+
+    int32 slot;
+    if (free_slots_.empty ())
+    {
+        slot = static_cast<int32>(positions_.size ());
+        positions_.push_back (position);
+        durations_.push_back (duration);
+        types_.push_back (type);
+        channels_.push_back (channel);
+        streams_.push_back (stream);
+    }
+    else
+    {
+        slot = free_slots_.back ();
+        free_slots_.pop_back ();
+        positions_[slot] = position;
+        durations_[slot] = duration;
+        types_[slot] = type;
+        channels_[slot] = channel;
+        streams_[slot] = stream;
+    }
+    slots_[id] = slot;
+    size_++;
+    return id;
+}
+
+//-----------------------------------------------------------------------------
+bool EventStore::remove (EventID id)
+{
+    if (!contains (id))
+        return false;
+
+    free_slots_.push_back (slots_[id]);
+    slots_[id] = FREE_SLOT_;
+    size_--;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool EventStore::set (EventID id, uint32 position, uint32 duration, EventType type,
+                      ChannelID channel)
+{
+    if (!contains (id))
+        return false;
+
+    int32 slot = slots_[id];
+    positions_[slot] = position;
+    durations_[slot] = duration;
+    types_[slot] = type;
+    channels_[slot] = channel;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool EventStore::contains (EventID id) const
+{
+    return id >= 0 && static_cast<size_t>(id) < slots_.size () &&
+           slots_[id] != FREE_SLOT_;
+}
+
+//-----------------------------------------------------------------------------
+QList<EventID> EventStore::getIds () const
+{
+    QList<EventID> ids;
+    ids.reserve (size_);
+    for (size_t id = 0; id < slots_.size (); id++)
+        if (slots_[id] != FREE_SLOT_)
+            ids.append (static_cast<EventID>(id));
+    return ids;
+}
+
+}
@@ -0,0 +1,120 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+#include "base/sigviewer_user_types.h"
+
+#include <QList>
+
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// plain columns of events without ids, e.g. read from a file to be added
+/// at once
+struct EventColumns
+{
+    std::vector<uint32> positions;
+    std::vector<uint32> durations;
+    std::vector<EventType> types;
+    std::vector<ChannelID> channels;
+
+    size_t size () const {return positions.size ();}
+
+    void reserve (size_t number_events)
+    {
+        positions.reserve (number_events);
+        durations.reserve (number_events);
+        types.reserve (number_events);
+        channels.reserve (number_events);
+    }
+
+    void append (uint32 position, uint32 duration, EventType type, ChannelID channel)
+    {
+        positions.push_back (position);
+        durations.push_back (duration);
+        types.push_back (type);
+        channels.push_back (channel);
+    }
+};
+
+//-----------------------------------------------------------------------------
+/// EventStore
+///
+/// compact columnar storage of events: the position, duration, type, channel
+/// and stream of all events are kept in contiguous arrays ("slots")
+///
+/// event ids are stable and never reused, so undoing the removal of an event
+/// can bring it back with its former id; the slots of removed events are
+/// kept in a free-list and reused by new events
+///
+/// not thread safe
+class EventStore
+{
+public:
+    //-------------------------------------------------------------------------
+    EventStore ();
+
+    //-------------------------------------------------------------------------
+    void reserve (size_t number_events);
+
+    //-------------------------------------------------------------------------
+    /// @param id the id of the new event or UNDEFINED_EVENT_ID to use the
+    ///           next free one
+    /// @return the id of the new event or UNDEFINED_EVENT_ID if the given id
+    ///         is already used
+    EventID add (uint32 position, uint32 duration, EventType type,
+                 ChannelID channel, int stream, EventID id = UNDEFINED_EVENT_ID);
+
+    //-------------------------------------------------------------------------
+    /// @return false if the event does not exist
+    bool remove (EventID id);
+
+    //-------------------------------------------------------------------------
+    /// @return false if the event does not exist
+    bool set (EventID id, uint32 position, uint32 duration, EventType type,
+              ChannelID channel);
+
+    //-------------------------------------------------------------------------
+    bool contains (EventID id) const;
+
+    //-------------------------------------------------------------------------
+    size_t size () const {return size_;}
+
+    //-------------------------------------------------------------------------
+    /// @return the ids of all events in ascending order
+    QList<EventID> getIds () const;
+
+    //-------------------------------------------------------------------------
+    /// the following getters must only be called for existing events
+    uint32 getPosition (EventID id) const {return positions_[slots_[id]];}
+    uint32 getDuration (EventID id) const {return durations_[slots_[id]];}
+    EventType getType (EventID id) const {return types_[slots_[id]];}
+    ChannelID getChannel (EventID id) const {return channels_[slots_[id]];}
+    int getStream (EventID id) const {return streams_[slots_[id]];}
+
+private:
+    static int32 const FREE_SLOT_;
+
+    // slot of every id ever used, FREE_SLOT_ for removed events
+    std::vector<int32> slots_;
+    std::vector<int32> free_slots_;
+    size_t size_;
+
+    // columns, indexed by slot
+    std::vector<uint32> positions_;
+    std::vector<uint32> durations_;
+    std::vector<EventType> types_;
+    std::vector<ChannelID> channels_;
+    std::vector<int> streams_;
+};
+
+}
+
+#endif // EVENT_STORE_H
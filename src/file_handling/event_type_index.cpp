@@ -0,0 +1,165 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "event_type_index.h"
+
+#include <algorithm>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+void EventTypeIndex::insert (EventID id, EventType type, uint32 position)
+{
+    TypeEvents& events = types_[type];
+    qsizetype index = find (events, id, position);
+    events.positions.insert (events.positions.begin () + index, position);
+    events.ids.insert (index, id);
+}
+
+//-----------------------------------------------------------------------------
+void EventTypeIndex::insert (EventStore const& store, QList<EventID> const& ids)
+{
+    QHash<EventType, std::vector<std::pair<uint32, EventID> > > added_events;
+    for (EventID id : ids)
+        added_events[store.getType (id)].push_back ({store.getPosition (id), id});
+
+    for (auto added_iter = added_events.begin (); added_iter != added_events.end (); ++added_iter)
+    {
+        std::vector<std::pair<uint32, EventID> >& added = added_iter.value ();
+        std::sort (added.begin (), added.end ());
+
+        TypeEvents& events = types_[added_iter.key ()];
+        TypeEvents merged;
+        merged.positions.reserve (events.positions.size () + added.size ());
+        merged.ids.reserve (events.ids.size () + added.size ());
+        qsizetype old_index = 0;
+        size_t added_index = 0;
+        while (old_index < events.ids.size () || added_index < added.size ())
+        {
+            if (added_index == added.size () ||
+                (old_index < events.ids.size () &&
+                 std::make_pair (events.positions[old_index], events.ids[old_index]) < added[added_index]))
+            {
+                merged.positions.push_back (events.positions[old_index]);
+                merged.ids.append (events.ids[old_index]);
+                old_index++;
+            }
+            else
+            {
+                merged.positions.push_back (added[added_index].first);
+                merged.ids.append (added[added_index].second);
+                added_index++;
+            }
+        }
+        events = std::move (merged);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void EventTypeIndex::remove (EventID id, EventType type, uint32 position)
+{
+    auto type_iter = types_.find (type);
+    if (type_iter == types_.end ())
+        return;
+
+    TypeEvents& events = type_iter.value ();
+    qsizetype index = find (events, id, position);
+    if (index >= events.ids.size () || events.ids[index] != id)
+        return;
+
+    events.positions.erase (events.positions.begin () + index);
+    events.ids.remove (index);
+    if (events.ids.isEmpty ())
+        types_.erase (type_iter);
+}
+
+//-----------------------------------------------------------------------------
+void EventTypeIndex::remove (QSet<EventID> const& ids)
+{
+    for (auto type_iter = types_.begin (); type_iter != types_.end ();)
+    {
+        TypeEvents& events = type_iter.value ();
+        qsizetype kept = 0;
+        for (qsizetype index = 0; index < events.ids.size (); index++)
+        {
+            if (ids.contains (events.ids[index]))
+                continue;
+            events.positions[kept] = events.positions[index];
+            events.ids[kept] = events.ids[index];
+            kept++;
+        }
+        events.positions.resize (kept);
+        events.ids.resize (kept);
+
+        if (events.ids.isEmpty ())
+            type_iter = types_.erase (type_iter);
+        else
+            ++type_iter;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void EventTypeIndex::clear ()
+{
+    types_.clear ();
+}
+
+//-----------------------------------------------------------------------------
+QList<EventID> EventTypeIndex::getEvents (EventType type) const
+{
+    auto type_iter = types_.find (type);
+    if (type_iter == types_.end ())
+        return QList<EventID> ();
+    return type_iter.value ().ids;
+}
+
+//-----------------------------------------------------------------------------
+EventID EventTypeIndex::getNextEvent (EventID id, EventType type, uint32 position) const
+{
+    qsizetype index = indexOf (id, type, position);
+    if (index < 0)
+        return UNDEFINED_EVENT_ID;
+
+    QList<EventID> const& ids = types_.find (type).value ().ids;
+    if (index + 1 >= ids.size ())
+        return UNDEFINED_EVENT_ID;
+    return ids[index + 1];
+}
+
+//-----------------------------------------------------------------------------
+EventID EventTypeIndex::getPreviousEvent (EventID id, EventType type, uint32 position) const
+{
+    qsizetype index = indexOf (id, type, position);
+    if (index <= 0)
+        return UNDEFINED_EVENT_ID;
+    return types_.find (type).value ().ids[index - 1];
+}
+
+//-----------------------------------------------------------------------------
+qsizetype EventTypeIndex::find (TypeEvents const& events, EventID id, uint32 position)
+{
+    auto same_position = std::equal_range (events.positions.begin (), events.positions.end (), position);
+    qsizetype index = same_position.first - events.positions.begin ();
+    qsizetype end = same_position.second - events.positions.begin ();
+    while (index < end && events.ids[index] < id)
+        index++;
+    return index;
+}
+
+//-----------------------------------------------------------------------------
+qsizetype EventTypeIndex::indexOf (EventID id, EventType type, uint32 position) const
+{
+    auto type_iter = types_.find (type);
+    if (type_iter == types_.end ())
+        return -1;
+
+    qsizetype index = find (type_iter.value (), id, position);
+    if (index >= type_iter.value ().ids.size () || type_iter.value ().ids[index] != id)
+        return -1;
+    return index;
+}
+
+}
@@ -0,0 +1,85 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef EVENT_TYPE_INDEX_H
+#define EVENT_TYPE_INDEX_H
+
+#include "base/sigviewer_user_types.h"
+#include "event_store.h"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// EventTypeIndex
+///
+/// the events of every type sorted by position (events at the same position
+/// by id), so the events of a type and the neighbours of an event are found
+/// in O(log n) without copying
+///
+/// not thread safe
+class EventTypeIndex
+{
+public:
+    //-------------------------------------------------------------------------
+    void insert (EventID id, EventType type, uint32 position);
+
+    //-------------------------------------------------------------------------
+    /// inserts the given events of the store at once in O(n + k log k)
+    void insert (EventStore const& store, QList<EventID> const& ids);
+
+    //-------------------------------------------------------------------------
+    /// @param type and position of the event when it was inserted
+    void remove (EventID id, EventType type, uint32 position);
+
+    //-------------------------------------------------------------------------
+    /// removes the given events at once in O(n)
+    void remove (QSet<EventID> const& ids);
+
+    //-------------------------------------------------------------------------
+    void clear ();
+
+    //-------------------------------------------------------------------------
+    /// @return the events of the given type sorted by position; the list is
+    ///         shared with the index, so no copy is made
+    QList<EventID> getEvents (EventType type) const;
+
+    //-------------------------------------------------------------------------
+    /// @return the following event of the same type or UNDEFINED_EVENT_ID
+    EventID getNextEvent (EventID id, EventType type, uint32 position) const;
+
+    //-------------------------------------------------------------------------
+    /// @return the preceding event of the same type or UNDEFINED_EVENT_ID
+    EventID getPreviousEvent (EventID id, EventType type, uint32 position) const;
+
+private:
+    //-------------------------------------------------------------------------
+    /// positions and ids of the events of one type, sorted the same way
+    struct TypeEvents
+    {
+        std::vector<uint32> positions;
+        QList<EventID> ids;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @return the index where the event is or would be inserted
+    static qsizetype find (TypeEvents const& events, EventID id, uint32 position);
+
+    //-------------------------------------------------------------------------
+    /// @return the index of the event within its type or -1
+    qsizetype indexOf (EventID id, EventType type, uint32 position) const;
+
+    QHash<EventType, TypeEvents> types_;
+};
+
+}
+
+#endif // EVENT_TYPE_INDEX_H
@@ -52,32 +52,38 @@ QString EVTWriter::save(QSharedPointer<FileContext const> file_context,
                         std::set<EventType> const& types)
 {
     QSharedPointer<EventManager const> event_manager = file_context->getEventManager();
-    QList<EventID> events;
-    for (const auto type : types)
-        events.append(event_manager->getEvents(type));
-    unsigned number_events = events.size();
+    QList<EventID> events = event_manager->getEventsByPosition ();
 
-    HDRTYPE* header = constructHDR (0, number_events);
+    HDRTYPE* header = constructHDR (0, events.size ());
     header->TYPE = GDF;
     header->VERSION = 2.0;
     header->SampleRate = event_manager->getSampleRate();
     header->EVENT.SampleRate = event_manager->getSampleRate();
-    header->EVENT.N = number_events;
-    header->EVENT.TYP = (decltype(header->EVENT.TYP)) realloc(header->EVENT.TYP,number_events * sizeof(decltype(*header->EVENT.TYP)));
-    header->EVENT.POS = (decltype(header->EVENT.POS)) realloc(header->EVENT.POS,number_events * sizeof(decltype(*header->EVENT.POS)));
-    header->EVENT.CHN = (decltype(header->EVENT.CHN)) realloc(header->EVENT.CHN,number_events * sizeof(decltype(*header->EVENT.CHN)));
-    header->EVENT.DUR = (decltype(header->EVENT.DUR)) realloc(header->EVENT.DUR,number_events * sizeof(decltype(*header->EVENT.DUR)));
-    for (unsigned index = 0; index < number_events; index++)
+    header->EVENT.TYP = (decltype(header->EVENT.TYP)) realloc(header->EVENT.TYP,events.size() * sizeof(decltype(*header->EVENT.TYP)));
+    header->EVENT.POS = (decltype(header->EVENT.POS)) realloc(header->EVENT.POS,events.size() * sizeof(decltype(*header->EVENT.POS)));
+    header->EVENT.CHN = (decltype(header->EVENT.CHN)) realloc(header->EVENT.CHN,events.size() * sizeof(decltype(*header->EVENT.CHN)));
+    header->EVENT.DUR = (decltype(header->EVENT.DUR)) realloc(header->EVENT.DUR,events.size() * sizeof(decltype(*header->EVENT.DUR)));
+
+    // the columns are copied in order of the positions without a SignalEvent
+    // per event
+    unsigned number_events = 0;
+    event_manager->readEvents ([&] (EventStore const& store)
     {
-        QSharedPointer<SignalEvent const> event = event_manager->getEvent(events[index]);
-        if (event->getChannel() == UNDEFINED_CHANNEL)
-            header->EVENT.CHN[index] = 0;
-        else
-            header->EVENT.CHN[index] = event->getChannel() + 1;
-        header->EVENT.TYP[index] = event->getType ();
-        header->EVENT.POS[index] = event->getPosition();
-        header->EVENT.DUR[index] = event->getDuration();
-    }
+        for (EventID id : events)
+        {
+            if (!store.contains (id) || !types.count (store.getType (id)))
+                continue;
+            if (store.getChannel (id) == UNDEFINED_CHANNEL)
+                header->EVENT.CHN[number_events] = 0;
+            else
+                header->EVENT.CHN[number_events] = store.getChannel (id) + 1;
+            header->EVENT.TYP[number_events] = store.getType (id);
+            header->EVENT.POS[number_events] = store.getPosition (id);
+            header->EVENT.DUR[number_events] = store.getDuration (id);
+            number_events++;
+        }
+    });
+    header->EVENT.N = number_events;
 
     qDebug () << "write events to " << new_file_path_;
 
@@ -4,6 +4,8 @@
 
 
 #include "file_channel_manager.h"
+#include "decoded_cache.h"
+#include "down_sampling_thread.h"
 
 
 namespace sigviewer
@@ -11,15 +13,48 @@ namespace sigviewer
 
 //-----------------------------------------------------------------------------
 FileChannelManager::FileChannelManager (FileSignalReader* file_signal_reader)
-    : reader_ (file_signal_reader)
+    : reader_ (file_signal_reader),
+      downsampling_thread_ (new DownSamplingThread (*this))
 {
     setXAxisUnitLabel ("s");
+
+    // a file opened from a decoded cache needs neither a search of the extrema
+    // nor downsampling
+    QSharedPointer<DecodedCache const> cache = reader_->getDecodedCache ();
+    if (!cache.isNull ())
+    {
+        std::map<ChannelID, float64> min_values;
+        std::map<ChannelID, float64> max_values;
+        if (cache->getMinMaxValues (min_values, max_values))
+            setMinMaxValues (min_values, max_values);
+
+        for (unsigned factor : cache->getDownsamplingFactors ())
+            for (ChannelID id : getChannels ())
+                if (!cache->getDownsampledMin (id, factor).isNull ())
+                    addDownsampledMinMaxVersion (id, cache->getDownsampledMin (id, factor),
+                                                 cache->getDownsampledMax (id, factor), factor);
+    }
+    else
+    {
+        // the GUI changes the reader (e.g. by adding events), so the cache is
+        // written out of the state of the file as it has been opened
+        decoded_cache_data_ = reader_->getDecodedCacheData ();
+        if (!decoded_cache_data_.isEmpty ())
+        {
+            decoded_cache_file_path_ = reader_->getBasicHeader()->getFilePath();
+            decoded_cache_events_ = reader_->getEvents ();
+        }
+    }
+
+    QObject::connect (downsampling_thread_, &DownSamplingThread::downsamplingFinished,
+                      downsampling_thread_, [this] () {writeDecodedCache ();}, Qt::DirectConnection);
 }
 
 
 //-----------------------------------------------------------------------------
 FileChannelManager::~FileChannelManager ()
 {
+    delete downsampling_thread_;
     delete reader_;
 }
 
@@ -85,6 +120,22 @@ QSharedPointer<DataBlock const> FileChannelManager::getData (ChannelID id, unsig
         return reader_->getSignalData (id, start_pos, length);
 }
 
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> FileChannelManager::getAvailableData (ChannelID id, unsigned start_pos,
+                                                                      unsigned length) const
+{
+    if (((start_pos + length) > getNumberSamples()) || length == 0)
+        return QSharedPointer<DataBlock const> (0);
+    else
+        return reader_->getAvailableSignalData (id, start_pos, length);
+}
+
+//-----------------------------------------------------------------------------
+bool FileChannelManager::waitUntilDecoded (int timeout_in_ms) const
+{
+    return reader_->waitUntilDecoded (timeout_in_ms);
+}
+
 //-----------------------------------------------------------------------------
 float64 FileChannelManager::getDurationInSec () const
 {
@@ -105,4 +156,39 @@ float64 FileChannelManager::getSampleRate () const
     return reader_->getBasicHeader()->getSampleRate();
 }
 
+//-----------------------------------------------------------------------------
+float64 FileChannelManager::getChannelSampleRate (ChannelID id) const
+{
+    return reader_->getChannelSampleRate (id);
+}
+
+//-----------------------------------------------------------------------------
+float64 FileChannelManager::getChannelTimeOffset (ChannelID id) const
+{
+    return reader_->getChannelTimeOffset (id);
+}
+
+//-----------------------------------------------------------------------------
+QString FileChannelManager::getMinMaxCacheKey () const
+{
+    return DecodedCache::getFileKey (reader_->getBasicHeader()->getFilePath());
+}
+
+//-----------------------------------------------------------------------------
+DownSamplingThread* FileChannelManager::getDownsamplingThread () const
+{
+    return downsampling_thread_;
+}
+
+//-----------------------------------------------------------------------------
+void FileChannelManager::writeDecodedCache () const
+{
+    if (decoded_cache_data_.isEmpty ())
+        return;
+
+    DecodedCache::write (decoded_cache_file_path_, *this, decoded_cache_events_,
+                         decoded_cache_data_,
+                         [this] () {return downsampling_thread_->isCancelled ();});
+}
+
 }
@@ -12,6 +12,8 @@
 namespace sigviewer
 {
 
+class DownSamplingThread;
+
 //-----------------------------------------------------------------------------
 /// FileChannelManager
 ///
@@ -48,6 +50,14 @@ public:
                                                      unsigned start_pos,
                                                      unsigned length) const;
 
+    //-------------------------------------------------------------------------
+    virtual QSharedPointer<DataBlock const> getAvailableData (ChannelID id,
+                                                              unsigned start_pos,
+                                                              unsigned length) const;
+
+    //-------------------------------------------------------------------------
+    virtual bool waitUntilDecoded (int timeout_in_ms) const;
+
     //-------------------------------------------------------------------------
     virtual float64 getDurationInSec() const;
 
@@ -57,8 +67,35 @@ public:
     //-------------------------------------------------------------------------
     virtual float64 getSampleRate() const;
 
+    //-------------------------------------------------------------------------
+    virtual float64 getChannelSampleRate (ChannelID id) const;
+
+    //-------------------------------------------------------------------------
+    virtual float64 getChannelTimeOffset (ChannelID id) const;
+
+    //-------------------------------------------------------------------------
+    /// the thread calculating the downsampled versions of the channels; it is
+    /// not started automatically and stopped when the FileChannelManager is
+    /// destructed
+    DownSamplingThread* getDownsamplingThread () const;
+
+    //-------------------------------------------------------------------------
+    /// writes the decoded channels, their downsampled versions and extrema to
+    /// a DecodedCache if the reader supports it; called by the downsampling
+    /// thread when it has finished, so the data of the reader and its events
+    /// are taken on the GUI thread when the file is opened
+    void writeDecodedCache () const;
+
+protected:
+    //-------------------------------------------------------------------------
+    virtual QString getMinMaxCacheKey () const;
+
 private:
     FileSignalReader* reader_;
+    DownSamplingThread* downsampling_thread_;
+    QString decoded_cache_file_path_;
+    QByteArray decoded_cache_data_;
+    QList<QSharedPointer<SignalEvent const> > decoded_cache_events_;
 };
 
 }
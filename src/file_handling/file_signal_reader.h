@@ -10,6 +10,7 @@
 #include "base/signal_event.h"
 #include "base/data_block.h"
 
+#include <QByteArray>
 #include <QFile>
 #include <QVector>
 #include <QPointer>
@@ -21,6 +22,8 @@ class QString;
 namespace sigviewer
 {
 
+class DecodedCache;
+
 //-----------------------------------------------------------------------------
 /// FileSignalReader
 ///
@@ -38,6 +41,19 @@ public:
                                                            size_t start_sample,
                                                            size_t length) const = 0;
 
+    //-------------------------------------------------------------------------
+    /// like getSignalData, but returns at once if the reader decodes the
+    /// samples in the background; samples not decoded yet are NAN
+    virtual QSharedPointer<DataBlock const> getAvailableSignalData (ChannelID channel_id,
+                                                                    size_t start_sample,
+                                                                    size_t length) const
+    {return getSignalData (channel_id, start_sample, length);}
+
+    //-------------------------------------------------------------------------
+    /// @param timeout_in_ms -1 to wait without a timeout
+    /// @return true if all samples are decoded
+    virtual bool waitUntilDecoded (int /*timeout_in_ms*/) const {return true;}
+
     virtual QList<QSharedPointer<SignalEvent const> > getEvents () const = 0;
 
     virtual QSharedPointer<BasicHeader> getBasicHeader () = 0;
@@ -46,6 +62,28 @@ public:
 
     int setEventTypeColors();  /*!< Set a distinct color for each event type. */
 
+    //-------------------------------------------------------------------------
+    /// rate the channel has been recorded with; getSignalData maps the samples
+    /// of channels recorded at another rate onto the rate of the basic header
+    virtual float64 getChannelSampleRate (ChannelID) const {return getBasicHeader ()->getSampleRate ();}
+
+    //-------------------------------------------------------------------------
+    /// time of the first sample of the channel after the begin of the
+    /// recording in seconds
+    virtual float64 getChannelTimeOffset (ChannelID) const {return 0;}
+
+    //-------------------------------------------------------------------------
+    /// @return the cache the file has been opened from or 0
+    virtual QSharedPointer<DecodedCache const> getDecodedCache () const
+    {return QSharedPointer<DecodedCache const> ();}
+
+    //-------------------------------------------------------------------------
+    /// called on the GUI thread when the file is opened
+    ///
+    /// @return the data the reader needs to be opened from a DecodedCache or
+    ///         an empty array if it does not support it
+    virtual QByteArray getDecodedCacheData () const {return QByteArray ();}
+
 protected:
     FileSignalReader () {}
 
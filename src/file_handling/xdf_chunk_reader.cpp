@@ -0,0 +1,378 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "xdf_chunk_reader.h"
+
+#include <QByteArray>
+#include <QObject>
+#include <QStringList>
+#include <QXmlStreamReader>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace sigviewer
+{
+
+namespace XdfChunkReader_
+{
+
+enum ChunkTag
+{
+    FILE_HEADER = 1,
+    STREAM_HEADER = 2,
+    SAMPLES = 3,
+    CLOCK_OFFSET = 4,
+    BOUNDARY = 5,
+    STREAM_FOOTER = 6
+};
+
+//-----------------------------------------------------------------------------
+/// reads a number preceded by the count of its bytes (1, 4 or 8)
+bool readLength (uchar const*& position, uchar const* end, quint64& value)
+{
+    if (position >= end)
+        return false;
+    int number_bytes = *position++;
+    if (end - position < number_bytes)
+        return false;
+    switch (number_bytes)
+    {
+    case 1:
+        value = *position;
+        break;
+    case 4:
+        value = qFromLittleEndian<quint32> (position);
+        break;
+    case 8:
+        value = qFromLittleEndian<quint64> (position);
+        break;
+    default:
+        return false;
+    }
+    position += number_bytes;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/// reads the time stamp of a sample, if it has one
+bool readTimeStamp (uchar const*& position, uchar const* end, double interval, double& time_stamp)
+{
+    if (position >= end)
+        return false;
+    int number_bytes = *position++;
+    if (number_bytes == 0)
+    {
+        time_stamp += interval;
+        return true;
+    }
+    if (number_bytes != 8 || end - position < 8)
+        return false;
+    time_stamp = qFromLittleEndian<double> (position);
+    position += 8;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+bool decodeValues (uchar const* position, uchar const* end, size_t number_samples,
+                   int channel_count, double first_time_stamp, double interval,
+                   float32* const* rows, double* time_stamps)
+{
+    qint64 sample_size = static_cast<qint64> (channel_count) * sizeof (T);
+    double time_stamp = first_time_stamp - interval;
+    for (size_t sample = 0; sample < number_samples; sample++)
+    {
+        if (!readTimeStamp (position, end, interval, time_stamp) || end - position < sample_size)
+            return false;
+        if (time_stamps)
+            time_stamps[sample] = time_stamp;
+        if (rows)
+            for (int channel = 0; channel < channel_count; channel++)
+                rows[channel][sample] = qFromLittleEndian<T> (position + channel * sizeof (T));
+        position += sample_size;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/// @return 0 for strings and unknown formats
+int getValueSize (std::string const& channel_format)
+{
+    if (channel_format == "float32" || channel_format == "int32")
+        return 4;
+    if (channel_format == "double64" || channel_format == "int64")
+        return 8;
+    if (channel_format == "int16")
+        return 2;
+    if (channel_format == "int8")
+        return 1;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+/// reads the entries of the StreamHeader libxdf reads, too
+void parseStreamHeader (XdfChunkReader::Stream& stream)
+{
+    QXmlStreamReader xml (QByteArray::fromStdString (stream.header));
+    QStringList path;
+    while (!xml.atEnd ())
+    {
+        QXmlStreamReader::TokenType token = xml.readNext ();
+        if (token == QXmlStreamReader::EndElement)
+            path.removeLast ();
+        if (token != QXmlStreamReader::StartElement)
+            continue;
+
+        QString name = xml.name ().toString ();
+        if (path.size () == 1 && path.first () == "info" && name != "desc")
+        {
+            // read as a whole, so the element is closed already
+            std::string value = xml.readElementText (QXmlStreamReader::IncludeChildElements).toStdString ();
+            if (name == "name")
+                stream.name = value;
+            else if (name == "type")
+                stream.type = value;
+            else if (name == "channel_format")
+                stream.channel_format = value;
+            else if (name == "channel_count")
+                stream.channel_count = QString::fromStdString (value).toInt ();
+            else if (name == "nominal_srate")
+                stream.nominal_srate = QString::fromStdString (value).toDouble ();
+            continue;
+        }
+        if (path == QStringList ({"info", "desc", "channels", "channel"}))
+        {
+            stream.channels.back ()[name.toStdString ()] =
+                    xml.readElementText (QXmlStreamReader::IncludeChildElements).toStdString ();
+            continue;
+        }
+        path.append (name);
+        if (path == QStringList ({"info", "desc", "channels", "channel"}))
+            stream.channels.emplace_back ();
+    }
+}
+
+}
+
+//-----------------------------------------------------------------------------
+XdfChunkReader::XdfChunkReader (QString const& file_path)
+    : file_ (file_path),
+      version_ (0)
+{
+    // nothing to do here
+}
+
+//-----------------------------------------------------------------------------
+QString XdfChunkReader::scan ()
+{
+    using namespace XdfChunkReader_;
+
+    uchar const* data = file_.data ();
+    if (!data)
+        return QObject::tr("Cannot open file.");
+    uchar const* end = data + file_.size ();
+    if (file_.size () < 4 || std::memcmp (data, "XDF:", 4) != 0)
+        return QObject::tr("Not an XDF file.");
+
+    std::map<quint32, size_t> stream_indices;
+    uchar const* position = data + 4;
+    while (position < end)
+    {
+        quint64 length = 0;
+        if (!readLength (position, end, length) || length < 2 ||
+            length > static_cast<quint64> (end - position))
+            break;
+        quint16 tag = qFromLittleEndian<quint16> (position);
+        uchar const* content = position + 2;
+        uchar const* content_end = position + length;
+        position = content_end;
+
+        if (tag == FILE_HEADER)
+        {
+            QXmlStreamReader xml (QByteArray (reinterpret_cast<char const*> (content), content_end - content));
+            while (xml.readNextStartElement ())
+                if (xml.name () != QLatin1String ("info"))
+                {
+                    if (xml.name () == QLatin1String ("version"))
+                        version_ = xml.readElementText (QXmlStreamReader::IncludeChildElements).toDouble ();
+                    else
+                        xml.skipCurrentElement ();
+                }
+            continue;
+        }
+
+        // all other chunks but the boundaries belong to a stream
+        if (tag == BOUNDARY || content_end - content < 4)
+            continue;
+        quint32 id = qFromLittleEndian<quint32> (content);
+        content += 4;
+
+        if (tag == STREAM_HEADER)
+        {
+            if (stream_indices.count (id))
+                continue;
+            stream_indices[id] = streams_.size ();
+            streams_.emplace_back ();
+            Stream& stream = streams_.back ();
+            stream.id = id;
+            stream.header.assign (reinterpret_cast<char const*> (content), content_end - content);
+            stream.channel_count = 0;
+            stream.nominal_srate = 0;
+            stream.number_samples = 0;
+            parseStreamHeader (stream);
+            continue;
+        }
+
+        std::map<quint32, size_t>::const_iterator stream_index = stream_indices.find (id);
+        if (stream_index == stream_indices.end ())
+            continue;
+        Stream& stream = streams_[stream_index->second];
+        if (tag == STREAM_FOOTER)
+            stream.footer.assign (reinterpret_cast<char const*> (content), content_end - content);
+        else if (tag == CLOCK_OFFSET && content_end - content >= 16)
+            stream.clock_offsets.push_back (std::make_pair (qFromLittleEndian<double> (content),
+                                                            qFromLittleEndian<double> (content + 8)));
+        else if (tag == SAMPLES)
+        {
+            quint64 number_samples = 0;
+            if (!readLength (content, content_end, number_samples) || number_samples == 0)
+                continue;
+
+            // the first time stamp of a chunk without one follows the previous
+            // chunk; the samples of regular streams are assumed to follow each
+            // other by the nominal interval, so the file need not be read as a
+            // whole, the ones of irregular streams have to be decoded
+            double interval = stream.nominal_srate > 0 ? 1 / stream.nominal_srate : 0;
+            double first_time_stamp = interval;
+            if (content_end - content >= 9 && *content == 8)
+                first_time_stamp = qFromLittleEndian<double> (content + 1);
+            else if (!stream.chunks.empty () && interval > 0)
+                first_time_stamp = stream.chunks.back ().first_time_stamp +
+                                   stream.chunks.back ().number_samples * interval;
+            else if (!stream.chunks.empty ())
+                first_time_stamp = getLastTimeStamp (stream_index->second);
+
+            stream.chunks.push_back ({content - data, content_end - data, stream.number_samples,
+                                      static_cast<size_t> (number_samples), first_time_stamp});
+            stream.number_samples += number_samples;
+        }
+    }
+    return "";
+}
+
+//-----------------------------------------------------------------------------
+bool XdfChunkReader::isNumeric (size_t stream) const
+{
+    return XdfChunkReader_::getValueSize (streams_[stream].channel_format) > 0;
+}
+
+//-----------------------------------------------------------------------------
+bool XdfChunkReader::decodeSamples (size_t stream, size_t chunk, float32* const* rows,
+                                    double* time_stamps) const
+{
+    using namespace XdfChunkReader_;
+
+    Stream const& info = streams_[stream];
+    SamplesChunk const& samples = info.chunks[chunk];
+    uchar const* position = file_.data () + samples.position;
+    uchar const* end = file_.data () + samples.end;
+    double interval = info.nominal_srate > 0 ? 1 / info.nominal_srate : 0;
+
+    std::string const& format = info.channel_format;
+    if (format == "float32")
+        return decodeValues<float> (position, end, samples.number_samples, info.channel_count,
+                                    samples.first_time_stamp, interval, rows, time_stamps);
+    if (format == "double64")
+        return decodeValues<double> (position, end, samples.number_samples, info.channel_count,
+                                     samples.first_time_stamp, interval, rows, time_stamps);
+    if (format == "int8")
+        return decodeValues<qint8> (position, end, samples.number_samples, info.channel_count,
+                                    samples.first_time_stamp, interval, rows, time_stamps);
+    if (format == "int16")
+        return decodeValues<qint16> (position, end, samples.number_samples, info.channel_count,
+                                     samples.first_time_stamp, interval, rows, time_stamps);
+    if (format == "int32")
+        return decodeValues<qint32> (position, end, samples.number_samples, info.channel_count,
+                                     samples.first_time_stamp, interval, rows, time_stamps);
+    if (format == "int64")
+        return decodeValues<qint64> (position, end, samples.number_samples, info.channel_count,
+                                     samples.first_time_stamp, interval, rows, time_stamps);
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+bool XdfChunkReader::decodeStrings (size_t stream, size_t chunk, std::vector<std::string>& values,
+                                    std::vector<double>& time_stamps) const
+{
+    using namespace XdfChunkReader_;
+
+    Stream const& info = streams_[stream];
+    SamplesChunk const& samples = info.chunks[chunk];
+    uchar const* position = file_.data () + samples.position;
+    uchar const* end = file_.data () + samples.end;
+    double interval = info.nominal_srate > 0 ? 1 / info.nominal_srate : 0;
+
+    double time_stamp = samples.first_time_stamp - interval;
+    for (size_t sample = 0; sample < samples.number_samples; sample++)
+    {
+        if (!readTimeStamp (position, end, interval, time_stamp))
+            return false;
+        for (int channel = 0; channel < info.channel_count; channel++)
+        {
+            quint64 length = 0;
+            if (!readLength (position, end, length) || length > static_cast<quint64> (end - position))
+                return false;
+            values.push_back (std::string (reinterpret_cast<char const*> (position), length));
+            time_stamps.push_back (time_stamp);
+            position += length;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+double XdfChunkReader::getLastTimeStamp (size_t stream) const
+{
+    Stream const& info = streams_[stream];
+    if (info.chunks.empty ())
+        return NAN;
+
+    size_t chunk = info.chunks.size () - 1;
+    std::vector<double> time_stamps;
+    if (isNumeric (stream))
+    {
+        time_stamps.resize (info.chunks[chunk].number_samples, NAN);
+        decodeSamples (stream, chunk, 0, time_stamps.data ());
+    }
+    else
+    {
+        std::vector<std::string> values;
+        decodeStrings (stream, chunk, values, time_stamps);
+    }
+    return time_stamps.empty () ? info.chunks[chunk].first_time_stamp : time_stamps.back ();
+}
+
+//-----------------------------------------------------------------------------
+double XdfChunkReader::synchronise (size_t stream, double time_stamp) const
+{
+    std::vector<std::pair<double, double> > const& offsets = streams_[stream].clock_offsets;
+    if (offsets.empty ())
+        return time_stamp;
+
+    std::vector<std::pair<double, double> >::const_iterator offset =
+            std::lower_bound (offsets.begin (), offsets.end (), time_stamp,
+                              [] (std::pair<double, double> const& offset, double time_stamp)
+    {
+        return offset.first < time_stamp;
+    });
+    if (offset != offsets.begin ())
+        --offset;
+    return time_stamp + offset->second;
+}
+
+}
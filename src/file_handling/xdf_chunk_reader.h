@@ -0,0 +1,119 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef XDF_CHUNK_READER_H
+#define XDF_CHUNK_READER_H
+
+#include "base/mapped_data_block.h"
+#include "base/sigviewer_user_types.h"
+
+#include <QString>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// XdfChunkReader
+///
+/// reads an XDF file (https://github.com/sccn/xdf/wiki/Specifications) chunk
+/// by chunk out of a memory mapping; scan only parses the headers and footers
+/// of the streams and notes where the Samples chunks are, so the samples can
+/// be decoded later, in any order and in parallel
+///
+/// thread safe once scanned
+class XdfChunkReader
+{
+public:
+    //-------------------------------------------------------------------------
+    struct SamplesChunk
+    {
+        qint64 position;            // of the first sample in the file
+        qint64 end;                 // of the chunk
+        size_t first_sample;        // index of the first sample in the stream
+        size_t number_samples;
+        double first_time_stamp;    // not synchronised
+    };
+
+    //-------------------------------------------------------------------------
+    struct Stream
+    {
+        quint32 id;
+        std::string header;         // XML of the StreamHeader chunk
+        std::string footer;         // XML of the StreamFooter chunk
+        std::string name;
+        std::string type;
+        std::string channel_format;
+        int channel_count;
+        double nominal_srate;
+        std::vector<std::map<std::string, std::string> > channels;  // desc/channels/channel
+        std::vector<SamplesChunk> chunks;
+        size_t number_samples;
+        std::vector<std::pair<double, double> > clock_offsets;      // collection time, offset
+    };
+
+    //-------------------------------------------------------------------------
+    XdfChunkReader (QString const& file_path);
+
+    //-------------------------------------------------------------------------
+    /// reads the chunk table; a truncated last chunk ends the file
+    ///
+    /// @return an error message or an empty string
+    QString scan ();
+
+    //-------------------------------------------------------------------------
+    double getVersion () const {return version_;}
+
+    //-------------------------------------------------------------------------
+    std::vector<Stream> const& getStreams () const {return streams_;}
+
+    //-------------------------------------------------------------------------
+    /// @return false if the samples of the stream are strings
+    bool isNumeric (size_t stream) const;
+
+    //-------------------------------------------------------------------------
+    /// decodes the numeric samples of a chunk; samples without a time stamp
+    /// follow the previous one by the nominal interval of the stream
+    ///
+    /// @param rows 0 or one destination per channel for the samples of the
+    ///             chunk
+    /// @param time_stamps 0 or the destination of the time stamps
+    /// @return false if the chunk is broken
+    bool decodeSamples (size_t stream, size_t chunk, float32* const* rows,
+                        double* time_stamps) const;
+
+    //-------------------------------------------------------------------------
+    /// decodes the string samples of a chunk (e.g. markers) and appends the
+    /// values of all channels and their time stamps
+    ///
+    /// @return false if the chunk is broken
+    bool decodeStrings (size_t stream, size_t chunk, std::vector<std::string>& values,
+                        std::vector<double>& time_stamps) const;
+
+    //-------------------------------------------------------------------------
+    /// @return the not synchronised time stamp of the last sample of the
+    ///         stream or NAN if it has none
+    double getLastTimeStamp (size_t stream) const;
+
+    //-------------------------------------------------------------------------
+    /// @return the time stamp corrected by the clock offset measured last
+    ///         before it, as libxdf synchronises the streams
+    double synchronise (size_t stream, double time_stamp) const;
+
+private:
+    Q_DISABLE_COPY (XdfChunkReader);
+
+    MappedFile file_;
+    double version_;
+    std::vector<Stream> streams_;
+};
+
+}
+
+#endif // XDF_CHUNK_READER_H
@@ -7,25 +7,210 @@
 #include "biosig_basic_header.h"
 #include "file_handler_factory_registrator.h"
 #include "gui/progress_bar.h"
-#include "base/fixed_data_block.h"
+#include "base/native_rate_data_block.h"
+#include "base/sparse_data_block.h"
 #include "gui/dialogs/resampling_dialog.h"
+#include "decoded_cache.h"
+#include "xdf_chunk_reader.h"
+#include "xdf_streaming_decoder.h"
 
+#include <QDataStream>
 #include <QTextStream>
 #include <QTranslator>
 #include <QMutexLocker>
 #include <QTime>
 #include <QMessageBox>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #include <cmath>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
 #include <time.h>       /* clock_t, clock, CLOCKS_PER_SEC */
 
 
 namespace sigviewer
 {
 
-//the object to store XDF data
-QSharedPointer<Xdf> XDFdata = QSharedPointer<Xdf>(new Xdf);
+quint32 const XDFReader::DECODED_CACHE_DATA_VERSION_ = 1;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// (de)serialization of the members of Xdf for the DecodedCache; only the kind
+// of a member (number, string or container) matters, not its exact type
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type writeValue (QDataStream& out, T const& value);
+void writeValue (QDataStream& out, std::string const& value);
+template <typename A, typename B>
+void writeValue (QDataStream& out, std::pair<A, B> const& value);
+template <typename T>
+void writeValue (QDataStream& out, std::vector<T> const& value);
+template <typename T>
+void writeValue (QDataStream& out, std::set<T> const& value);
+template <typename K, typename V>
+void writeValue (QDataStream& out, std::map<K, V> const& value);
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type readValue (QDataStream& in, T& value);
+void readValue (QDataStream& in, std::string& value);
+template <typename A, typename B>
+void readValue (QDataStream& in, std::pair<A, B>& value);
+template <typename T>
+void readValue (QDataStream& in, std::vector<T>& value);
+template <typename T>
+void readValue (QDataStream& in, std::set<T>& value);
+template <typename K, typename V>
+void readValue (QDataStream& in, std::map<K, V>& value);
+
+//-----------------------------------------------------------------------------
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type writeValue (QDataStream& out, T const& value)
+{
+    if (std::is_floating_point<T>::value)
+        out << static_cast<double>(value);
+    else
+        out << static_cast<qint64>(value);
+}
+
+//-----------------------------------------------------------------------------
+void writeValue (QDataStream& out, std::string const& value)
+{
+    out << QByteArray (value.data(), value.size());
+}
+
+//-----------------------------------------------------------------------------
+template <typename A, typename B>
+void writeValue (QDataStream& out, std::pair<A, B> const& value)
+{
+    writeValue (out, value.first);
+    writeValue (out, value.second);
+}
+
+//-----------------------------------------------------------------------------
+template <typename Container>
+void writeElements (QDataStream& out, Container const& value)
+{
+    out << static_cast<quint64>(value.size());
+    for (auto const& element : value)
+        writeValue (out, element);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void writeValue (QDataStream& out, std::vector<T> const& value)
+{
+    writeElements (out, value);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void writeValue (QDataStream& out, std::set<T> const& value)
+{
+    writeElements (out, value);
+}
+
+//-----------------------------------------------------------------------------
+template <typename K, typename V>
+void writeValue (QDataStream& out, std::map<K, V> const& value)
+{
+    writeElements (out, value);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type readValue (QDataStream& in, T& value)
+{
+    if (std::is_floating_point<T>::value)
+    {
+        double number = 0;
+        in >> number;
+        value = static_cast<T>(number);
+    }
+    else
+    {
+        qint64 number = 0;
+        in >> number;
+        value = static_cast<T>(number);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void readValue (QDataStream& in, std::string& value)
+{
+    QByteArray bytes;
+    in >> bytes;
+    value = bytes.toStdString();
+}
+
+//-----------------------------------------------------------------------------
+template <typename A, typename B>
+void readValue (QDataStream& in, std::pair<A, B>& value)
+{
+    readValue (in, value.first);
+    readValue (in, value.second);
+}
+
+//-----------------------------------------------------------------------------
+/// inserts the elements at the end of the container
+template <typename Element, typename Container>
+void readElements (QDataStream& in, Container& value)
+{
+    quint64 size = 0;
+    in >> size;
+    value.clear();
+    for (quint64 index = 0; index < size && in.status() == QDataStream::Ok; index++)
+    {
+        Element element {};
+        readValue (in, element);
+        value.insert (value.end(), element);
+    }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void readValue (QDataStream& in, std::vector<T>& value)
+{
+    readElements<T> (in, value);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void readValue (QDataStream& in, std::set<T>& value)
+{
+    readElements<T> (in, value);
+}
+
+//-----------------------------------------------------------------------------
+template <typename K, typename V>
+void readValue (QDataStream& in, std::map<K, V>& value)
+{
+    readElements<std::pair<K, V> > (in, value);
+}
+
+//-----------------------------------------------------------------------------
+// a channel of a regular stream, which only stores the recorded samples; the
+// samples are moved out of the row
+QSharedPointer<DataBlock const> createRegularChannel (std::vector<float>& row, int starting_position,
+                                                      size_t number_samples, float64 sample_rate)
+{
+    size_t begin = std::min<size_t> (std::max (starting_position, 0), number_samples);
+    row.resize (std::min (row.size (), number_samples - begin));
+
+    std::vector<SparseExtent> extents;
+    if (!row.empty ())
+        extents.push_back ({begin, std::move (row)});
+    return QSharedPointer<DataBlock const> (new SparseDataBlock (std::move (extents), number_samples,
+                                                                 sample_rate));
+}
+
+}
 
 
 //-----------------------------------------------------------------------------
@@ -34,6 +219,7 @@ FILE_SIGNAL_READER_REGISTRATION(xdf, XDFReader);
 
 //-----------------------------------------------------------------------------
 XDFReader::XDFReader() :
+    xdf_ (new Xdf),
     basic_header_ (0),
     buffered_all_channels_ (false),
     buffered_all_events_ (false)
@@ -68,8 +254,20 @@ QSharedPointer<DataBlock const> XDFReader::getSignalData (ChannelID channel_id,
                                        size_t start_sample,
                                        size_t length) const
 {
+    if (!streaming_decoder_.isNull())
+        return getStreamedData (channel_id, start_sample, length, true);
+
     QMutexLocker lock (&mutex_);
 
+    if (!decoded_cache_.isNull())
+    {
+        QSharedPointer<DataBlock const> data = decoded_cache_->getChannel (channel_id);
+        if (data.isNull() ||
+            (length == basic_header_->getNumberOfSamples() && start_sample == 0))
+            return data;
+        return data->createSubBlock (start_sample, length);
+    }
+
     if (!buffered_all_channels_)
         bufferAllChannels();
 
@@ -83,6 +281,23 @@ QSharedPointer<DataBlock const> XDFReader::getSignalData (ChannelID channel_id,
         return channel_map_[channel_id]->createSubBlock (start_sample, length);
 }
 
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> XDFReader::getAvailableSignalData (ChannelID channel_id,
+                                                                   size_t start_sample,
+                                                                   size_t length) const
+{
+    if (streaming_decoder_.isNull())
+        return getSignalData (channel_id, start_sample, length);
+
+    return getStreamedData (channel_id, start_sample, length, false);
+}
+
+//-----------------------------------------------------------------------------
+bool XDFReader::waitUntilDecoded (int timeout_in_ms) const
+{
+    return streaming_decoder_.isNull() || streaming_decoder_->waitUntilDecoded (timeout_in_ms);
+}
+
 //-----------------------------------------------------------------------------
 QList<QSharedPointer<SignalEvent const> > XDFReader::getEvents () const
 {
@@ -104,149 +319,387 @@ QString XDFReader::open (QString const& file_path)
 //-----------------------------------------------------------------------------
 QString XDFReader::loadFixedHeader(const QString& file_path)
 {
-    QMutexLocker locker (&xdf_access_lock_);
+    if (!QFile::exists(file_path)) //Double check whether file exists
+    {
+        QMessageBox msgBox;
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setText(QObject::tr("File does not exist."));
+        msgBox.setStandardButtons(QMessageBox::Ok);
+        msgBox.exec();
 
-    clock_t t = clock();
-    clock_t t2 = clock();
+        return "non-exist";
+    }
 
-    if (QFile::exists(file_path)) //Double check whether file exists
+    int sample_rate = 0;
+    QString error = loadDecodedCache (file_path, sample_rate);
+    if (error.isEmpty() && decoded_cache_.isNull())
     {
-        if (XDFdata->load_xdf(file_path.toStdString()) == 0)
+        // libxdf is only needed for streams whose samples cannot be decoded
+        // chunk by chunk
+        QSharedPointer<XdfChunkReader> chunk_reader (new XdfChunkReader (file_path));
+        bool decodable = chunk_reader->scan().isEmpty() && !chunk_reader->getStreams().empty();
+        for (size_t stream = 0; stream < chunk_reader->getStreams().size(); stream++)
+            if (!chunk_reader->isNumeric (stream) &&
+                chunk_reader->getStreams()[stream].channel_format.compare("string"))
+                decodable = false;
+
+        if (decodable)
+            error = loadChunks (chunk_reader, sample_rate);
+        else
+            error = loadXdf (file_path, sample_rate);
+    }
+    if (error.size() > 0)
+        return error;
+
+    setStreamColors();
+    setEventTypeColors();
+
+    bool showWarning = false;
+
+    for (auto const &stream : xdf_->streams)
+    {
+        if (std::abs(stream.info.effective_sample_rate - stream.info.nominal_srate) >
+                stream.info.nominal_srate / 20)
         {
-            XDFdata->createLabels();
+            showWarning = true;
+        }
+    }
 
-            sampleRateTypes sampleRateType = selectSampleRateType();
+    if (showWarning)
+        QMessageBox::warning(0, "SigViewer",
+                             QObject::tr("The effective sampling rate of at least one stream is significantly different than the reported nominal sampling rate. Signal visualization might be inaccurate."), QMessageBox::Ok, QMessageBox::Ok);
 
-            switch (sampleRateType) {
-            case No_streams_found:
-            {
-                QMessageBox msgBox;
-                msgBox.setIcon(QMessageBox::Warning);
-                msgBox.setText(QObject::tr("No Stream Found"));
-                msgBox.setStandardButtons(QMessageBox::Ok);
-                msgBox.exec();
 
-                return "non-exist";
-            }
-            case Zero_Hz_Only:
-            {
-                ResamplingDialog prompt(XDFdata->majSR, XDFdata->maxSR);
+    basic_header_ = QSharedPointer<BasicHeader>
+            (new BiosigBasicHeader ("XDF", file_path, xdf_));
 
-                if (prompt.exec() == QDialog::Accepted)
-                {
-                    XDFdata->majSR = prompt.getUserSrate();
-                    XDFdata->resample(XDFdata->majSR);
-                }
-                else
-                {
-                    Xdf empty;
-                    std::swap(*XDFdata, empty);
-                    return "Cancelled";
-                }
-            }
-                break;
-            case Mono_Sample_Rate:
-            {
-                XDFdata->calcTotalLength(XDFdata->majSR);
+    basic_header_->setNumberEvents(xdf_->eventType.size());
 
-                XDFdata->adjustTotalLength();
+    if (xdf_->fileEffectiveSampleRate)
+        basic_header_->setEventSamplerate(xdf_->fileEffectiveSampleRate);
+    else
+        basic_header_->setEventSamplerate(xdf_->majSR);
 
-                if (XDFdata->effectiveSampleRateVector.size())
-                {
-                    /* If and only if the file contains only one sample rate, we use effective
-                    sample rate to more accurately display events. Effective sample rates
-                    can be slightly different across streams, so we calculate the mean here */
-
-                    double init = 0.0;
-                    XDFdata->fileEffectiveSampleRate =
-                            std::accumulate(XDFdata->effectiveSampleRateVector.begin(),
-                                            XDFdata->effectiveSampleRateVector.end(), init)
-                            / XDFdata->effectiveSampleRateVector.size();
-                }
-            }
-                break;
-            case Multi_Sample_Rate:
-            {
-                ResamplingDialog prompt(XDFdata->majSR, XDFdata->maxSR);
+    return "";
+}
 
-                if (prompt.exec() == QDialog::Accepted)
-                {
-                    XDFdata->majSR = prompt.getUserSrate();
-                    XDFdata->resample(XDFdata->majSR);
-                }
-                else
-                {
-                    Xdf empty;
-                    std::swap(*XDFdata, empty);
-                    return "Cancelled";
-                }
-            }
-                break;
-            default:
-                qDebug() << "Unknown sample rate type.";
-                break;
-            }
+//-----------------------------------------------------------------------------
+QString XDFReader::loadXdf (QString const& file_path, int sample_rate)
+{
+    clock_t t = clock();
+    clock_t t2 = clock();
 
-            XDFdata->freeUpTimeStamps(); //to save some memory
+    if (xdf_->load_xdf(file_path.toStdString()) != 0)
+    {
+        QMessageBox msgBox;
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setText(QObject::tr("Unable to open file."));
+        msgBox.setStandardButtons(QMessageBox::Ok);
+        msgBox.exec();
 
-            setStreamColors();
-            setEventTypeColors();
+        return "non-exist";
+    }
 
-            t = clock() - t;
-            qDebug() << "it took " << ((float)t) / CLOCKS_PER_SEC << " seconds reading data";
+    xdf_->createLabels();
 
-            t = clock() - t - t2;
-            qDebug() << "it took " << ((float)t) / CLOCKS_PER_SEC << " additional seconds loading XDF header";
+    sampleRateTypes sampleRateType = selectSampleRateType();
 
-            bool showWarning = false;
+    switch (sampleRateType) {
+    case No_streams_found:
+    {
+        QMessageBox msgBox;
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setText(QObject::tr("No Stream Found"));
+        msgBox.setStandardButtons(QMessageBox::Ok);
+        msgBox.exec();
 
-            for (auto const &stream : XDFdata->streams)
+        return "non-exist";
+    }
+    case Zero_Hz_Only:
+    case Multi_Sample_Rate:
+    {
+        if (sample_rate == 0)
+        {
+            ResamplingDialog prompt(*xdf_, xdf_->majSR, xdf_->maxSR);
+
+            if (prompt.exec() != QDialog::Accepted)
             {
-                if (std::abs(stream.info.effective_sample_rate - stream.info.nominal_srate) >
-                        stream.info.nominal_srate / 20)
-                {
-                    showWarning = true;
-                }
+                Xdf empty;
+                std::swap(*xdf_, empty);
+                return "Cancelled";
             }
+            sample_rate = prompt.getUserSrate();
+        }
 
-            if (showWarning)
-                QMessageBox::warning(0, "SigViewer",
-                                     QObject::tr("The effective sampling rate of at least one stream is significantly different than the reported nominal sampling rate. Signal visualization might be inaccurate."), QMessageBox::Ok, QMessageBox::Ok);
+        // the streams keep their native sample rates and are mapped onto the
+        // chosen one when accessed, see bufferAllChannels
+        xdf_->majSR = sample_rate;
+        xdf_->calcTotalLength(xdf_->majSR);
+    }
+        break;
+    case Mono_Sample_Rate:
+    {
+        xdf_->calcTotalLength(xdf_->majSR);
 
+        xdf_->adjustTotalLength();
 
-            basic_header_ = QSharedPointer<BasicHeader>
-                    (new BiosigBasicHeader ("XDF", file_path));
+        if (xdf_->effectiveSampleRateVector.size())
+        {
+            /* If and only if the file contains only one sample rate, we use effective
+            sample rate to more accurately display events. Effective sample rates
+            can be slightly different across streams, so we calculate the mean here */
+
+            double init = 0.0;
+            xdf_->fileEffectiveSampleRate =
+                    std::accumulate(xdf_->effectiveSampleRateVector.begin(),
+                                    xdf_->effectiveSampleRateVector.end(), init)
+                    / xdf_->effectiveSampleRateVector.size();
+        }
+    }
+        break;
+    default:
+        qDebug() << "Unknown sample rate type.";
+        break;
+    }
 
-            basic_header_->setNumberEvents(XDFdata->eventType.size());
+    xdf_->freeUpTimeStamps(); //to save some memory
 
-            if (XDFdata->fileEffectiveSampleRate)
-                basic_header_->setEventSamplerate(XDFdata->fileEffectiveSampleRate);
-            else
-                basic_header_->setEventSamplerate(XDFdata->majSR);
+    t = clock() - t;
+    qDebug() << "it took " << ((float)t) / CLOCKS_PER_SEC << " seconds reading data";
 
-            return "";
+    t = clock() - t - t2;
+    qDebug() << "it took " << ((float)t) / CLOCKS_PER_SEC << " additional seconds loading XDF header";
+
+    return "";
+}
+
+//-----------------------------------------------------------------------------
+QString XDFReader::loadChunks (QSharedPointer<XdfChunkReader const> chunk_reader, int sample_rate)
+{
+    // the members of Xdf libxdf fills while parsing, except for the samples
+    std::vector<XdfChunkReader::Stream> const& chunk_streams = chunk_reader->getStreams();
+    std::map<int, int> channels_per_sample_rate;
+    double max_time_stamp = NAN;
+    xdf_->version = chunk_reader->getVersion();
+    xdf_->minTS = NAN;
+    for (size_t index = 0; index < chunk_streams.size(); index++)
+    {
+        XdfChunkReader::Stream const& chunk_stream = chunk_streams[index];
+        xdf_->streams.emplace_back();
+        auto& stream = xdf_->streams.back();
+        stream.streamHeader = chunk_stream.header;
+        stream.streamFooter = chunk_stream.footer;
+        stream.info.channel_count = chunk_stream.channel_count;
+        stream.info.nominal_srate = chunk_stream.nominal_srate;
+        stream.info.name = chunk_stream.name;
+        stream.info.type = chunk_stream.type;
+        stream.info.channel_format = chunk_stream.channel_format;
+        stream.info.channels = chunk_stream.channels;
+
+        double first_time_stamp = NAN;
+        double last_time_stamp = NAN;
+        if (chunk_reader->isNumeric (index) && chunk_stream.number_samples > 0)
+        {
+            first_time_stamp = chunk_reader->synchronise (index, chunk_stream.chunks.front().first_time_stamp);
+            last_time_stamp = chunk_reader->synchronise (index, chunk_reader->getLastTimeStamp (index));
+            if (stream.info.nominal_srate != 0 && last_time_stamp > first_time_stamp)
+            {
+                stream.info.effective_sample_rate = chunk_stream.number_samples /
+                                                    (last_time_stamp - first_time_stamp);
+                xdf_->effectiveSampleRateVector.emplace_back(stream.info.effective_sample_rate);
+            }
+
+            xdf_->totalCh += chunk_stream.channel_count;
+            for (int channel = 0; channel < chunk_stream.channel_count; channel++)
+                xdf_->streamMap.emplace_back(index);
         }
-        else
+        else if (!chunk_reader->isNumeric (index))
+        {
+            // markers are few, so they are decoded right away
+            for (size_t chunk = 0; chunk < chunk_stream.chunks.size(); chunk++)
+            {
+                std::vector<std::string> values;
+                std::vector<double> time_stamps;
+                chunk_reader->decodeStrings (index, chunk, values, time_stamps);
+                for (size_t value = 0; value < values.size(); value++)
+                {
+                    double time_stamp = chunk_reader->synchronise (index, time_stamps[value]);
+                    xdf_->eventMap.emplace_back(std::make_pair(values[value], time_stamp), index);
+                    if (!(time_stamp >= first_time_stamp))
+                        first_time_stamp = time_stamp;
+                    if (!(time_stamp <= last_time_stamp))
+                        last_time_stamp = time_stamp;
+                }
+            }
+        }
+        stream.info.first_timestamp = first_time_stamp;
+
+        if (!std::isnan(first_time_stamp) && !(first_time_stamp >= xdf_->minTS))
+            xdf_->minTS = first_time_stamp;
+        if (!std::isnan(last_time_stamp) && !(last_time_stamp <= max_time_stamp))
+            max_time_stamp = last_time_stamp;
+        if (stream.info.nominal_srate != 0)
+            channels_per_sample_rate[stream.info.nominal_srate] += stream.info.channel_count;
+        xdf_->maxSR = std::max<double>(xdf_->maxSR, stream.info.nominal_srate);
+        xdf_->sampleRateMap.emplace(stream.info.nominal_srate);
+    }
+    if (std::isnan(xdf_->minTS))
+        xdf_->minTS = 0;
+
+    // the rate with the most channels, the lowest one of equal ones
+    xdf_->majSR = 0;
+    int major_channels = 0;
+    for (auto const& entry : channels_per_sample_rate)
+    {
+        if (entry.second > major_channels)
         {
-            QMessageBox msgBox;
-            msgBox.setIcon(QMessageBox::Warning);
-            msgBox.setText(QObject::tr("Unable to open file."));
-            msgBox.setStandardButtons(QMessageBox::Ok);
-            msgBox.exec();
+            xdf_->majSR = entry.first;
+            major_channels = entry.second;
+        }
+    }
 
-            return "non-exist";
+    std::stable_sort(xdf_->eventMap.begin(), xdf_->eventMap.end(), [] (auto const& event, auto const& other)
+    {
+        return event.first.second < other.first.second;
+    });
+    std::map<std::string, size_t> event_types;
+    for (auto const& event : xdf_->eventMap)
+    {
+        if (!event_types.count(event.first.first))
+        {
+            event_types[event.first.first] = xdf_->dictionary.size();
+            xdf_->dictionary.push_back(event.first.first);
         }
+        xdf_->eventType.push_back(event_types[event.first.first]);
     }
-    else
+
+    // libxdf labels the channels of streams without a channel description
+    // by their rows
+    for (size_t index = 0; index < chunk_streams.size(); index++)
+        if (chunk_reader->isNumeric (index) && chunk_streams[index].number_samples > 0)
+            xdf_->streams[index].time_series.resize(chunk_streams[index].channel_count);
+    xdf_->createLabels();
+    for (auto& stream : xdf_->streams)
+        stream.time_series.clear();
+
+    switch (selectSampleRateType())
+    {
+    case No_streams_found:
     {
         QMessageBox msgBox;
         msgBox.setIcon(QMessageBox::Warning);
-        msgBox.setText(QObject::tr("File does not exist."));
+        msgBox.setText(QObject::tr("No Stream Found"));
         msgBox.setStandardButtons(QMessageBox::Ok);
         msgBox.exec();
 
         return "non-exist";
     }
+    case Zero_Hz_Only:
+    case Multi_Sample_Rate:
+    {
+        if (sample_rate == 0)
+        {
+            ResamplingDialog prompt(*xdf_, xdf_->majSR, xdf_->maxSR);
+
+            if (prompt.exec() != QDialog::Accepted)
+            {
+                Xdf empty;
+                std::swap(*xdf_, empty);
+                return "Cancelled";
+            }
+            sample_rate = prompt.getUserSrate();
+        }
+        xdf_->majSR = sample_rate;
+        xdf_->totalLen = std::max(0.0, (max_time_stamp - xdf_->minTS) * xdf_->majSR);
+    }
+        break;
+    case Mono_Sample_Rate:
+    {
+        size_t total_length = std::max(0.0, (max_time_stamp - xdf_->minTS) * xdf_->majSR);
+        for (size_t index = 0; index < chunk_streams.size(); index++)
+            if (chunk_reader->isNumeric (index))
+                total_length = std::max(total_length, chunk_streams[index].number_samples);
+        xdf_->totalLen = total_length;
+
+        if (xdf_->effectiveSampleRateVector.size())
+        {
+            double init = 0.0;
+            xdf_->fileEffectiveSampleRate =
+                    std::accumulate(xdf_->effectiveSampleRateVector.begin(),
+                                    xdf_->effectiveSampleRateVector.end(), init)
+                    / xdf_->effectiveSampleRateVector.size();
+        }
+    }
+        break;
+    default:
+        qDebug() << "Unknown sample rate type.";
+        break;
+    }
+
+    // the numeric streams are placed onto the samples of the file as
+    // bufferAllChannels does it
+    std::vector<XdfStreamingDecoder::Layout> layouts;
+    ChannelID first_channel = 0;
+    size_t number_samples = xdf_->totalLen;
+    for (size_t index = 0; index < chunk_streams.size(); index++)
+    {
+        if (!chunk_reader->isNumeric (index) || chunk_streams[index].number_samples == 0)
+            continue;
+
+        auto const& info = xdf_->streams[index].info;
+        XdfStreamingDecoder::Layout layout {index, first_channel, XdfStreamingDecoder::Layout::REGULAR, 0, 0};
+        if (info.nominal_srate == 0)
+            layout.placement = XdfStreamingDecoder::Layout::IRREGULAR;
+        else if (info.nominal_srate != xdf_->majSR)
+        {
+            layout.placement = XdfStreamingDecoder::Layout::NATIVE_RATE;
+            layout.offset = (info.first_timestamp - xdf_->minTS) * xdf_->majSR;
+        }
+        else
+        {
+            long long starting_position = (info.first_timestamp - xdf_->minTS) * xdf_->majSR;
+            long long length = chunk_streams[index].number_samples;
+            if (length > static_cast<long long>(number_samples) - starting_position)
+                starting_position = static_cast<long long>(number_samples) - length;
+            layout.starting_position = std::max(0LL, starting_position);
+        }
+        layouts.push_back(layout);
+        first_channel += info.channel_count;
+    }
+
+    streaming_decoder_ = QSharedPointer<XdfStreamingDecoder> (
+            new XdfStreamingDecoder (chunk_reader, layouts, number_samples, xdf_->majSR, xdf_->minTS));
+    streaming_decoder_->start();
+    return "";
+}
+
+//-----------------------------------------------------------------------------
+QString XDFReader::loadDecodedCache (QString const& file_path, int& sample_rate)
+{
+    QSharedPointer<DecodedCache const> cache = DecodedCache::open (file_path);
+    if (cache.isNull () || !restoreDecodedCacheData (cache->getReaderData ()))
+        return "";
+
+    // the user is asked for the sample rate as usual, the cache only holds
+    // the channels resampled to the rate chosen last time
+    sampleRateTypes sampleRateType = selectSampleRateType();
+    if (sampleRateType == Zero_Hz_Only || sampleRateType == Multi_Sample_Rate)
+    {
+        ResamplingDialog prompt(*xdf_, xdf_->majSR, xdf_->maxSR);
+        bool accepted = prompt.exec() == QDialog::Accepted;
+        if (!accepted || prompt.getUserSrate() != xdf_->majSR)
+        {
+            Xdf empty;
+            std::swap(*xdf_, empty);
+            if (!accepted)
+                return "Cancelled";
+            sample_rate = prompt.getUserSrate();
+            return "";
+        }
+    }
+
+    decoded_cache_ = cache;
+    return "";
 }
 
 //-----------------------------------------------------------------------------
@@ -256,6 +709,37 @@ QSharedPointer<BasicHeader> XDFReader::getBasicHeader ()
     return basic_header_;
 }
 
+//-----------------------------------------------------------------------------
+float64 XDFReader::getChannelSampleRate (ChannelID channel_id) const
+{
+    if (channel_id < 0 || static_cast<size_t>(channel_id) >= xdf_->streamMap.size())
+        return xdf_->majSR;
+
+    float64 sample_rate = xdf_->streams[xdf_->streamMap[channel_id]].info.nominal_srate;
+    return sample_rate != 0 ? sample_rate : xdf_->majSR;
+}
+
+//-----------------------------------------------------------------------------
+float64 XDFReader::getChannelTimeOffset (ChannelID channel_id) const
+{
+    if (channel_id < 0 || static_cast<size_t>(channel_id) >= xdf_->streamMap.size())
+        return 0;
+
+    return xdf_->streams[xdf_->streamMap[channel_id]].info.first_timestamp - xdf_->minTS;
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> XDFReader::getStreamedData (ChannelID channel_id, size_t start_sample,
+                                                            size_t length, bool wait) const
+{
+    QSharedPointer<DataBlock const> data = streaming_decoder_->getChannel (channel_id, start_sample,
+                                                                         length, wait);
+    if (data.isNull() ||
+        (length == basic_header_->getNumberOfSamples() && start_sample == 0))
+        return data;
+    return data->createSubBlock (start_sample, length);
+}
+
 //-----------------------------------------------------------------------------
 int XDFReader::setStreamColors()
 {
@@ -268,11 +752,11 @@ int XDFReader::setStreamColors()
     //because the colors I picked look the best when they are sorted in order
     int colorChoice = -1;
     int stream = -1;
-    for (size_t i = 0; i < XDFdata->totalCh; i++)
+    for (size_t i = 0; i < xdf_->totalCh; i++)
     {
-        if (stream != XDFdata->streamMap[i])
+        if (stream != xdf_->streamMap[i])
         {
-            stream = XDFdata->streamMap[i];
+            stream = xdf_->streamMap[i];
             colorChoice++;
             if (colorChoice == 8)   //we only have 8 colors
                 colorChoice = 0;
@@ -288,16 +772,16 @@ int XDFReader::setStreamColors()
 //-----------------------------------------------------------------------------
 XDFReader::sampleRateTypes XDFReader::selectSampleRateType()
 {
-    switch (XDFdata->sampleRateMap.size()) {
+    switch (xdf_->sampleRateMap.size()) {
     case 0:
         return No_streams_found;
     case 1:
-        if (XDFdata->sampleRateMap.count(0))
+        if (xdf_->sampleRateMap.count(0))
             return Zero_Hz_Only;
         else
             return Mono_Sample_Rate;
     case 2:
-        if (XDFdata->sampleRateMap.count(0))
+        if (xdf_->sampleRateMap.count(0))
             return Mono_Sample_Rate;
         else
             return Multi_Sample_Rate;
@@ -309,76 +793,84 @@ XDFReader::sampleRateTypes XDFReader::selectSampleRateType()
 //-----------------------------------------------------------------------------
 void XDFReader::bufferAllChannels () const
 {
-    size_t numberOfSamples = XDFdata->totalLen;
+    size_t numberOfSamples = xdf_->totalLen;
 
     QString progress_name = QObject::tr("Loading data...");
 
-    //load all signals channel by channel
-    unsigned channel_id = 0;
-    for (auto &stream : XDFdata->streams)
+    // every row of a stream becomes a channel of its own, so the rows of all
+    // streams are materialised in parallel; the channels are numbered as the
+    // rows of the streams with numeric samples appear in the file
+    struct Row
     {
+        size_t stream;
+        size_t row;
+        int starting_position;   // of regular streams
+    };
+    std::vector<Row> rows;
+    for (size_t stream_index = 0; stream_index < xdf_->streams.size(); stream_index++)
+    {
+        auto const &stream = xdf_->streams[stream_index];
+        int startingPosition = 0;
         if (stream.info.nominal_srate != 0 && stream.info.channel_format.compare("string")) // filter the string streams
         {
-            int startingPosition = (stream.info.first_timestamp - XDFdata->minTS) * XDFdata->majSR;
-
-            if (stream.time_series.front().size() > XDFdata->totalLen - startingPosition )
-                startingPosition = XDFdata->totalLen - stream.time_series.front().size();
-
-            for (auto &row : stream.time_series)
-            {
-                ProgressBar::instance().increaseValue (1, progress_name);
+            startingPosition = (stream.info.first_timestamp - xdf_->minTS) * xdf_->majSR;
 
-                QSharedPointer<QVector<float32> > raw_data(new QVector<float32> (numberOfSamples, NAN));
-
-                std::copy(row.begin(), row.end(), raw_data->begin() + startingPosition);
-                QSharedPointer<DataBlock const> data_block(new FixedDataBlock(raw_data, XDFdata->majSR));
+            if (stream.time_series.front().size() > xdf_->totalLen - startingPosition )
+                startingPosition = xdf_->totalLen - stream.time_series.front().size();
+        }
+        else if (stream.info.nominal_srate != 0 || stream.time_series.empty())
+            continue; // neither a numeric stream nor irregular samples
 
-                channel_map_[channel_id] = data_block;
-                channel_id++;
+        for (size_t row_index = 0; row_index < stream.time_series.size(); row_index++)
+            rows.push_back({stream_index, row_index, startingPosition});
+    }
 
-                std::vector<float> nothing;
-                row.swap(nothing);
-            }
-            std::vector<double> nothing2;
-            stream.time_stamps.swap(nothing2);
-        }
-        //else if: irregualar samples
-        else if (stream.info.nominal_srate == 0 && !stream.time_series.empty())
+    // the first row is materialised on the calling thread, which then
+    // reports the progress while the others are materialised in the pool
+    std::vector<QSharedPointer<DataBlock const> > data_blocks (rows.size());
+    QSemaphore finished_rows;
+    for (size_t index = 0; index < rows.size(); index++)
+    {
+        auto materialise_row = [&, index] ()
         {
-            for (auto &row : stream.time_series)
-            {
-                ProgressBar::instance().increaseValue (1, progress_name);
+            auto &stream = xdf_->streams[rows[index].stream];
+            auto &row = stream.time_series[rows[index].row];
+            if (stream.info.nominal_srate != 0 && stream.info.nominal_srate != xdf_->majSR)
+                data_blocks[index] = QSharedPointer<DataBlock const> (new NativeRateDataBlock (
+                        std::move (row), stream.info.nominal_srate,
+                        (stream.info.first_timestamp - xdf_->minTS) * xdf_->majSR,
+                        numberOfSamples, xdf_->majSR));
+            else if (stream.info.nominal_srate != 0)
+                data_blocks[index] = createRegularChannel (row, rows[index].starting_position,
+                                                           numberOfSamples, xdf_->majSR);
+            else
+                data_blocks[index] = XdfStreamingDecoder::createIrregularChannel (row, stream.time_stamps,
+                                                                                  xdf_->minTS, xdf_->majSR,
+                                                                                  numberOfSamples);
+
+            std::vector<float> nothing;
+            row.swap(nothing);
+            finished_rows.release ();
+        };
+        if (index == 0)
+            materialise_row ();
+        else
+            QThreadPool::globalInstance ()->start (materialise_row);
+    }
+    for (size_t index = 0; index < rows.size(); index++)
+    {
+        finished_rows.acquire ();
+        ProgressBar::instance().increaseValue (1, progress_name);
+    }
 
-                QSharedPointer<QVector<float32> > raw_data(new QVector<float32> (numberOfSamples, NAN));
+    for (size_t channel_id = 0; channel_id < data_blocks.size(); channel_id++)
+        channel_map_[channel_id] = data_blocks[channel_id];
 
-                for (size_t i = 0; i < row.size(); i++)
-                {
-                    //find out the position using the timestamp provided
-                    float* pt = raw_data->data() + (int)(round((stream.time_stamps[i]- XDFdata->minTS)* XDFdata->majSR));
-                    *pt = row[i];
-
-                    //if i is not the last element of the irregular time series
-                    if (i != stream.time_stamps.size() - 1)
-                    {
-                        //using linear interpolation to fill in the space between every two signals
-                        int interval = round((stream.time_stamps[i+1]
-                                - stream.time_stamps[i]) * XDFdata->majSR);
-                        for (int interpolation = 1; interpolation <= interval; interpolation++)
-                        {
-                            *(pt + interpolation) = row[i] + interpolation * ((row[i+1] - row[i])) / (interval + 1);
-                        }
-                    }
-                }
-                QSharedPointer<DataBlock const> data_block(new FixedDataBlock(raw_data, XDFdata->majSR));
-                channel_map_[channel_id] = data_block;
-                channel_id++;
-
-                std::vector<float> nothing;
-                row.swap(nothing);
-            }
-            std::vector<double> nothing2;
-            stream.time_stamps.swap(nothing2);
-        }
+    // the time stamps are shared by all rows of a stream
+    for (Row const& row : rows)
+    {
+        std::vector<double> nothing2;
+        xdf_->streams[row.stream].time_stamps.swap(nothing2);
     }
 
     buffered_all_channels_ = true;
@@ -387,22 +879,29 @@ void XDFReader::bufferAllChannels () const
 //-------------------------------------------------------------------------
 void XDFReader::bufferAllEvents () const
 {
-    unsigned number_events = XDFdata->eventMap.size();
+    if (!decoded_cache_.isNull())
+    {
+        events_ = decoded_cache_->getEvents();
+        buffered_all_events_ = true;
+        return;
+    }
+
+    unsigned number_events = xdf_->eventMap.size();
 
     double eventSampleRate = 0;
 
-    if (XDFdata->fileEffectiveSampleRate)
-        eventSampleRate = XDFdata->fileEffectiveSampleRate;
+    if (xdf_->fileEffectiveSampleRate)
+        eventSampleRate = xdf_->fileEffectiveSampleRate;
     else
-        eventSampleRate = XDFdata->majSR;
+        eventSampleRate = xdf_->majSR;
 
     for (unsigned index = 0; index < number_events; index++)
     {
         QSharedPointer<SignalEvent> event
-                (new SignalEvent (round ((XDFdata->eventMap[index].first.second - XDFdata->minTS) * eventSampleRate),
-                                  XDFdata->eventType[index] + 1,//index+1 because in SigViewer and libbiosig
+                (new SignalEvent (round ((xdf_->eventMap[index].first.second - xdf_->minTS) * eventSampleRate),
+                                  xdf_->eventType[index] + 1,//index+1 because in SigViewer and libbiosig
                                   //0 is reserved for a special type of event. Thus we increment by 1
-                                  eventSampleRate, XDFdata->eventMap[index].second));
+                                  eventSampleRate, xdf_->eventMap[index].second));
 
         event->setChannel (UNDEFINED_CHANNEL);
         event->setDuration (0);
@@ -412,4 +911,102 @@ void XDFReader::bufferAllEvents () const
     buffered_all_events_ = true;
 }
 
+//-------------------------------------------------------------------------
+QByteArray XDFReader::getDecodedCacheData () const
+{
+    QMutexLocker lock (&mutex_);
+
+    QByteArray data;
+    QDataStream out (&data, QIODevice::WriteOnly);
+    out.setVersion (QDataStream::Qt_6_0);
+    out << DECODED_CACHE_DATA_VERSION_;
+
+    // the stream added for events created by the user is not part of the file
+    size_t number_streams = xdf_->userAddedStream ? xdf_->userAddedStream
+                                                     : xdf_->streams.size();
+    out << static_cast<quint64>(number_streams);
+    for (size_t index = 0; index < number_streams; index++)
+    {
+        auto const& stream = xdf_->streams[index];
+        writeValue (out, stream.streamHeader);
+        writeValue (out, stream.streamFooter);
+        writeValue (out, stream.info.channel_count);
+        writeValue (out, stream.info.nominal_srate);
+        writeValue (out, stream.info.name);
+        writeValue (out, stream.info.type);
+        writeValue (out, stream.info.channel_format);
+        writeValue (out, stream.info.channels);
+        writeValue (out, stream.info.first_timestamp);
+        writeValue (out, stream.info.effective_sample_rate);
+    }
+
+    writeValue (out, xdf_->version);
+    writeValue (out, xdf_->totalLen);
+    writeValue (out, xdf_->totalCh);
+    writeValue (out, xdf_->minTS);
+    writeValue (out, xdf_->majSR);
+    writeValue (out, xdf_->maxSR);
+    writeValue (out, xdf_->fileEffectiveSampleRate);
+    writeValue (out, xdf_->effectiveSampleRateVector);
+    writeValue (out, xdf_->sampleRateMap);
+    writeValue (out, xdf_->streamMap);
+    writeValue (out, xdf_->labels);
+    writeValue (out, xdf_->dictionary);
+    writeValue (out, xdf_->eventMap);
+    writeValue (out, xdf_->eventType);
+
+    return data;
+}
+
+//-------------------------------------------------------------------------
+bool XDFReader::restoreDecodedCacheData (QByteArray const& data)
+{
+    QDataStream in (data);
+    in.setVersion (QDataStream::Qt_6_0);
+    quint32 version = 0;
+    in >> version;
+    if (version != DECODED_CACHE_DATA_VERSION_)
+        return false;
+
+    Xdf restored;
+    quint64 number_streams = 0;
+    in >> number_streams;
+    for (quint64 index = 0; index < number_streams && in.status() == QDataStream::Ok; index++)
+    {
+        restored.streams.emplace_back();
+        auto& stream = restored.streams.back();
+        readValue (in, stream.streamHeader);
+        readValue (in, stream.streamFooter);
+        readValue (in, stream.info.channel_count);
+        readValue (in, stream.info.nominal_srate);
+        readValue (in, stream.info.name);
+        readValue (in, stream.info.type);
+        readValue (in, stream.info.channel_format);
+        readValue (in, stream.info.channels);
+        readValue (in, stream.info.first_timestamp);
+        readValue (in, stream.info.effective_sample_rate);
+    }
+
+    readValue (in, restored.version);
+    readValue (in, restored.totalLen);
+    readValue (in, restored.totalCh);
+    readValue (in, restored.minTS);
+    readValue (in, restored.majSR);
+    readValue (in, restored.maxSR);
+    readValue (in, restored.fileEffectiveSampleRate);
+    readValue (in, restored.effectiveSampleRateVector);
+    readValue (in, restored.sampleRateMap);
+    readValue (in, restored.streamMap);
+    readValue (in, restored.labels);
+    readValue (in, restored.dictionary);
+    readValue (in, restored.eventMap);
+    readValue (in, restored.eventType);
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    std::swap(*xdf_, restored);
+    return true;
+}
+
 }
@@ -8,6 +8,7 @@
 
 #include "file_signal_reader.h"
 #include "xdf.h"
+#include "xdf_chunk_reader.h"
 
 #include <QFile>
 #include <QMutex>
@@ -16,8 +17,7 @@
 namespace sigviewer
 {
 
-//the object to store XDF data
-extern QSharedPointer<Xdf> XDFdata;
+class XdfStreamingDecoder;
 
 //XDFReader, modeled  on BiosigReader
 class XDFReader : public FileSignalReader
@@ -35,6 +35,16 @@ public:
                                                            size_t start_sample,
                                                            size_t length) const;
 
+    //-------------------------------------------------------------------------
+    /// files read chunk by chunk are decoded in the background, see
+    /// XdfStreamingDecoder
+    virtual QSharedPointer<DataBlock const> getAvailableSignalData (ChannelID channel_id,
+                                                                    size_t start_sample,
+                                                                    size_t length) const;
+
+    //-------------------------------------------------------------------------
+    virtual bool waitUntilDecoded (int timeout_in_ms) const;
+
     //-------------------------------------------------------------------------
     virtual QList<QSharedPointer<SignalEvent const> > getEvents () const;
 
@@ -44,6 +54,19 @@ public:
     //-------------------------------------------------------------------------
     virtual QSharedPointer<BasicHeader const> getBasicHeader () const {return basic_header_;}
 
+    //-------------------------------------------------------------------------
+    /// the nominal rate of the stream of the channel; channels of irregular
+    /// streams are placed onto the samples of the file
+    virtual float64 getChannelSampleRate (ChannelID channel_id) const;
+
+    //-------------------------------------------------------------------------
+    virtual float64 getChannelTimeOffset (ChannelID channel_id) const;
+
+    //-------------------------------------------------------------------------
+    /// the parsed file, shared with the basic header and thus with everything
+    /// editing the streams of the file
+    QSharedPointer<Xdf> getXdf () const {return xdf_;}
+
     //-------------------------------------------------------------------------
     int setStreamColors();  /*!< Set a distinct color for each stream. */
 
@@ -58,6 +81,13 @@ public:
 
     sampleRateTypes selectSampleRateType();
 
+    //-------------------------------------------------------------------------
+    virtual QSharedPointer<DecodedCache const> getDecodedCache () const {return decoded_cache_;}
+
+    //-------------------------------------------------------------------------
+    /// the streams, channel labels, events and sample rates of the file
+    virtual QByteArray getDecodedCacheData () const;
+
 private:
     //-------------------------------------------------------------------------
     QString open (QString const& file_path);
@@ -72,9 +102,42 @@ private:
 
     QString loadFixedHeader(const QString& file_path);
 
+    //-------------------------------------------------------------------------
+    /// parses and resamples the whole file
+    ///
+    /// @param sample_rate the sample rate to resample to, if the user is not
+    ///                    to be asked (0 otherwise)
+    QString loadXdf (QString const& file_path, int sample_rate);
+
+    //-------------------------------------------------------------------------
+    /// sets up the header out of the chunk table of the file, without
+    /// decoding the samples, and starts decoding them in the background
+    ///
+    /// @param sample_rate see loadXdf
+    QString loadChunks (QSharedPointer<XdfChunkReader const> chunk_reader, int sample_rate);
+
+    //-------------------------------------------------------------------------
+    QSharedPointer<DataBlock const> getStreamedData (ChannelID channel_id, size_t start_sample,
+                                                     size_t length, bool wait) const;
+
+    //-------------------------------------------------------------------------
+    /// sets decoded_cache_ if the file can be opened from a DecodedCache
+    ///
+    /// @param sample_rate set to the sample rate chosen by the user, if it
+    ///                    differs from the one of the cache
+    QString loadDecodedCache (QString const& file_path, int& sample_rate);
+
+    //-------------------------------------------------------------------------
+    /// @return false if the data is not compatible
+    bool restoreDecodedCacheData (QByteArray const& data);
+
+    static quint32 const DECODED_CACHE_DATA_VERSION_;
+
+    QSharedPointer<Xdf> xdf_;
     QSharedPointer<BasicHeader> basic_header_;
+    QSharedPointer<DecodedCache const> decoded_cache_;
+    QSharedPointer<XdfStreamingDecoder> streaming_decoder_;
     mutable QMutex mutex_;
-    mutable QMutex xdf_access_lock_;
     mutable bool buffered_all_channels_;
     mutable bool buffered_all_events_;
     mutable QMap<ChannelID, QSharedPointer<DataBlock const> > channel_map_;
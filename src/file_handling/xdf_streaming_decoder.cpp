@@ -0,0 +1,326 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "xdf_streaming_decoder.h"
+#include "base/native_rate_data_block.h"
+#include "gui/background_processes.h"
+
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sigviewer
+{
+
+qint64 const XdfStreamingDecoder::UNIT_SIZE_IN_BYTES_ = 1 << 20;
+QString const XdfStreamingDecoder::PROCESS_NAME_ ("Decoding XDF...");
+
+//-----------------------------------------------------------------------------
+XdfStreamingDecoder::XdfStreamingDecoder (QSharedPointer<XdfChunkReader const> chunk_reader,
+                                          std::vector<Layout> const& layouts, size_t number_samples,
+                                          float64 sample_rate, double first_time_stamp)
+    : chunk_reader_ (chunk_reader),
+      layouts_ (layouts),
+      number_samples_ (number_samples),
+      sample_rate_ (sample_rate),
+      first_time_stamp_ (first_time_stamp),
+      number_decoded_units_ (0),
+      wanted_begin_ (0),
+      wanted_end_ (1),
+      cancelled_ (0)
+{
+    auto clamp = [number_samples] (long long position)
+    {
+        return static_cast<size_t> (std::clamp<long long> (position, 0, number_samples));
+    };
+
+    for (size_t layout_index = 0; layout_index < layouts_.size (); layout_index++)
+    {
+        Layout const& layout = layouts_[layout_index];
+        XdfChunkReader::Stream const& stream = chunk_reader_->getStreams ()[layout.stream];
+        channel_layouts_.resize (layout.first_channel + stream.channel_count, layout_index);
+        if (stream.chunks.empty ())
+            continue;
+
+        if (layout.placement != Layout::REGULAR)
+        {
+            size_t begin = layout.placement == Layout::NATIVE_RATE ? clamp (std::floor (layout.offset)) : 0;
+            units_.push_back ({layout_index, 0, stream.chunks.size (), begin, number_samples_, false, false});
+            continue;
+        }
+
+        size_t first_chunk = 0;
+        qint64 unit_size = 0;
+        for (size_t chunk = 0; chunk < stream.chunks.size (); chunk++)
+        {
+            unit_size += stream.chunks[chunk].end - stream.chunks[chunk].position;
+            if (unit_size < UNIT_SIZE_IN_BYTES_ && chunk + 1 < stream.chunks.size ())
+                continue;
+
+            long long begin = layout.starting_position + static_cast<long long> (stream.chunks[first_chunk].first_sample);
+            long long end = layout.starting_position + static_cast<long long> (stream.chunks[chunk].first_sample +
+                                                                             stream.chunks[chunk].number_samples);
+            units_.push_back ({layout_index, first_chunk, chunk + 1, clamp (begin), clamp (end), false, false});
+            first_chunk = chunk + 1;
+            unit_size = 0;
+        }
+    }
+
+    // without a requested range, the units are decoded from the begin of
+    // the file to its end
+    std::stable_sort (units_.begin (), units_.end (), [] (Unit const& unit, Unit const& other)
+    {
+        return unit.begin < other.begin;
+    });
+
+    extents_.resize (channel_layouts_.size ());
+    blocks_.resize (channel_layouts_.size ());
+    if (!units_.empty ())
+        BackgroundProcesses::instance().addProcess (PROCESS_NAME_, units_.size ());
+}
+
+//-----------------------------------------------------------------------------
+XdfStreamingDecoder::~XdfStreamingDecoder ()
+{
+    cancelled_.storeRelaxed (1);
+    pool_.waitForDone ();
+    if (number_decoded_units_ < units_.size ())
+        BackgroundProcesses::instance().removeProcess (PROCESS_NAME_);
+}
+
+//-----------------------------------------------------------------------------
+void XdfStreamingDecoder::start ()
+{
+    // the channels have samples to be shown and scaled with right away
+    std::vector<bool> started_layouts (layouts_.size (), false);
+    for (size_t index = 0; index < units_.size (); index++)
+    {
+        size_t layout = units_[index].layout;
+        if (layouts_[layout].placement != Layout::REGULAR || started_layouts[layout])
+            continue;
+        started_layouts[layout] = true;
+        {
+            QMutexLocker lock (&mutex_);
+            units_[index].taken = true;
+        }
+        decodeUnit (index);
+    }
+
+    for (int worker = 0; worker < pool_.maxThreadCount (); worker++)
+        pool_.start ([this] () {decodeUnits ();});
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> XdfStreamingDecoder::getChannel (ChannelID id, size_t start,
+                                                                 size_t length, bool wait) const
+{
+    if (id < 0 || static_cast<size_t> (id) >= blocks_.size ())
+        return QSharedPointer<DataBlock const> ();
+
+    QMutexLocker lock (&mutex_);
+
+    // requests of whole channels do not tell what is shown
+    if (length < number_samples_)
+    {
+        wanted_begin_ = start;
+        wanted_end_ = start + length;
+    }
+    while (wait && !isDecoded (channel_layouts_[id], start, start + length))
+        unit_decoded_.wait (&mutex_);
+
+    if (blocks_[id].isNull ())
+        blocks_[id] = QSharedPointer<DataBlock const> (new SparseDataBlock (extents_[id], number_samples_,
+                                                                            sample_rate_));
+    return blocks_[id];
+}
+
+//-----------------------------------------------------------------------------
+bool XdfStreamingDecoder::waitUntilDecoded (int timeout_in_ms) const
+{
+    QMutexLocker lock (&mutex_);
+    QDeadlineTimer deadline (timeout_in_ms);
+    while (number_decoded_units_ < units_.size ())
+        if (!unit_decoded_.wait (&mutex_, deadline))
+            break;
+    return number_decoded_units_ == units_.size ();
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<DataBlock const> XdfStreamingDecoder::createIrregularChannel (std::vector<float32> const& row,
+                                                                             std::vector<double> const& time_stamps,
+                                                                             double first_time_stamp,
+                                                                             float64 sample_rate,
+                                                                             size_t number_samples)
+{
+    long long end = number_samples;
+    size_t number_values = std::min (row.size (), time_stamps.size ());
+    std::vector<long long> positions (number_values);
+    std::vector<long long> intervals (number_values, 0);
+    long long covered_begin = end;
+    long long covered_end = 0;
+    for (size_t i = 0; i < number_values; i++)
+    {
+        positions[i] = std::llround ((time_stamps[i] - first_time_stamp) * sample_rate);
+        if (i + 1 < number_values)
+            intervals[i] = std::llround ((time_stamps[i + 1] - time_stamps[i]) * sample_rate);
+        if (positions[i] < 0 || positions[i] >= end)
+            continue;
+        covered_begin = std::min (covered_begin, positions[i]);
+        covered_end = std::max (covered_end, positions[i] + 1 + std::max (0LL, std::min (intervals[i], end - 1 - positions[i])));
+    }
+
+    std::vector<SparseExtent> extents;
+    if (covered_begin < covered_end)
+    {
+        extents.push_back ({static_cast<size_t> (covered_begin),
+                            std::vector<float32> (covered_end - covered_begin, NAN)});
+        float32* data = extents.back ().samples.data ();
+        for (size_t i = 0; i < number_values; i++)
+        {
+            if (positions[i] < 0 || positions[i] >= end)
+                continue;
+            long long position = positions[i] - covered_begin;
+            data[position] = row[i];
+
+            int count = std::max (0LL, std::min (intervals[i], end - 1 - positions[i]));
+            float32 value = row[i];
+            float32 step = (i + 1 < number_values) ? (row[i + 1] - row[i]) / (intervals[i] + 1) : 0;
+            float32* interpolated = data + position + 1;
+            for (int interpolation = 0; interpolation < count; interpolation++)
+                interpolated[interpolation] = value + (interpolation + 1) * step;
+        }
+    }
+    return QSharedPointer<DataBlock const> (new SparseDataBlock (std::move (extents), number_samples,
+                                                                 sample_rate));
+}
+
+//-----------------------------------------------------------------------------
+void XdfStreamingDecoder::decodeUnits ()
+{
+    size_t unit_index = 0;
+    while (!cancelled_.loadRelaxed () && takeUnit (unit_index))
+        decodeUnit (unit_index);
+}
+
+//-----------------------------------------------------------------------------
+bool XdfStreamingDecoder::takeUnit (size_t& unit_index)
+{
+    QMutexLocker lock (&mutex_);
+
+    // the first unit within the requested range or else the first one left
+    size_t taken = units_.size ();
+    for (size_t index = 0; index < units_.size (); index++)
+    {
+        Unit const& unit = units_[index];
+        if (unit.taken)
+            continue;
+        if (unit.begin < wanted_end_ && unit.end > wanted_begin_)
+        {
+            taken = index;
+            break;
+        }
+        if (taken == units_.size ())
+            taken = index;
+    }
+    if (taken == units_.size ())
+        return false;
+
+    units_[taken].taken = true;
+    unit_index = taken;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void XdfStreamingDecoder::decodeUnit (size_t unit_index)
+{
+    Unit const& unit = units_[unit_index];
+    Layout const& layout = layouts_[unit.layout];
+    XdfChunkReader::Stream const& stream = chunk_reader_->getStreams ()[layout.stream];
+    XdfChunkReader::SamplesChunk const& last_chunk = stream.chunks[unit.end_chunk - 1];
+    size_t first_sample = stream.chunks[unit.first_chunk].first_sample;
+    size_t number_samples = last_chunk.first_sample + last_chunk.number_samples - first_sample;
+
+    // the samples of broken chunks stay NAN
+    std::vector<std::vector<float32> > rows (stream.channel_count, std::vector<float32> (number_samples, NAN));
+    std::vector<double> time_stamps (layout.placement == Layout::IRREGULAR ? number_samples : 0, NAN);
+    std::vector<float32*> destinations (stream.channel_count);
+    for (size_t chunk = unit.first_chunk; chunk < unit.end_chunk && !cancelled_.loadRelaxed (); chunk++)
+    {
+        size_t offset = stream.chunks[chunk].first_sample - first_sample;
+        for (int channel = 0; channel < stream.channel_count; channel++)
+            destinations[channel] = rows[channel].data () + offset;
+        chunk_reader_->decodeSamples (layout.stream, chunk, destinations.data (),
+                                      time_stamps.empty () ? 0 : time_stamps.data () + offset);
+    }
+    for (double& time_stamp : time_stamps)
+        time_stamp = chunk_reader_->synchronise (layout.stream, time_stamp);
+
+    std::vector<QSharedPointer<SparseExtent const> > extents (stream.channel_count);
+    std::vector<QSharedPointer<DataBlock const> > blocks (stream.channel_count);
+    long long begin = layout.starting_position + static_cast<long long> (first_sample);
+    for (int channel = 0; channel < stream.channel_count; channel++)
+    {
+        std::vector<float32>& row = rows[channel];
+        if (layout.placement == Layout::NATIVE_RATE)
+            blocks[channel] = QSharedPointer<DataBlock const> (new NativeRateDataBlock (
+                    std::move (row), stream.nominal_srate, layout.offset, number_samples_, sample_rate_));
+        else if (layout.placement == Layout::IRREGULAR)
+            blocks[channel] = createIrregularChannel (row, time_stamps, first_time_stamp_,
+                                                      sample_rate_, number_samples_);
+        else
+        {
+            // samples outside of the file are dropped
+            long long skipped = std::clamp<long long> (-begin, 0, row.size ());
+            long long start = begin + skipped;
+            if (start < 0 || start >= static_cast<long long> (number_samples_))
+                continue;
+            row.erase (row.begin (), row.begin () + skipped);
+            row.resize (std::min<size_t> (row.size (), number_samples_ - start));
+            if (!row.empty ())
+                extents[channel] = QSharedPointer<SparseExtent const> (
+                        new SparseExtent {static_cast<size_t> (start), std::move (row)});
+        }
+    }
+
+    QMutexLocker lock (&mutex_);
+    for (int channel = 0; channel < stream.channel_count; channel++)
+    {
+        ChannelID id = layout.first_channel + channel;
+        if (!blocks[channel].isNull ())
+            blocks_[id] = blocks[channel];
+        else if (!extents[channel].isNull ())
+        {
+            std::vector<QSharedPointer<SparseExtent const> >& channel_extents = extents_[id];
+            channel_extents.insert (std::upper_bound (channel_extents.begin (), channel_extents.end (),
+                                                      extents[channel]->start,
+                                                      [] (size_t start, QSharedPointer<SparseExtent const> const& extent)
+            {
+                return start < extent->start;
+            }), extents[channel]);
+            blocks_[id].clear ();
+        }
+    }
+    units_[unit_index].decoded = true;
+    size_t number_decoded_units = ++number_decoded_units_;
+    unit_decoded_.wakeAll ();
+    lock.unlock ();
+
+    BackgroundProcesses::instance().setProcessState (PROCESS_NAME_, number_decoded_units);
+    if (number_decoded_units == units_.size ())
+        BackgroundProcesses::instance().removeProcess (PROCESS_NAME_);
+}
+
+//-----------------------------------------------------------------------------
+bool XdfStreamingDecoder::isDecoded (size_t layout, size_t begin, size_t end) const
+{
+    for (Unit const& unit : units_)
+        if (unit.layout == layout && !unit.decoded && unit.begin < end && unit.end > begin)
+            return false;
+    return true;
+}
+
+}
@@ -0,0 +1,148 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef XDF_STREAMING_DECODER_H
+#define XDF_STREAMING_DECODER_H
+
+#include "xdf_chunk_reader.h"
+#include "base/data_block.h"
+#include "base/sparse_data_block.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// XdfStreamingDecoder
+///
+/// decodes the numeric streams of an XDF file in the background, so the file
+/// can be shown before its samples are decoded; regular streams are decoded
+/// in units of some chunks, preferring the units within the range requested
+/// last (i.e. the range on screen), and every decoded unit is published as
+/// an extent of its channels at once; streams which are not at the rate of
+/// the file are published as a whole once they are decoded
+class XdfStreamingDecoder
+{
+public:
+    //-------------------------------------------------------------------------
+    /// placement of a numeric stream onto the samples of the file
+    struct Layout
+    {
+        enum Placement
+        {
+            REGULAR,        // at the rate of the file
+            NATIVE_RATE,    // at another rate, see NativeRateDataBlock
+            IRREGULAR       // at the time stamps of the samples
+        };
+
+        size_t stream;                  // index in the XdfChunkReader
+        ChannelID first_channel;
+        Placement placement;
+        long long starting_position;    // of the first sample of REGULAR streams
+        float64 offset;                 // of NATIVE_RATE streams
+    };
+
+    //-------------------------------------------------------------------------
+    /// @param layouts of all numeric streams, ordered by their channels
+    /// @param first_time_stamp synchronised time of the first sample of the
+    ///                         file, the origin of irregular streams
+    XdfStreamingDecoder (QSharedPointer<XdfChunkReader const> chunk_reader,
+                         std::vector<Layout> const& layouts, size_t number_samples,
+                         float64 sample_rate, double first_time_stamp);
+
+    //-------------------------------------------------------------------------
+    /// stops decoding and waits for the units being decoded
+    ~XdfStreamingDecoder ();
+
+    //-------------------------------------------------------------------------
+    /// decodes the begin of every regular stream on the calling thread and
+    /// starts decoding everything else in the background
+    void start ();
+
+    //-------------------------------------------------------------------------
+    /// the given range is decoded before all others
+    ///
+    /// @param wait if false, samples which are not decoded yet are NAN
+    /// @return the whole channel
+    QSharedPointer<DataBlock const> getChannel (ChannelID id, size_t start, size_t length,
+                                                bool wait) const;
+
+    //-------------------------------------------------------------------------
+    /// @param timeout_in_ms -1 to wait without a timeout
+    /// @return true if all samples are decoded
+    bool waitUntilDecoded (int timeout_in_ms) const;
+
+    //-------------------------------------------------------------------------
+    /// a channel of an irregular stream; the samples are placed at their time
+    /// stamps and the space up to the next sample is linearly interpolated,
+    /// so only the time from the first to the last sample is stored
+    static QSharedPointer<DataBlock const> createIrregularChannel (std::vector<float32> const& row,
+                                                                   std::vector<double> const& time_stamps,
+                                                                   double first_time_stamp,
+                                                                   float64 sample_rate,
+                                                                   size_t number_samples);
+
+private:
+    Q_DISABLE_COPY (XdfStreamingDecoder);
+
+    //-------------------------------------------------------------------------
+    struct Unit
+    {
+        size_t layout;
+        size_t first_chunk;
+        size_t end_chunk;
+        size_t begin;       // samples of the file covered by the unit
+        size_t end;
+        bool taken;
+        bool decoded;
+    };
+
+    //-------------------------------------------------------------------------
+    /// decodes units until there are none left; run by the thread pool
+    void decodeUnits ();
+
+    //-------------------------------------------------------------------------
+    /// @return false if all units are taken
+    bool takeUnit (size_t& unit_index);
+
+    //-------------------------------------------------------------------------
+    void decodeUnit (size_t unit_index);
+
+    //-------------------------------------------------------------------------
+    /// the mutex has to be locked
+    bool isDecoded (size_t layout, size_t begin, size_t end) const;
+
+    static qint64 const UNIT_SIZE_IN_BYTES_;
+    static QString const PROCESS_NAME_;
+
+    QSharedPointer<XdfChunkReader const> chunk_reader_;
+    std::vector<Layout> layouts_;
+    std::vector<size_t> channel_layouts_;
+    size_t number_samples_;
+    float64 sample_rate_;
+    double first_time_stamp_;
+    std::vector<Unit> units_;
+    size_t number_decoded_units_;
+
+    mutable QMutex mutex_;
+    mutable QWaitCondition unit_decoded_;
+    mutable size_t wanted_begin_;
+    mutable size_t wanted_end_;
+    std::vector<std::vector<QSharedPointer<SparseExtent const> > > extents_;
+    mutable std::vector<QSharedPointer<DataBlock const> > blocks_;  // null if outdated
+    QAtomicInt cancelled_;
+    QThreadPool pool_;
+};
+
+}
+
+#endif // XDF_STREAMING_DECODER_H
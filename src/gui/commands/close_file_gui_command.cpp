@@ -4,7 +4,6 @@
 
 
 #include "close_file_gui_command.h"
-#include "file_handling/xdf_reader.h"
 #include "gui/main_window_model.h"
 
 #include <QApplication>
@@ -96,12 +95,6 @@ bool CloseFileGuiCommand::closeCurrentFile ()
             return false;
     }
 
-    if (current_file_context->getFileName().endsWith("xdf", Qt::CaseInsensitive))
-    {
-        Xdf empty;
-        std::swap(*XDFdata, empty);//clear the data of the previous XDF file
-    }
-
     applicationContext()->getMainWindowModel ()->closeCurrentFileTabs ();
     applicationContext()->removeCurrentFileContext ();
     return true;
@@ -266,7 +266,7 @@ void EventEditingGuiCommand::evaluateEnabledness ()
 //-------------------------------------------------------------------------
 void EventEditingGuiCommand::executeCommands (QList<QSharedPointer<QUndoCommand> > commands)
 {
-    MacroUndoCommand* macro = new MacroUndoCommand (commands);
+    MacroUndoCommand* macro = new MacroUndoCommand (commands, currentEventView()->getEventManager());
     applicationContext()->getCurrentCommandExecuter()->executeCommand (macro);
 }
 
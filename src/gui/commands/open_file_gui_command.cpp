@@ -3,8 +3,6 @@
 // License: GPL-3.0
 
 
-#include <biosig.h>
-#undef isfinite
 #include "open_file_gui_command.h"
 #include "gui/gui_helper_functions.h"
 
@@ -12,12 +10,13 @@
 #include "gui/signal_visualisation_model.h"
 #include "file_handling/file_signal_reader_factory.h"
 #include "file_handling/event_manager.h"
+#include "file_handling/event_importer.h"
 #include "file_handling/file_channel_manager.h"
+#include "file_handling/down_sampling_thread.h"
 #include "tab_context.h"
 #include "file_context.h"
 #include "gui/main_window_model.h"
-#include "editing_commands/macro_undo_command.h"
-#include "editing_commands/new_event_undo_command.h"
+#include "editing_commands/import_events_undo_command.h"
 #include "gui/progress_bar.h"
 #include "gui/color_manager.h"
 #include "close_file_gui_command.h"
@@ -216,7 +215,7 @@ void OpenFileGuiCommand::open ()
 //-------------------------------------------------------------------------
 void OpenFileGuiCommand::importEvents ()
 {
-    QString extensions = "*.csv *.evt";
+    QString extensions = "*.csv *.tsv *.txt *.evt";
     QSettings settings;
     QString open_path = settings.value ("file_open_path").toString();
     if (!open_path.length())
@@ -226,64 +225,46 @@ void OpenFileGuiCommand::importEvents ()
     if (file_path.isEmpty())
         return;
 
-    QList<QSharedPointer<SignalEvent const> > events;
     QSharedPointer<EventManager> event_manager = applicationContext()->getCurrentFileContext()->getEventManager();
-    double sampleRate = event_manager->getSampleRate();
     std::set<EventType> types = event_manager->getEventTypes();
     int numberChannels = applicationContext()->getCurrentFileContext()->getChannelManager().getNumberChannels();
 
-    // try reading event file through biosig
-    HDRTYPE* evtHDR = sopen(file_path.toStdString().c_str(), "r", NULL );
-    if (!serror2(evtHDR)) {
-        /* Note: evtSampleRate and transition rate can be NaN,
-           indicating sample rate is not specified in event file
-         */
-	double evtSampleRate   = biosig_get_eventtable_samplerate(evtHDR);
-	double transition_rate = sampleRate / evtSampleRate;
-	size_t NumEvents       = biosig_get_number_of_events(evtHDR);
-	for (size_t k = 0; k < NumEvents; k++) {
-            uint16_t typ; uint32_t pos; uint16_t chn; uint32_t dur;
-            gdf_time timestamp;
-            const char *desc;
-            biosig_get_nth_event(evtHDR, k, &typ, &pos, &chn, &dur, &timestamp, &desc);
-
-            if (transition_rate > 0) {
-                pos = lround(pos*transition_rate);
-                dur = lround(dur*transition_rate);
-            }
-
-            /* biosig uses a 1-based channel index, and 0 refers to all channels,
-               sigviewer uses a 0-based indexing, and -1 indicates all channels */
-            //boundary check & error handling
-            if (pos > event_manager->getMaxEventPosition()
-                    || pos + dur > event_manager->getMaxEventPosition()
-                    || chn > numberChannels
-                    || !types.count(typ))
-                continue;
-
-            QSharedPointer<SignalEvent> event = QSharedPointer<SignalEvent>(new SignalEvent(pos,
-                    typ, sampleRate, -1, chn-1, dur));
-
-            events << event;
-        }
-        sclose(evtHDR);
-        destructHDR(evtHDR);
-    } else
+    EventColumns read_events;
+    size_t skipped_lines = 0;
+    QString error = EventImporter::readEvents (file_path, event_manager->getSampleRate(), read_events,
+                                               skipped_lines);
+    if (error.size())
     {
-        // if the file can not be read with biosig, try this approach
-        destructHDR(evtHDR);
-        QMessageBox::critical(0, file_path, tr("Cannot open file.\nIs the target file open in another application?"));
+        QMessageBox::critical(0, file_path, error);
         return;
     }
-
-    QList<QSharedPointer<QUndoCommand> > creation_commands;
-    foreach (QSharedPointer<SignalEvent const> event, events)
+    if (skipped_lines > 0)
+        QMessageBox::warning(0, file_path, tr("%n line(s) could not be read as events and have been skipped.",
+                                              "", static_cast<int>(skipped_lines)));
+
+    //boundary check & error handling
+    size_t max_position = event_manager->getMaxEventPosition();
+    EventColumns events;
+    events.reserve (read_events.size());
+    for (size_t index = 0; index < read_events.size(); index++)
     {
-            QSharedPointer<QUndoCommand> creation_command (new NewEventUndoCommand (event_manager, event));
-            creation_commands.append (creation_command);
+        size_t position = read_events.positions[index];
+        size_t duration = read_events.durations[index];
+        ChannelID channel = read_events.channels[index];
+        if (position > max_position
+                || position + duration > max_position
+                || channel >= numberChannels
+                || channel < UNDEFINED_CHANNEL
+                || !types.count(read_events.types[index]))
+            continue;
+
+        events.append (read_events.positions[index], read_events.durations[index],
+                       read_events.types[index], channel);
     }
-    MacroUndoCommand* macro_command = new MacroUndoCommand (creation_commands);
-    applicationContext()->getCurrentCommandExecuter()->executeCommand (macro_command);
+
+    if (events.size() == 0)
+        return;
+    applicationContext()->getCurrentCommandExecuter()->executeCommand (new ImportEventsUndoCommand (event_manager, events));
 }
 
 //-------------------------------------------------------------------------
@@ -306,7 +287,7 @@ void OpenFileGuiCommand::openFileImpl (QString file_path, bool instantly)
 
     QString file_name = file_path.section (QDir::separator(), -1);
 
-    ChannelManager* channel_manager (new FileChannelManager (file_signal_reader));
+    FileChannelManager* channel_manager (new FileChannelManager (file_signal_reader));
 
     std::set<ChannelID> shown_channels;
     if (instantly)
@@ -338,6 +319,11 @@ void OpenFileGuiCommand::openFileImpl (QString file_path, bool instantly)
     signal_visualisation_model->update();
     applicationContext()->addFileContext (file_context);
     ProgressBar::instance().close();
+
+    DownSamplingThread* downsampling_thread = channel_manager->getDownsamplingThread ();
+    signal_visualisation_model->connect (downsampling_thread, SIGNAL(decodedDataAvailable()), SLOT(updateSignals()));
+    signal_visualisation_model->connect (downsampling_thread, SIGNAL(downsampledDataAvailable()), SLOT(update()));
+    downsampling_thread->start (QThread::LowPriority);
 }
 
 
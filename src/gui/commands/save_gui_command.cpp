@@ -6,9 +6,9 @@
 #include "save_gui_command.h"
 #include "gui/gui_helper_functions.h"
 #include "file_handling/file_signal_writer_factory.h"
+#include "file_handling/csv_event_writer.h"
 #include "open_file_gui_command.h"
 #include "file_handling/xdf_reader.h"
-#include "fstream"
 
 #include <QMessageBox>
 #include <QFileDialog>
@@ -18,7 +18,6 @@
 #include <QPointer>
 
 #include <algorithm>
-#include <fstream>
 
 namespace sigviewer
 {
@@ -161,7 +160,9 @@ void SaveGuiCommand::saveAs ()
         //add save events to XDF support
         if (new_file_path.endsWith("xdf", Qt::CaseInsensitive))
         {
-            XDFdata->writeEventsToXDF(new_file_path.toStdString());
+            QSharedPointer<Xdf> xdf = file_context->getEventManager()->getXdf();
+            if (!xdf.isNull())
+                xdf->writeEventsToXDF(new_file_path.toStdString());
             applicationContext()->getCurrentFileContext()->setState(FILE_STATE_UNCHANGED);
         }
         else
@@ -202,7 +203,9 @@ void SaveGuiCommand::save ()
     //add save events to XDF support
     if (file_path.endsWith("xdf", Qt::CaseInsensitive))
     {
-        XDFdata->writeEventsToXDF(file_path.toStdString());
+        QSharedPointer<Xdf> xdf = applicationContext()->getCurrentFileContext()->getEventManager()->getXdf();
+        if (!xdf.isNull())
+            xdf->writeEventsToXDF(file_path.toStdString());
         applicationContext()->getCurrentFileContext()->setState(FILE_STATE_UNCHANGED);
     }
     else //Original Sigviewer code (not XDF)
@@ -329,62 +332,13 @@ void SaveGuiCommand::exportEventsToCSV ()
     if (new_file_path.size() == 0)
         return;
 
-    std::ofstream file;
-    file.open(new_file_path.toStdString());
+    QSharedPointer<EventManager> event_manager_pt = applicationContext()
+            ->getCurrentFileContext()->getEventManager();
 
-    if (file.is_open())
-    {
-        file << "position,duration,channel,type,name\n";
-
-        QSharedPointer<EventManager> event_manager_pt = applicationContext()
-                ->getCurrentFileContext()->getEventManager();
-
-        struct row {
-            size_t pos;
-            size_t dur;
-            int chan;
-            int id;
-            QString name;
-        };
-
-        QVector<row> events;
-
-        for (unsigned int i = 0; i < event_manager_pt->getNumberOfEvents(); i++)
-        {
-            auto evt = event_manager_pt->getEvent(i);
-            if (evt != NULL) {
-                row tmp = {
-                    evt->getPosition(),
-                    evt->getDuration(),
-                    evt->getChannel(),
-                    evt->getType(),
-                    event_manager_pt->getNameOfEvent(i)
-                };
-                events.append(tmp);
-            }
-        }
-
-        std::sort(events.begin(),
-                  events.end(),
-                  [](const row& a, const row& b) {
-                      return a.pos < b.pos;
-                  }
-        );
-
-        for (int i = 0; i < events.size(); ++i)
-        {
-            file << events[i].pos << "," <<
-                    events[i].dur << "," <<
-                    events[i].chan << "," <<
-                    events[i].id << "," <<
-                    events[i].name.remove(",").toStdString() << "\n";
-        }
-        file.close();
-    }
-    else
-    {
-        QMessageBox::critical (0, current_file_path, tr("Exporting events to CSV failed!\nIs the target file open in another application?"));
-    }
+    CSVEventWriter writer (new_file_path);
+    QString error = writer.saveEvents (event_manager_pt, event_manager_pt->getEventTypes ());
+    if (error.size ())
+        QMessageBox::critical (0, current_file_path, error);
 }
 
 //-------------------------------------------------------------------------
@@ -6,9 +6,8 @@
 #include "signal_processing_gui_command.h"
 #include "gui/gui_helper_functions.h"
 #include "gui/processed_signal_channel_manager.h"
-#include "gui/progress_bar.h"
 #include "gui/main_window_model.h"
-#include "base/fixed_data_block.h"
+#include "signal_processing/event_epochs.h"
 
 #include <QMessageBox>
 
@@ -82,7 +81,6 @@ void SignalProcessingGuiCommand::evaluateEnabledness ()
 void SignalProcessingGuiCommand::calculateMeanAndStandardDeviation ()
 {
     ChannelManager const& channel_manager = currentFileContext()->getChannelManager();
-    QSharedPointer<EventManager> event_manager = currentFileContext()->getEventManager();
     QSharedPointer<EventTimeSelectionDialog> event_dialog = getFinishedEventTimeSelectionDialog();
     if (event_dialog.isNull())
         return;
@@ -90,39 +88,31 @@ void SignalProcessingGuiCommand::calculateMeanAndStandardDeviation ()
     unsigned num_samples = channel_manager.getSampleRate() * event_dialog->getLengthInSeconds ();
     unsigned samples_before = channel_manager.getSampleRate() * event_dialog->getSecondsBeforeEvent ();
 
+    std::set<ChannelID> selected_channels = event_dialog->getSelectedChannels ();
+    std::vector<ChannelID> channels (selected_channels.begin (), selected_channels.end ());
+    EventEpochs epochs (channel_manager, channels,
+                        getEpochStarts (event_dialog->getSelectedEventType (), samples_before, num_samples),
+                        num_samples);
+    if (epochs.getNumberEpochs () == 0)
+    {
+        QMessageBox::warning (0, tr("Warning"), tr("There are no events with enough data around them!"));
+        return;
+    }
+    QVector<QSharedPointer<DataBlock> > means;
+    QVector<QSharedPointer<DataBlock> > standard_deviations;
+    epochs.calculateMeanAndStandardDeviation (means, standard_deviations);
+
     ProcessedSignalChannelManager* processed_channel_manager (new ProcessedSignalChannelManager(channel_manager.getSampleRate(),
                                                                                                                num_samples, currentFileContext().data()));
     processed_channel_manager->setXAxisUnitLabel(channel_manager.getXAxisUnitLabel());
     ChannelID new_channel_id = 0;
-    QList<EventID> events (event_manager->getEvents(event_dialog->getSelectedEventType ()));
-    for (const auto channel_id : event_dialog->getSelectedChannels ())
+    for (size_t index = 0; index < channels.size (); index++)
     {
-        std::list<QSharedPointer<DataBlock const> > data;
-
-        foreach (EventID event_id, events)
-        {
-            QSharedPointer<SignalEvent const> event = event_manager->getEvent (event_id);
-
-            if (event->getPosition () < samples_before)
-            {
-                QMessageBox::warning (0, tr("Warning"), tr("Event at %1s will be ignored! (because no data can be added in front of this event)").arg(QString::number(event->getPositionInSec())));
-                continue;
-            }
-
-            QSharedPointer<DataBlock const> data_block = channel_manager.getData (channel_id,
-                                                                                   event->getPosition() - samples_before,
-                                                                                   num_samples);
-            if (!data_block.isNull())
-                data.push_back (data_block);
-        }
-
-        QSharedPointer<DataBlock> mean = FixedDataBlock::calculateMean (data);
-        QSharedPointer<DataBlock> standard_deviation = FixedDataBlock::calculateStandardDeviation (data, mean);
-
-        processed_channel_manager->addExtraChannel (new_channel_id, standard_deviation, tr("Standard Deviation\n") + channel_manager.getChannelLabel(channel_id),
+        ChannelID channel_id = channels[index];
+        processed_channel_manager->addExtraChannel (new_channel_id, standard_deviations[index], tr("Standard Deviation\n") + channel_manager.getChannelLabel(channel_id),
                                                     channel_manager.getChannelYUnitString(channel_id));
         new_channel_id++;
-        processed_channel_manager->addChannel (new_channel_id, mean, channel_manager.getChannelLabel(channel_id), channel_manager.getChannelYUnitString(channel_id));
+        processed_channel_manager->addChannel (new_channel_id, means[index], channel_manager.getChannelLabel(channel_id), channel_manager.getChannelYUnitString(channel_id));
         new_channel_id++;
         //applicationContext()->getEventColorManager()->setChannelColor(stddev_id,
         //                                                              applicationContext()->getEventColorManager()->getChannelColor(channel_id));
@@ -136,7 +126,6 @@ void SignalProcessingGuiCommand::calculateMeanAndStandardDeviation ()
 void SignalProcessingGuiCommand::calculatePowerSpectrum ()
 {
     ChannelManager const& channel_manager = currentFileContext()->getChannelManager();
-    QSharedPointer<EventManager> event_manager = currentFileContext()->getEventManager();
     QSharedPointer<EventTimeSelectionDialog> event_dialog = getFinishedEventTimeSelectionDialog();
     if (event_dialog.isNull())
         return;
@@ -148,46 +137,69 @@ void SignalProcessingGuiCommand::calculatePowerSpectrum ()
     while (fft_samples < num_samples)
         fft_samples *= 2;
 
+    std::set<ChannelID> selected_channels = event_dialog->getSelectedChannels ();
+    std::vector<ChannelID> channels (selected_channels.begin (), selected_channels.end ());
+    EventEpochs epochs (channel_manager, channels,
+                        getEpochStarts (event_dialog->getSelectedEventType (), samples_before, num_samples),
+                        num_samples);
+    if (epochs.getNumberEpochs () == 0)
+    {
+        QMessageBox::warning (0, tr("Warning"), tr("There are no events with enough data around them!"));
+        return;
+    }
+    QVector<QSharedPointer<DataBlock> > spectra = epochs.calculateMeanPowerSpectra ();
+
     ProcessedSignalChannelManager* processed_channel_manager (new ProcessedSignalChannelManager(static_cast<float32>(fft_samples) / channel_manager.getSampleRate(),
                                                                                                                fft_samples / 2, currentFileContext().data()));
     processed_channel_manager->setXAxisUnitLabel ("Hz");
-    QList<EventID> events (event_manager->getEvents(event_dialog->getSelectedEventType ()));
-
-    ProgressBar::instance().initAndShow (event_dialog->getSelectedChannels ().size(), tr("Fourier Transformation"),
-                                         applicationContext());
-    for (const auto channel_id : event_dialog->getSelectedChannels ())
+    for (size_t index = 0; index < channels.size (); index++)
     {
-        ProgressBar::instance().increaseValue (1, channel_manager.getChannelLabel(channel_id));
-        std::list<QSharedPointer<DataBlock const> > data;
-
-        foreach (EventID event_id, events)
-        {
-            QSharedPointer<SignalEvent const> event = event_manager->getEvent (event_id);
-            if (event->getPosition () < samples_before)
-            {
-                QMessageBox::warning (0, tr("Warning"), QString("Event at %1s will be ignored! (because no data can be added in front of this event)").arg(QString::number(event->getPositionInSec())));
-                continue;
-            }
-            QSharedPointer<DataBlock const> data_block = channel_manager.getData (channel_id,
-                                                                                   event->getPosition() - samples_before,
-                                                                                   num_samples);
-            if (!data_block.isNull())
-                data.push_back (FixedDataBlock::createPowerSpectrum(data_block));
-        }
-
-        QSharedPointer<DataBlock> mean = FixedDataBlock::calculateMean (data);
+        ChannelID channel_id = channels[index];
         QString unit = QString("log(").append(channel_manager.getChannelYUnitString (channel_id))
                                      .append(QChar(0xb2))
                                      .append("/Hz)");
-        processed_channel_manager->addChannel (channel_id, mean, channel_manager.getChannelLabel(channel_id),
+        processed_channel_manager->addChannel (channel_id, spectra[index], channel_manager.getChannelLabel(channel_id),
                                                unit);
     }
-    ProgressBar::instance().close();
 
     createVisualisation (tr("Power Spectrum"), *processed_channel_manager);
 
 }
 
+//-------------------------------------------------------------------------
+std::vector<size_t> SignalProcessingGuiCommand::getEpochStarts (EventType type, unsigned samples_before,
+                                                                unsigned num_samples)
+{
+    ChannelManager const& channel_manager = currentFileContext()->getChannelManager();
+    QSharedPointer<EventManager> event_manager = currentFileContext()->getEventManager();
+    QList<EventID> events (event_manager->getEvents (type));
+
+    std::vector<size_t> positions;
+    positions.reserve (events.size ());
+    event_manager->readEvents ([&] (EventStore const& store)
+    {
+        for (EventID event_id : events)
+            if (store.contains (event_id))
+                positions.push_back (store.getPosition (event_id));
+    });
+
+    std::vector<size_t> starts;
+    starts.reserve (positions.size ());
+    for (size_t position : positions)
+    {
+        if (position < samples_before)
+        {
+            QMessageBox::warning (0, tr("Warning"), tr("Event at %1s will be ignored! (because no data can be added in front of this event)").arg(QString::number(position / event_manager->getSampleRate())));
+            continue;
+        }
+        // there is no data for epochs reaching beyond the end of the signal
+        if (position - samples_before + num_samples > channel_manager.getNumberSamples ())
+            continue;
+        starts.push_back (position - samples_before);
+    }
+    return starts;
+}
+
 //-------------------------------------------------------------------------
 QSharedPointer<EventTimeSelectionDialog> SignalProcessingGuiCommand::getFinishedEventTimeSelectionDialog ()
 {
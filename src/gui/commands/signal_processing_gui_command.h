@@ -10,6 +10,8 @@
 #include "gui/gui_action_factory_registrator.h"
 #include "gui/dialogs/event_time_selection_dialog.h"
 
+#include <vector>
+
 namespace sigviewer
 {
 
@@ -39,6 +41,12 @@ private:
     //-------------------------------------------------------------------------
     QSharedPointer<EventTimeSelectionDialog> getFinishedEventTimeSelectionDialog ();
 
+    //-------------------------------------------------------------------------
+    /// @return the first samples of the epochs around the events of the given
+    ///         type, without the events lacking data in front or after them
+    std::vector<size_t> getEpochStarts (EventType type, unsigned samples_before,
+                                        unsigned num_samples);
+
     //-------------------------------------------------------------------------
     void createVisualisation (QString const& title, ChannelManager const& channel_manager);
 
@@ -82,7 +82,7 @@ void BasicHeaderInfoDialog::showStreamName(QTreeWidgetItem *item)
         int streamNumber = str.toInt() - 1; //-1 to switch back to 0-based indexing
 
 //        int streamNumber = item->text(0).remove("Stream ").toInt() - 1;//-1 to switch back to 0 index
-        item->setText(1, QString::fromStdString(XDFdata->streams[streamNumber].info.name));
+        item->setText(1, QString::fromStdString(basic_header_->getXdf()->streams[streamNumber].info.name));
     }
 }
 
@@ -186,18 +186,19 @@ void BasicHeaderInfoDialog::buildTree()
     //exclusively for XDF
     if (basic_header_->getFileTypeString().startsWith("XDF", Qt::CaseInsensitive))
     {
-        for (size_t i = 0; i < XDFdata->streams.size(); i++)
+        QSharedPointer<Xdf> xdf = basic_header_->getXdf();
+        for (size_t i = 0; i < xdf->streams.size(); i++)
         {
             // basic
             root_item = new QTreeWidgetItem(info_tree_widget_);
 //            root_item->setText(0, "Stream "+QString::number(i + 1));//+1 for user's convenience (1 based instead 0 based)
             root_item->setText(0, tr("Stream %1 (%2)").arg(QString::number(i+1)).        //+1 for 1-based indexing
-                                   arg(QString::fromStdString(XDFdata->streams[i].info.name)));
+                                   arg(QString::fromStdString(xdf->streams[i].info.name)));
 
 //            root_item->setIcon(0, QIcon(":/images/ic_flag_black_24dp.png"));
 
             QDomDocument streamHeader;
-            streamHeader.setContent(QString::fromStdString(XDFdata->streams[i].streamHeader));
+            streamHeader.setContent(QString::fromStdString(xdf->streams[i].streamHeader));
             QDomElement rootElement = streamHeader.firstChildElement();
 
             for (QDomNode n = rootElement.firstChild(); !n.isNull();)
@@ -224,7 +225,7 @@ void BasicHeaderInfoDialog::buildTree()
             }
 
             QDomDocument streamFooter;
-            streamFooter.setContent(QString::fromStdString(XDFdata->streams[i].streamFooter));
+            streamFooter.setContent(QString::fromStdString(xdf->streams[i].streamFooter));
             rootElement = streamFooter.firstChildElement();
             for (QDomNode n = rootElement.firstChild(); !n.isNull();)
             {
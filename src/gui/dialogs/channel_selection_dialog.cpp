@@ -37,20 +37,21 @@ ChannelSelectionDialog::ChannelSelectionDialog(ChannelManager const& channel_man
     ui_.treeWidget->header()->resizeSection(0, width() * 0.6);
     ui_.treeWidget->setAnimated(true);
 
-    if (ApplicationContext::getInstance()->getCurrentFileContext()->getFileName().endsWith("XDF", Qt::CaseInsensitive))
+    QSharedPointer<Xdf> xdf = header_->getXdf();
+    if (!xdf.isNull())
     {
         int channelCount = 0;
-        for (size_t i = 0; i < XDFdata->streams.size(); i++)
+        for (size_t i = 0; i < xdf->streams.size(); i++)
         {
             QTreeWidgetItem* streamItem = new QTreeWidgetItem(ui_.treeWidget);
-            streamItem->setText(0, tr("Stream %1 (%2)").arg(i+1).arg(QString::fromStdString(XDFdata->streams[i].info.name))); //+1 for user's convenience (1 based instead 0 based)
+            streamItem->setText(0, tr("Stream %1 (%2)").arg(i+1).arg(QString::fromStdString(xdf->streams[i].info.name))); //+1 for user's convenience (1 based instead 0 based)
             #if QT_VERSION >= 0x050600
                 streamItem->setFlags(Qt::ItemIsAutoTristate | Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
             #else
                 streamItem->setFlags(Qt::ItemIsTristate | Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
             #endif
             streamItem->setExpanded(true);
-            if (XDFdata->streams[i].info.channel_format.compare("string") == 0)
+            if (xdf->streams[i].info.channel_format.compare("string") == 0)
             {
                 streamItem->setForeground(0, NOT_VISIBLE_COLOR_);
                 //streamItem->setText(0, streamItem->text(0).append(tr(" -text events only")));
@@ -63,15 +64,15 @@ ChannelSelectionDialog::ChannelSelectionDialog(ChannelManager const& channel_man
                 if (ColorManager::isDark(streamColor))
                     streamItem->setForeground(1, Qt::white);
 
-                for (int j = 0; j < XDFdata->streams[i].info.channel_count; j++)
+                for (int j = 0; j < xdf->streams[i].info.channel_count; j++)
                 {
                     QTreeWidgetItem* channelItem = new QTreeWidgetItem(streamItem);
 
                     QString channelLabel;
 
-                    if (!XDFdata->streams[i].info.channels.empty())
+                    if (!xdf->streams[i].info.channels.empty())
                     {
-                        for (auto const &entry : XDFdata->streams[i].info.channels[j])
+                        for (auto const &entry : xdf->streams[i].info.channels[j])
                         {
                             if ((entry.first.compare("label")==0 || entry.first.compare("type")==0)
                                     && entry.second != "")
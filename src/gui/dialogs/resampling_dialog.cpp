@@ -5,7 +5,7 @@
 
 #include "resampling_dialog.h"
 #include "ui_resampling_dialog.h"
-#include "file_handling/xdf_reader.h"
+#include "xdf.h"
 
 namespace sigviewer {
 
@@ -16,22 +16,22 @@ ResamplingDialog::ResamplingDialog(QWidget *parent) :
     ui->setupUi(this);
 }
 
-ResamplingDialog::ResamplingDialog(int nativeSrate, int highestSampleRate, QWidget *parent) :
+ResamplingDialog::ResamplingDialog(Xdf const& xdf, int nativeSrate, int highestSampleRate, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::ResamplingDialog)
 {
     ui->setupUi(this);
     this->setWindowTitle(tr("Resampling"));
 
-    if (XDFdata->sampleRateMap.size() > 1)
+    if (xdf.sampleRateMap.size() > 1)
     {
         QString text = tr("This file contains signals of multiple sample rates.<br> "
-                                   "Sigviewer needs to resample all channels to a unified sample rate in order to display them.<br> "
-                                   "Please choose a sample rate below (This won't change the actual file content):");
+                                   "Every stream is kept at its own sample rate and mapped onto a unified time axis in order to display them.<br> "
+                                   "Please choose the sample rate of the time axis below (This won't change the actual file content):");
         ui->label->setText(text);
     }
-    else if (XDFdata->sampleRateMap.size() == 1 &&
-             XDFdata->sampleRateMap.count(0))
+    else if (xdf.sampleRateMap.size() == 1 &&
+             xdf.sampleRateMap.count(0))
     {
         ui->label->setText(tr("The nominal sample rate of this file is 0.\n"
                                        "Please choose a preferred sample rate:"));
@@ -47,7 +47,7 @@ ResamplingDialog::ResamplingDialog(int nativeSrate, int highestSampleRate, QWidg
     QStringList headers;
     headers << "Stream" << "Info";
     ui->treeWidget->setHeaderLabels(headers);
-    for (size_t i = 0; i < XDFdata->streams.size(); i++)
+    for (size_t i = 0; i < xdf.streams.size(); i++)
     {
         QTreeWidgetItem* streamItem = new QTreeWidgetItem(ui->treeWidget);
         streamItem->setText(0, tr("Stream %1").arg(i+1));//+1 for user's convenience (1 based instead 0 based)
@@ -55,25 +55,25 @@ ResamplingDialog::ResamplingDialog(int nativeSrate, int highestSampleRate, QWidg
 
         QTreeWidgetItem* infoItem = new QTreeWidgetItem(streamItem);
         infoItem->setText(0, tr("Name"));
-        infoItem->setText(1, QString::fromStdString(XDFdata->streams[i].info.name));
+        infoItem->setText(1, QString::fromStdString(xdf.streams[i].info.name));
 
         infoItem = new QTreeWidgetItem(streamItem);
         infoItem->setText(0, tr("Type"));
-        infoItem->setText(1, QString::fromStdString(XDFdata->streams[i].info.type));
+        infoItem->setText(1, QString::fromStdString(xdf.streams[i].info.type));
 
         infoItem = new QTreeWidgetItem(streamItem);
         infoItem->setText(0, tr("Sample Rate"));
-        infoItem->setText(1, QString::number(XDFdata->streams[i].info.nominal_srate).append(tr(" Hz")));
-        if (XDFdata->streams[i].info.nominal_srate == 0)
+        infoItem->setText(1, QString::number(xdf.streams[i].info.nominal_srate).append(tr(" Hz")));
+        if (xdf.streams[i].info.nominal_srate == 0)
             infoItem->setText(1, tr("Irregular"));
 
         infoItem = new QTreeWidgetItem(streamItem);
         infoItem->setText(0, tr("Channel Count"));
-        infoItem->setText(1, QString::number(XDFdata->streams[i].info.channel_count));
+        infoItem->setText(1, QString::number(xdf.streams[i].info.channel_count));
 
         infoItem = new QTreeWidgetItem(streamItem);
         infoItem->setText(0, tr("Channel Format"));
-        infoItem->setText(1, QString::fromStdString(XDFdata->streams[i].info.channel_format));
+        infoItem->setText(1, QString::fromStdString(xdf.streams[i].info.channel_format));
     }
 
     ui->spinBox->setMinimum(1);
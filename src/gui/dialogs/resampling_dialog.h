@@ -8,6 +8,8 @@
 
 #include <QDialog>
 
+class Xdf;
+
 namespace Ui {
 class ResamplingDialog;
 }
@@ -20,7 +22,7 @@ class ResamplingDialog : public QDialog
 
 public:
     explicit ResamplingDialog(QWidget *parent = 0);
-    ResamplingDialog(int nativeSrate, int highestSampleRate, QWidget *parent = 0);
+    ResamplingDialog(Xdf const& xdf, int nativeSrate, int highestSampleRate, QWidget *parent = 0);
 
     ~ResamplingDialog();
 
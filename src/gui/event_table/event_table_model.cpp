@@ -0,0 +1,219 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "event_table_model.h"
+#include "base/math_utils.h"
+
+#include <algorithm>
+
+namespace sigviewer
+{
+
+int const EventTableModel::MAX_INCREMENTAL_ROW_CHANGES_ = 100;
+
+//-----------------------------------------------------------------------------
+EventTableModel::EventTableModel (QSharedPointer<EventManager const> event_manager,
+                                  ChannelManager const& channel_manager,
+                                  QObject* parent)
+    : QAbstractTableModel (parent),
+      event_manager_ (event_manager),
+      channel_manager_ (channel_manager),
+      precision_ (MathUtils_::sampleRateToDecimalPrecision (event_manager->getSampleRate ()))
+{
+    resetRows ();
+
+    connect (event_manager_.data(), SIGNAL(eventCreated(QSharedPointer<const SignalEvent>)), SLOT(addEvent(QSharedPointer<const SignalEvent>)));
+    connect (event_manager_.data(), SIGNAL(eventRemoved(EventID)), SLOT(removeEvent(EventID)));
+    connect (event_manager_.data(), SIGNAL(eventChanged(EventID)), SLOT(updateEvent(EventID)));
+    connect (event_manager_.data(), SIGNAL(eventsChanged(EventChanges)), SLOT(updateEvents(EventChanges)));
+}
+
+//-----------------------------------------------------------------------------
+int EventTableModel::rowCount (QModelIndex const& parent) const
+{
+    if (parent.isValid ())
+        return 0;
+    return static_cast<int>(ids_.size ());
+}
+
+//-----------------------------------------------------------------------------
+int EventTableModel::columnCount (QModelIndex const& parent) const
+{
+    if (parent.isValid ())
+        return 0;
+    return NUMBER_COLUMNS_;
+}
+
+//-----------------------------------------------------------------------------
+QVariant EventTableModel::data (QModelIndex const& index, int role) const
+{
+    if (!index.isValid () || index.row () >= rowCount ())
+        return QVariant ();
+    if (role != Qt::DisplayRole && role != SORT_ROLE_ && role != Qt::UserRole)
+        return QVariant ();
+
+    EventID id = ids_[index.row ()];
+    if (role == Qt::UserRole || index.column () == ID_INDEX_)
+        return id;
+
+    // copy the values out of the store first, as the names are looked up
+    // with the event manager locking itself again
+    bool exists = false;
+    uint32 position = 0;
+    uint32 duration = 0;
+    EventType type = 0;
+    ChannelID channel = UNDEFINED_CHANNEL;
+    int stream = UNDEFINED_STREAM_ID;
+    event_manager_->readEvents ([&] (EventStore const& store)
+    {
+        exists = store.contains (id);
+        if (!exists)
+            return;
+        position = store.getPosition (id);
+        duration = store.getDuration (id);
+        type = store.getType (id);
+        channel = store.getChannel (id);
+        stream = store.getStream (id);
+    });
+    if (!exists)
+        return QVariant ();
+
+    float64 sample_rate = event_manager_->getSampleRate ();
+    switch (index.column ())
+    {
+    case POSITION_INDEX_:
+        if (role == SORT_ROLE_)
+            return position;
+        return QString::number (position / sample_rate, 'f', precision_);
+    case DURATION_INDEX_:
+        if (role == SORT_ROLE_)
+            return duration;
+        return QString::number (duration / sample_rate, 'f', precision_);
+    case CHANNEL_INDEX_:
+        return channel_manager_.getChannelLabel (channel, stream);
+    case TYPE_INDEX_:
+        return event_manager_->getNameOfEventType (type);
+    }
+    return QVariant ();
+}
+
+//-----------------------------------------------------------------------------
+QVariant EventTableModel::headerData (int section, Qt::Orientation orientation,
+                                      int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant ();
+    if (orientation == Qt::Vertical)
+        return section + 1;
+
+    switch (section)
+    {
+    case ID_INDEX_:
+        return tr("ID");
+    case POSITION_INDEX_:
+        return tr("Position");
+    case DURATION_INDEX_:
+        return tr("Duration");
+    case CHANNEL_INDEX_:
+        return tr("Channel");
+    case TYPE_INDEX_:
+        return tr("Type");
+    }
+    return QVariant ();
+}
+
+//-----------------------------------------------------------------------------
+int EventTableModel::getRow (EventID id) const
+{
+    auto row = std::lower_bound (ids_.begin (), ids_.end (), id);
+    if (row == ids_.end () || *row != id)
+        return -1;
+    return static_cast<int>(row - ids_.begin ());
+}
+
+//-----------------------------------------------------------------------------
+EventID EventTableModel::getEventId (int row) const
+{
+    if (row < 0 || row >= rowCount ())
+        return UNDEFINED_EVENT_ID;
+    return ids_[row];
+}
+
+//-----------------------------------------------------------------------------
+void EventTableModel::addEvent (QSharedPointer<SignalEvent const> event)
+{
+    insertEventRow (event->getId ());
+}
+
+//-----------------------------------------------------------------------------
+void EventTableModel::removeEvent (EventID id)
+{
+    removeEventRow (id);
+}
+
+//-----------------------------------------------------------------------------
+void EventTableModel::updateEvent (EventID id)
+{
+    int row = getRow (id);
+    if (row < 0)
+        return;
+
+    emit dataChanged (index (row, 0), index (row, NUMBER_COLUMNS_ - 1));
+}
+
+//-----------------------------------------------------------------------------
+void EventTableModel::updateEvents (EventChanges const& changes)
+{
+    if (changes.created.size () + changes.removed.size () > MAX_INCREMENTAL_ROW_CHANGES_)
+    {
+        beginResetModel ();
+        resetRows ();
+        endResetModel ();
+        return;
+    }
+
+    for (EventID id : changes.removed)
+        removeEventRow (id);
+    for (EventID id : changes.created)
+        insertEventRow (id);
+    for (EventID id : changes.changed)
+        updateEvent (id);
+}
+
+//-----------------------------------------------------------------------------
+void EventTableModel::insertEventRow (EventID id)
+{
+    // new events usually get the highest id; a restored event gets its old one
+    auto position = std::lower_bound (ids_.begin (), ids_.end (), id);
+    if (position != ids_.end () && *position == id)
+        return;
+
+    int row = static_cast<int>(position - ids_.begin ());
+    beginInsertRows (QModelIndex (), row, row);
+    ids_.insert (position, id);
+    endInsertRows ();
+}
+
+//-----------------------------------------------------------------------------
+void EventTableModel::removeEventRow (EventID id)
+{
+    int row = getRow (id);
+    if (row < 0)
+        return;
+
+    beginRemoveRows (QModelIndex (), row, row);
+    ids_.erase (ids_.begin () + row);
+    endRemoveRows ();
+}
+
+//-----------------------------------------------------------------------------
+void EventTableModel::resetRows ()
+{
+    QList<EventID> ids = event_manager_->getAllEvents ();
+    ids_.assign (ids.begin (), ids.end ());
+    std::sort (ids_.begin (), ids_.end ());
+}
+
+}
@@ -0,0 +1,101 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef EVENT_TABLE_MODEL_H
+#define EVENT_TABLE_MODEL_H
+
+#include "base/sigviewer_user_types.h"
+#include "base/signal_event.h"
+#include "file_handling/channel_manager.h"
+#include "file_handling/event_manager.h"
+
+#include <QAbstractTableModel>
+#include <QSharedPointer>
+
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// EventTableModel
+///
+/// one row per event of the event manager; the cells are read from the
+/// event store and formatted only when they are shown, so the table costs
+/// one id per event
+///
+/// the rows are kept in order of the event ids, so the row of an event is
+/// found by binary search; sorting by the columns is left to a
+/// QSortFilterProxyModel using SORT_ROLE_
+class EventTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    //-------------------------------------------------------------------------
+    EventTableModel (QSharedPointer<EventManager const> event_manager,
+                     ChannelManager const& channel_manager,
+                     QObject* parent = 0);
+
+    //-------------------------------------------------------------------------
+    virtual int rowCount (QModelIndex const& parent = QModelIndex ()) const;
+
+    //-------------------------------------------------------------------------
+    virtual int columnCount (QModelIndex const& parent = QModelIndex ()) const;
+
+    //-------------------------------------------------------------------------
+    virtual QVariant data (QModelIndex const& index, int role = Qt::DisplayRole) const;
+
+    //-------------------------------------------------------------------------
+    virtual QVariant headerData (int section, Qt::Orientation orientation,
+                                 int role = Qt::DisplayRole) const;
+
+    //-------------------------------------------------------------------------
+    /// @return the row of the event or -1 if it is not in the table
+    int getRow (EventID id) const;
+
+    //-------------------------------------------------------------------------
+    EventID getEventId (int row) const;
+
+    static int const ID_INDEX_ = 0;
+    static int const POSITION_INDEX_ = 1;
+    static int const DURATION_INDEX_ = 2;
+    static int const CHANNEL_INDEX_ = 3;
+    static int const TYPE_INDEX_ = 4;
+    static int const NUMBER_COLUMNS_ = 5;
+
+    /// role of the unformatted values used for sorting
+    static int const SORT_ROLE_ = Qt::UserRole + 1;
+
+private slots:
+    void addEvent (QSharedPointer<SignalEvent const> event);
+    void removeEvent (EventID id);
+    void updateEvent (EventID id);
+    void updateEvents (EventChanges const& changes);
+
+private:
+    //-------------------------------------------------------------------------
+    void insertEventRow (EventID id);
+
+    //-------------------------------------------------------------------------
+    void removeEventRow (EventID id);
+
+    //-------------------------------------------------------------------------
+    /// rebuilds all rows out of the event manager
+    void resetRows ();
+
+    /// more added and removed events of a batch reset the whole table
+    static int const MAX_INCREMENTAL_ROW_CHANGES_;
+
+    QSharedPointer<EventManager const> event_manager_;
+    ChannelManager const& channel_manager_;
+    int precision_;
+
+    // ids of the rows in ascending order
+    std::vector<EventID> ids_;
+};
+
+}
+
+#endif // EVENT_TABLE_MODEL_H
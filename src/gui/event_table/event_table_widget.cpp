@@ -4,45 +4,36 @@
 
 
 #include "event_table_widget.h"
-#include "base/math_utils.h"
 #include "gui/gui_action_factory.h"
 
 #include <QToolBar>
 #include <QDebug>
-#include <QSet>
+#include <QHeaderView>
 
 namespace sigviewer
 {
 
-class EventTableItem : public QTableWidgetItem
-{
-public:
-    EventTableItem (float32 number, int precision = 0) : QTableWidgetItem (QString::number(number, 'f', precision)) {}
-    virtual bool operator< (QTableWidgetItem const& other) const
-    {
-        return other.text().toFloat() < text().toFloat();
-    }
-};
-
-
 //-------------------------------------------------------------------------
 EventTableWidget::EventTableWidget (QSharedPointer<TabContext> tab_context,
                                     QSharedPointer<EventManager> event_manager,
                                     ChannelManager const& channel_manager,
                                     QWidget *parent) :
     QWidget(parent),
-    precision_ (MathUtils_::sampleRateToDecimalPrecision(event_manager->getSampleRate())),
     tab_context_ (tab_context),
     event_manager_ (event_manager),
-    channel_manager_ (channel_manager)
+    event_table_model_ (new EventTableModel (event_manager, channel_manager, this)),
+    sort_model_ (new QSortFilterProxyModel (this))
 {
     ui_.setupUi(this);
-    connect (event_manager_.data(), SIGNAL(eventCreated(QSharedPointer<const SignalEvent>)), SLOT(addToTable(QSharedPointer<const SignalEvent>)));
-    connect (event_manager_.data(), SIGNAL(eventRemoved(EventID)), SLOT(removeFromTable(EventID)));
-    connect (event_manager_.data(), SIGNAL(eventChanged(EventID)), SLOT(updateEventEntry(EventID)));
-    buildTable();
-    ui_.event_table_->sortByColumn (POSITION_INDEX_, Qt::AscendingOrder);
-    ui_.event_table_->hideColumn (ID_INDEX_);
+    sort_model_->setSourceModel (event_table_model_);
+    sort_model_->setSortRole (EventTableModel::SORT_ROLE_);
+    ui_.event_table_->setModel (sort_model_);
+    // all rows have the same height, so the view does not need to ask for
+    // the size of every row
+    ui_.event_table_->verticalHeader()->setSectionResizeMode (QHeaderView::Fixed);
+    connect (ui_.event_table_->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), SLOT(updateSelectionState()));
+    ui_.event_table_->sortByColumn (EventTableModel::POSITION_INDEX_, Qt::AscendingOrder);
+    ui_.event_table_->hideColumn (EventTableModel::ID_INDEX_);
     QToolBar* toolbar = new QToolBar (this);
     toolbar->setToolButtonStyle (Qt::ToolButtonTextUnderIcon);
     toolbar->setOrientation (Qt::Vertical);
@@ -62,10 +53,10 @@ EventTableWidget::~EventTableWidget()
 //-------------------------------------------------------------------------
 QList<EventID> EventTableWidget::getSelectedEvents () const
 {
-    QSet<EventID> selected_events;
-    foreach (QTableWidgetItem* item, ui_.event_table_->selectedItems ())
-        selected_events.insert (item->data(Qt::UserRole).toInt());
-    return selected_events.values();
+    QList<EventID> selected_events;
+    foreach (QModelIndex const& index, ui_.event_table_->selectionModel()->selectedRows ())
+        selected_events.append (event_table_model_->getEventId (sort_model_->mapToSource (index).row ()));
+    return selected_events;
 }
 
 //-------------------------------------------------------------------------
@@ -78,81 +69,10 @@ QSharedPointer<EventView> EventTableWidget::getEventView ()
 }
 
 //-------------------------------------------------------------------------
-void EventTableWidget::addToTable (QSharedPointer<SignalEvent const> event)
-{
-    int row = ui_.event_table_->rowCount ();
-    ui_.event_table_->insertRow (row);
-
-    QTableWidgetItem* position_item = new EventTableItem (event->getPositionInSec(), precision_);
-    QTableWidgetItem* duration_item = new EventTableItem (event->getDurationInSec(), precision_);
-    QTableWidgetItem* channel_item = new QTableWidgetItem (channel_manager_.getChannelLabel(event->getChannel(), event->getStream()));
-    QTableWidgetItem* type_item = new QTableWidgetItem (event_manager_->getNameOfEvent(event->getId()));
-    QTableWidgetItem* id_item = new EventTableItem (event->getId());
-
-    position_item->setData (Qt::UserRole, event->getId());
-    duration_item->setData (Qt::UserRole, event->getId());
-    channel_item->setData (Qt::UserRole, event->getId());
-    type_item->setData (Qt::UserRole, event->getId());
-    id_item->setData (Qt::UserRole, event->getId());
-
-    ui_.event_table_->setItem (row, POSITION_INDEX_,
-                               position_item);
-    row = ui_.event_table_->row (position_item);
-    ui_.event_table_->setItem (row, DURATION_INDEX_,
-                               duration_item);
-    row = ui_.event_table_->row (duration_item);
-    ui_.event_table_->setItem (row, CHANNEL_INDEX_,
-                               channel_item);
-    row = ui_.event_table_->row (channel_item);
-    ui_.event_table_->setItem (row, TYPE_INDEX_,
-                               type_item);
-    row = ui_.event_table_->row (type_item);
-    ui_.event_table_->setItem (row, ID_INDEX_,
-                               id_item);
-}
-
-//-------------------------------------------------------------------------
-void EventTableWidget::removeFromTable (EventID event)
-{
-    qDebug () <<  "EventTableWidget::removeFromTable " << event;
-    QList<int> rows_to_remove;
-    for (int row = 0; row < ui_.event_table_->rowCount(); row++)
-        if (ui_.event_table_->item(row, ID_INDEX_)->text().toInt() == event)
-            rows_to_remove.prepend (row);
-
-    foreach (int row, rows_to_remove)
-        ui_.event_table_->removeRow (row);
-}
-
-//-------------------------------------------------------------------------
-void EventTableWidget::updateEventEntry (EventID event_id)
-{
-    QSharedPointer<SignalEvent const> event = event_manager_->getEvent (event_id);
-    bool updated = false;
-    for (int row = 0;
-         (row < ui_.event_table_->rowCount()) && (!updated);
-         row++)
-    {
-        QTableWidgetItem* id_item = ui_.event_table_->item (row, ID_INDEX_);
-        if (id_item->text().toInt() == event_id)
-        {
-            ui_.event_table_->item (row, CHANNEL_INDEX_)->setText (channel_manager_.getChannelLabel (event->getChannel(), event->getStream()));
-            ui_.event_table_->item (row, POSITION_INDEX_)->setText (QString::number (event->getPositionInSec(), 'f', precision_));
-            ui_.event_table_->item (row, DURATION_INDEX_)->setText (QString::number (event->getDurationInSec(), 'f', precision_));
-            ui_.event_table_->item (row, TYPE_INDEX_)->setText (event_manager_->getNameOfEvent (event_id));
-            updated = true;
-        }
-    }
-}
-
-//-------------------------------------------------------------------------
-void EventTableWidget::on_event_table__itemSelectionChanged ()
+void EventTableWidget::updateSelectionState ()
 {
-    if (ui_.event_table_->selectedItems().size())
-    {
-        qDebug () << "EventTableWidget::on_event_table__itemSelectionChanged";
+    if (ui_.event_table_->selectionModel()->hasSelection())
         tab_context_->setSelectionState (TAB_STATE_EVENT_SELECTED_ALL_CHANNELS);
-    }
     else
         tab_context_->setSelectionState (TAB_STATE_NO_EVENT_SELECTED);
 }
@@ -160,15 +80,7 @@ void EventTableWidget::on_event_table__itemSelectionChanged ()
 //-------------------------------------------------------------------------
 void EventTableWidget::showEvent (QShowEvent* /*event*/)
 {
-    on_event_table__itemSelectionChanged ();
-}
-
-
-//-------------------------------------------------------------------------
-void EventTableWidget::buildTable ()
-{
-    foreach (EventID event_id, event_manager_->getAllEvents ())
-        addToTable (event_manager_->getEvent (event_id));
+    updateSelectionState ();
 }
 
 }
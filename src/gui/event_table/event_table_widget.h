@@ -11,9 +11,12 @@
 #include "file_handling/event_manager.h"
 #include "gui/event_view.h"
 #include "file_handling/channel_manager.h"
+#include "event_table_model.h"
 #include "event_table_view_model.h"
 #include "tab_context.h"
 
+#include <QItemSelection>
+#include <QSortFilterProxyModel>
 #include <QWidget>
 
 namespace sigviewer
@@ -51,29 +54,17 @@ public:
     QSharedPointer<EventView> getEventView ();
 
 private slots:
-    void addToTable (QSharedPointer<SignalEvent const> event);
-    void removeFromTable (EventID event);
-    void updateEventEntry (EventID event_id);
-
-    void on_event_table__itemSelectionChanged ();
+    void updateSelectionState ();
 
 private:
     void showEvent (QShowEvent* event);
-    void buildTable ();
-
-    static int const ID_INDEX_ = 0;
-    static int const POSITION_INDEX_ = 1;
-    static int const DURATION_INDEX_ = 2;
-    static int const CHANNEL_INDEX_ = 3;
-    static int const TYPE_INDEX_ = 4;
-
-    int precision_;
 
     Ui::EventTableWidget ui_;
     QSharedPointer<TabContext> tab_context_;
     QSharedPointer<EventManager> event_manager_;
+    EventTableModel* event_table_model_;
+    QSortFilterProxyModel* sort_model_;
     QSharedPointer<EventTableViewModel> event_table_view_model_;
-    ChannelManager const& channel_manager_;
 };
 
 }
@@ -268,6 +268,8 @@ int MainWindowModel::createSignalVisualisationImpl (ChannelManager const& channe
                                    SLOT(removeEventItem(EventID)));
         model->connect (event_manager.data(), SIGNAL(eventChanged(EventID)),
                                    SLOT(updateEvent(EventID)));
+        model->connect (event_manager.data(), SIGNAL(eventsChanged(EventChanges)),
+                                   SLOT(updateEvents(EventChanges)));
         tab_widget_->tabBar()->setTabButton(1, QTabBar::RightSide, 0);
         tab_widget_->tabBar()->setTabButton(1, QTabBar::LeftSide, 0);
     }
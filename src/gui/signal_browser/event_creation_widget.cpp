@@ -25,7 +25,7 @@ EventCreationWidget::EventCreationWidget (QSharedPointer<SignalVisualisationMode
     if (event_manager_->getFileType().startsWith("XDF", Qt::CaseInsensitive))
     {
         ui_.lineEdit->setPlaceholderText(tr("Customize Event Text"));
-        customized_event_id_ = XDFdata->dictionary.size();
+        customized_event_id_ = event_manager_->getXdf()->dictionary.size();
         ui_.groupBox->setToolTip("Select or customize an event type then click anywhere on the signals to create new events");
     }
     else //custom event seems doesn't work in files other than XDF
@@ -60,7 +60,7 @@ int EventCreationWidget::insertNewEventType()
         ui_.type_combobox_->setCurrentIndex(customized_event_id_);
         customized_event_id_++;
         if (customized_event_id_ >= 254) //Sigviewer has only 255 slots for custom events
-            customized_event_id_ = XDFdata->dictionary.size();
+            customized_event_id_ = event_manager_->getXdf()->dictionary.size();
 
         emit newEventType(event_manager_->getEventTypes());
     }
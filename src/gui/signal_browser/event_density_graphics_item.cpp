@@ -0,0 +1,153 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "event_density_graphics_item.h"
+#include "signal_browser_model_4.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+EventDensityGraphicsItem::EventDensityGraphicsItem (SignalBrowserModel const& model,
+                                                    QSharedPointer<SignalViewSettings const> signal_view_settings,
+                                                    QSharedPointer<EventManager const> event_manager,
+                                                    QSharedPointer<ColorManager const> color_manager)
+    : model_ (model),
+      signal_view_settings_ (signal_view_settings),
+      event_manager_ (event_manager),
+      color_manager_ (color_manager),
+      width_ (0),
+      height_ (0),
+      counts_valid_ (false)
+{
+    // clicks and hovering are handled by the signal items below
+    setAcceptedMouseButtons (Qt::NoButton);
+    setAcceptHoverEvents (false);
+}
+
+//-----------------------------------------------------------------------------
+void EventDensityGraphicsItem::setSize (int32 width, int32 height)
+{
+    if (width != width_ || height != height_)
+        prepareGeometryChange ();
+    width_ = width;
+    height_ = height;
+    invalidate ();
+}
+
+//-----------------------------------------------------------------------------
+QRectF EventDensityGraphicsItem::boundingRect () const
+{
+    return QRectF (0, 0, width_, height_);
+}
+
+//-----------------------------------------------------------------------------
+void EventDensityGraphicsItem::invalidate ()
+{
+    counts_valid_ = false;
+    update ();
+}
+
+//-----------------------------------------------------------------------------
+void EventDensityGraphicsItem::paint (QPainter* painter, QStyleOptionGraphicsItem const* option,
+                                      QWidget*)
+{
+    if (!counts_valid_)
+        countEvents ();
+    if (counts_.isEmpty ())
+        return;
+
+    QRectF clip (option->exposedRect);
+    int32 first_column = std::max<int32> (0, std::floor (clip.left ()));
+    int32 last_column = std::min<int32> (width_, std::ceil (clip.right ()));
+    float64 band_height = static_cast<float64>(height_) / counts_.size ();
+
+    painter->setPen (Qt::NoPen);
+    QVector<QRectF> bars;
+    bars.reserve (std::max (0, last_column - first_column));
+
+    int band = 0;
+    for (auto type_counts = counts_.cbegin (); type_counts != counts_.cend (); ++type_counts, ++band)
+    {
+        std::vector<uint32> const& counts = type_counts.value ();
+        float64 max_count = max_counts_[type_counts.key ()];
+        float64 band_bottom = (band + 1) * band_height;
+
+        bars.clear ();
+        for (int32 column = first_column; column < last_column; column++)
+        {
+            if (counts[column] == 0)
+                continue;
+            float64 bar_height = std::max (1.0, band_height * counts[column] / max_count);
+            bars.append (QRectF (column, band_bottom - bar_height, 1, bar_height));
+        }
+        painter->setBrush (color_manager_->getEventColor (type_counts.key ()));
+        painter->drawRects (bars);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void EventDensityGraphicsItem::countEvents ()
+{
+    counts_.clear ();
+    max_counts_.clear ();
+    counts_valid_ = true;
+    if (width_ <= 0 || event_manager_.isNull ())
+        return;
+
+    float64 pixel_per_sample = signal_view_settings_->getPixelsPerSample ();
+    std::set<EventType> shown_event_types = model_.getShownEventTypes ();
+    std::set<ChannelID> shown_channels = model_.getShownChannels ();
+
+    // every event increments the columns it covers, collected as
+    // differences first so long events cost the same as short ones
+    QMap<EventType, std::vector<int32> > differences;
+    event_manager_->readEvents ([&] (EventStore const& store)
+    {
+        for (EventID id : store.getIds ())
+        {
+            EventType type = store.getType (id);
+            ChannelID channel = store.getChannel (id);
+            if (!shown_event_types.count (type) ||
+                (channel != UNDEFINED_CHANNEL && !shown_channels.count (channel)))
+                continue;
+
+            std::vector<int32>& type_differences = differences[type];
+            if (type_differences.empty ())
+                type_differences.resize (width_ + 1, 0);
+
+            int32 first_column = std::min<int32> (width_ - 1, store.getPosition (id) * pixel_per_sample);
+            int32 last_column = std::min<int32> (width_ - 1, (static_cast<float64>(store.getPosition (id)) +
+                                                              store.getDuration (id)) * pixel_per_sample);
+            type_differences[first_column]++;
+            type_differences[last_column + 1]--;
+        }
+    });
+
+    for (auto type_differences = differences.cbegin (); type_differences != differences.cend (); ++type_differences)
+    {
+        std::vector<uint32>& counts = counts_[type_differences.key ()];
+        counts.resize (width_);
+        int32 count = 0;
+        uint32 max_count = 0;
+        for (int32 column = 0; column < width_; column++)
+        {
+            count += type_differences.value ()[column];
+            counts[column] = count;
+            max_count = std::max<uint32> (max_count, count);
+        }
+        max_counts_[type_differences.key ()] = max_count;
+    }
+}
+
+}
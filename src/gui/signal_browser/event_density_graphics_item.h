@@ -0,0 +1,82 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef EVENT_DENSITY_GRAPHICS_ITEM_H
+#define EVENT_DENSITY_GRAPHICS_ITEM_H
+
+#include "base/sigviewer_user_types.h"
+#include "file_handling/event_manager.h"
+#include "gui/color_manager.h"
+#include "gui/signal_view_settings.h"
+
+#include <QGraphicsObject>
+#include <QMap>
+#include <QSharedPointer>
+
+#include <vector>
+
+namespace sigviewer
+{
+
+class SignalBrowserModel;
+
+//-----------------------------------------------------------------------------
+/// EventDensityGraphicsItem
+///
+/// replaces the single event items if the view is zoomed out that far, that
+/// many events fall onto one pixel column
+///
+/// the events of all shown channels are counted per pixel column and event
+/// type; every shown type gets a horizontal band of the scene in which each
+/// column is drawn as a bar proportional to its count, so painting only
+/// depends on the width of the view and not on the number of events
+class EventDensityGraphicsItem : public QGraphicsObject
+{
+    Q_OBJECT
+public:
+    //-------------------------------------------------------------------------
+    EventDensityGraphicsItem (SignalBrowserModel const& model,
+                              QSharedPointer<SignalViewSettings const> signal_view_settings,
+                              QSharedPointer<EventManager const> event_manager,
+                              QSharedPointer<ColorManager const> color_manager);
+
+    //-------------------------------------------------------------------------
+    /// @param width width of the scene in pixels
+    /// @param height height of the scene in pixels
+    void setSize (int32 width, int32 height);
+
+    //-------------------------------------------------------------------------
+    virtual QRectF boundingRect () const;
+
+public slots:
+    //-------------------------------------------------------------------------
+    /// counts the events again before the next paint
+    void invalidate ();
+
+private:
+    //-------------------------------------------------------------------------
+    virtual void paint (QPainter* painter, QStyleOptionGraphicsItem const* option,
+                        QWidget* widget = 0);
+
+    //-------------------------------------------------------------------------
+    void countEvents ();
+
+    SignalBrowserModel const& model_;
+    QSharedPointer<SignalViewSettings const> signal_view_settings_;
+    QSharedPointer<EventManager const> event_manager_;
+    QSharedPointer<ColorManager const> color_manager_;
+
+    int32 width_;
+    int32 height_;
+    bool counts_valid_;
+
+    // number of events per pixel column of every shown type
+    QMap<EventType, std::vector<uint32> > counts_;
+    QMap<EventType, uint32> max_counts_;
+};
+
+}
+
+#endif // EVENT_DENSITY_GRAPHICS_ITEM_H
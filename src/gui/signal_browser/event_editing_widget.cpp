@@ -118,10 +118,11 @@ void EventEditingWidget::on_type_combobox__currentIndexChanged (int combo_box_in
         //keep up with XDF customized events
         if (event_manager_->getFileType().startsWith("XDF", Qt::CaseInsensitive))
         {
-            if (selected_signal_event_->getStream() == XDFdata->userAddedStream)
+            QSharedPointer<Xdf> xdf = event_manager_->getXdf();
+            if (selected_signal_event_->getStream() == xdf->userAddedStream)
             {
-                int index = selected_signal_event_->getId() - XDFdata->eventType.size();
-                XDFdata->userCreatedEvents[index].first =
+                int index = selected_signal_event_->getId() - xdf->eventType.size();
+                xdf->userCreatedEvents[index].first =
                         event_manager_->getNameOfEventType(event_type).toStdString();
             }
         }
@@ -147,12 +148,13 @@ void EventEditingWidget::on_begin_spinbox__editingFinished ()
     //keep up with XDF customized events
     if (event_manager_->getFileType().startsWith("XDF", Qt::CaseInsensitive))
     {
-        if (selected_signal_event_->getStream() == XDFdata->userAddedStream)
+        QSharedPointer<Xdf> xdf = event_manager_->getXdf();
+        if (selected_signal_event_->getStream() == xdf->userAddedStream)
         {
-            int index = selected_signal_event_->getId() - XDFdata->eventType.size();
-            XDFdata->userCreatedEvents[index].second =
+            int index = selected_signal_event_->getId() - xdf->eventType.size();
+            xdf->userCreatedEvents[index].second =
                     event_manager_->getEvent(selected_signal_event_->getId())->getPositionInSec()
-                    + XDFdata->minTS;
+                    + xdf->minTS;
         }
     }
 }
@@ -79,6 +79,14 @@ QSharedPointer<SignalEvent const> EventGraphicsItem::getSignalEvent () const
     return signal_event_;
 }
 
+//-----------------------------------------------------------------------------
+void EventGraphicsItem::setSignalEvent (QSharedPointer<SignalEvent const> signal_event)
+{
+    setSelected (false);
+    signal_event_ = signal_event;
+    updateToSignalEvent ();
+}
+
 //-----------------------------------------------------------------------------
 bool EventGraphicsItem::displayContextMenu (QGraphicsSceneContextMenuEvent* event,
                                             QMenu* channel_menu)
@@ -117,6 +125,11 @@ bool EventGraphicsItem::displaySelectionMenu (QGraphicsSceneMouseEvent* event)
 //-----------------------------------------------------------------------------
 void EventGraphicsItem::updateToSignalEvent ()
 {
+    // the event manager hands out copies of its events
+    QSharedPointer<SignalEvent const> current_event = event_manager_->getEvent (signal_event_->getId());
+    if (!current_event.isNull())
+        signal_event_ = current_event;
+
     float64 pixel_per_sample = signal_view_settings_->getPixelsPerSample();
     QRectF old_rect;
     if (scene ())
@@ -51,6 +51,10 @@ public:
     void setSelected (bool selected);
     QSharedPointer<SignalEvent const> getSignalEvent () const;
 
+    //-------------------------------------------------------------------------
+    /// shows another event with this item, used to recycle items
+    void setSignalEvent (QSharedPointer<SignalEvent const> signal_event);
+
     static bool displayContextMenu (QGraphicsSceneContextMenuEvent* event,
                                     QMenu* channel_menu);
     static bool displaySelectionMenu (QGraphicsSceneMouseEvent* event);
@@ -27,6 +27,8 @@
 namespace sigviewer
 {
 
+float64 const SignalBrowserModel::DEFAULT_EVENT_DENSITY_PIXELS_PER_SECOND_ = 1;
+
 namespace LayoutFunctions_
 {
     unsigned getSceneHeight (unsigned num_channels, unsigned channel_height, float channel_overlapping)
@@ -53,30 +55,23 @@ SignalBrowserModel::SignalBrowserModel(QSharedPointer<EventManager> event_manage
   signal_browser_view_ (0),
   selected_event_item_ (0),
   x_grid_pixel_intervall_(0),
-  initialized_ (false)
+  initialized_ (false),
+  tile_cache_ (channel_manager),
+  event_items_begin_ (0),
+  event_items_end_ (0),
+  event_density_item_ (0),
+  event_density_pixels_per_second_ (DEFAULT_EVENT_DENSITY_PIXELS_PER_SECOND_)
 {
-    if (!event_manager_.isNull ())
-    {
-       QList<EventID> event_ids = event_manager_->getAllEvents();
-       if (id2event_item_.size() == 0)
-       {
-           for (QList<EventID>::const_iterator event_id_iter = event_ids.begin ();
-                event_id_iter != event_ids.end ();
-                ++event_id_iter)
-           {
-               id2event_item_[*event_id_iter] = new EventGraphicsItem (
-                       *this,
-                       getSignalViewSettings(),
-                       event_manager_->getEvent (*event_id_iter),
-                       event_manager_,
-                       tab_context_,
-                       color_manager_);
-           }
-       }
-    }
+    QSettings settings;
+    event_density_pixels_per_second_ = settings.value ("SignalBrowser/event_density_pixels_per_second",
+                                                       DEFAULT_EVENT_DENSITY_PIXELS_PER_SECOND_).toDouble ();
+
     connect (getSignalViewSettings().data(), SIGNAL(pixelsPerSampleChanged()), SLOT(update()));
     connect (getSignalViewSettings().data(), SIGNAL(channelHeightChanged()), SLOT(update()));
     connect (getSignalViewSettings().data(), SIGNAL(channelOverlappingChanged()), SLOT(update()));
+    connect (getSignalViewSettings().data(), SIGNAL(pixelsPerSampleChanged()), &tile_cache_, SLOT(invalidateAll()));
+    connect (getSignalViewSettings().data(), SIGNAL(channelHeightChanged()), &tile_cache_, SLOT(invalidateAll()));
+    connect (&tile_cache_, SIGNAL(tileRendered(ChannelID)), SLOT(updateChannel(ChannelID)));
 }
 
 //-----------------------------------------------------------------------------
@@ -101,8 +96,17 @@ QMap<ChannelID, SignalGraphicsItem *> SignalBrowserModel::getChannelToSignalItem
 void SignalBrowserModel::setSignalBrowserView (SignalBrowserView* signal_browser_view)
 {
     signal_browser_view_ = signal_browser_view;
+    connect (signal_browser_view_, SIGNAL(visibleXChanged(int32)), SLOT(updateVisibleEventItems()));
     if (!event_manager_.isNull())
+    {
+        event_density_item_ = new EventDensityGraphicsItem (*this, getSignalViewSettings(),
+                                                            event_manager_, color_manager_);
+        event_density_item_->setZValue (SIGNAL_Z + 1);
+        event_density_item_->hide ();
+        signal_browser_view_->addEventDensityGraphicsItem (event_density_item_);
+        connect (event_manager_.data(), SIGNAL(changed()), event_density_item_, SLOT(invalidate()));
         setShownEventTypes (event_manager_->getEventTypes());
+    }
 
 }
 
@@ -235,6 +239,8 @@ void SignalBrowserModel::update()
                                                      getSignalViewSettings()->getChannelOverlapping());
 
     signal_browser_view_->resizeScene (width, height);
+    if (event_density_item_)
+        event_density_item_->setSize (width, height);
 
     double pixel_per_sec = getSignalViewSettings()->getPixelsPerSample() * channel_manager_.getSampleRate();
     x_grid_pixel_intervall_ =  pixel_per_sec * MathUtils_::round125 (100.0 / pixel_per_sec);
@@ -265,6 +271,13 @@ void SignalBrowserModel::update()
     signal_browser_view_->updateWidgets();
 }
 
+//-------------------------------------------------------------------------
+void SignalBrowserModel::updateSignals ()
+{
+    tile_cache_.invalidateAll ();
+    update ();
+}
+
 //-------------------------------------------------------------------------
 void SignalBrowserModel::scaleChannel (ChannelID id, float32 lower_value, float32 upper_value)
 {
@@ -369,6 +382,10 @@ void SignalBrowserModel::updateEventItems ()
 //-------------------------------------------------------------------
 void SignalBrowserModel::selectEvent (EventID id)
 {
+    // the event may lie outside of the range covered by event items
+    if (id2event_item_.find (id) == id2event_item_.end())
+        updateEventItem (id, getShownEventTypes ());
+
     Int2EventGraphicsItemPtrMap::iterator event_iter = id2event_item_.find (id);
     if (event_iter == id2event_item_.end())
     {
@@ -422,54 +439,156 @@ void SignalBrowserModel::modeChangedImpl (SignalVisualisationMode mode)
 //-----------------------------------------------------------------------------
 void SignalBrowserModel::updateEventItemsImpl ()
 {
-    Int2EventGraphicsItemPtrMap::iterator event_iter;
-    for (event_iter = id2event_item_.begin();
-         event_iter != id2event_item_.end();
-         event_iter++)
+    if (!signal_browser_view_ || event_manager_.isNull ())
+        return;
+
+    if (isEventDensityShown ())
+    {
+        showEventDensity ();
+        return;
+    }
+    if (event_density_item_)
+        event_density_item_->hide ();
+
+    // cover one more view width on each side, so scrolling a bit does not
+    // need new items
+    QRectF visible_rect = signal_browser_view_->getVisibleSceneRect ();
+    float64 pixel_per_sample = getSignalViewSettings()->getPixelsPerSample();
+    event_items_begin_ = std::max<float64> (0, (visible_rect.left() - visible_rect.width()) / pixel_per_sample);
+    event_items_end_ = std::max<float64> (0, (visible_rect.right() + visible_rect.width()) / pixel_per_sample);
+
+    QList<EventID> event_ids = event_manager_->getEventsInRange (event_items_begin_, event_items_end_);
+    std::set<EventID> covered_ids (event_ids.begin(), event_ids.end());
+
+    for (Int2EventGraphicsItemPtrMap::iterator event_iter = id2event_item_.begin();
+         event_iter != id2event_item_.end();)
     {
-        QSharedPointer<SignalEvent const> event =
-                event_manager_->getEvent(event_iter->first);
-        if (!event)
+        if (covered_ids.count (event_iter->first) || event_iter->second == selected_event_item_)
+            ++event_iter;
+        else
         {
-            continue;
+            releaseEventItem (event_iter->second);
+            event_iter = id2event_item_.erase (event_iter);
         }
+    }
 
-        Int2IntMap::iterator y_pos_iter;
-        y_pos_iter = channel2y_pos_.find(event->getChannel());
+    std::set<EventType> shown_event_types = getShownEventTypes ();
+    for (EventID id : event_ids)
+        updateEventItem (id, shown_event_types);
+    if (selected_event_item_ && !covered_ids.count (selected_event_item_->getId()))
+        updateEventItem (selected_event_item_->getId(), shown_event_types);
+}
 
-        std::set<EventType> shown_event_types = getShownEventTypes ();
-        if (!shown_event_types.count(event->getType()) ||
-            y_pos_iter == channel2y_pos_.end())
+//-----------------------------------------------------------------------------
+void SignalBrowserModel::updateEventItem (EventID id, std::set<EventType> const& shown_event_types)
+{
+    QSharedPointer<SignalEvent const> event = event_manager_->getEvent (id);
+    if (!event)
+        return;
+
+    Int2EventGraphicsItemPtrMap::iterator event_iter = id2event_item_.find (id);
+    if (!shown_event_types.count (event->getType()) ||
+        channel2y_pos_.find (event->getChannel()) == channel2y_pos_.end())
+    {
+        if (event_iter == id2event_item_.end())
+            return;
+        if (event_iter->second == selected_event_item_)
         {
-            event_iter->second->hide();
-            if (event_iter->second == selected_event_item_)
-            {
-                selected_event_item_->setSelected(false);
-                selected_event_item_ = 0;
-                tab_context_->setSelectionState (TAB_STATE_NO_EVENT_SELECTED);
-            }
+            selected_event_item_->setSelected(false);
+            selected_event_item_ = 0;
+            tab_context_->setSelectionState (TAB_STATE_NO_EVENT_SELECTED);
         }
+        releaseEventItem (event_iter->second);
+        id2event_item_.erase (event_iter);
+    }
+    else if (event_iter == id2event_item_.end())
+        acquireEventItem (event);
+    else
+    {
+        event_iter->second->updateToSignalEvent ();
+        event_iter->second->show();
+    }
+}
+
+//-----------------------------------------------------------------------------
+EventGraphicsItem* SignalBrowserModel::acquireEventItem (QSharedPointer<SignalEvent const> event)
+{
+    EventGraphicsItem* event_item = 0;
+    if (free_event_items_.size ())
+    {
+        event_item = free_event_items_.takeLast ();
+        event_item->setSignalEvent (event);
+    }
+    else
+    {
+        event_item = new EventGraphicsItem (*this, getSignalViewSettings(), event, event_manager_,
+                                            tab_context_, color_manager_);
+        signal_browser_view_->addEventGraphicsItem (event_item);
+        event_item->updateToSignalEvent ();
+    }
+    id2event_item_[event->getId()] = event_item;
+    event_item->show ();
+    return event_item;
+}
+
+//-----------------------------------------------------------------------------
+void SignalBrowserModel::releaseEventItem (EventGraphicsItem* event_item)
+{
+    event_item->hide ();
+    free_event_items_.append (event_item);
+}
+
+//-----------------------------------------------------------------------------
+bool SignalBrowserModel::isEventDensityShown () const
+{
+    return event_density_item_ &&
+           getSignalViewSettings()->getPixelsPerSample() * channel_manager_.getSampleRate()
+           < event_density_pixels_per_second_;
+}
+
+//-----------------------------------------------------------------------------
+void SignalBrowserModel::showEventDensity ()
+{
+    for (Int2EventGraphicsItemPtrMap::iterator event_iter = id2event_item_.begin();
+         event_iter != id2event_item_.end();)
+    {
+        if (event_iter->second == selected_event_item_)
+            ++event_iter;
         else
         {
-            event_iter->second->updateToSignalEvent ();
-            if (!(event_iter->second->scene()))
-                signal_browser_view_->addEventGraphicsItem(event_iter->second);
-            event_iter->second->show();
+            releaseEventItem (event_iter->second);
+            event_iter = id2event_item_.erase (event_iter);
         }
     }
+    if (selected_event_item_)
+        selected_event_item_->updateToSignalEvent ();
+
+    event_density_item_->invalidate ();
+    event_density_item_->show ();
+}
+
+//-----------------------------------------------------------------------------
+void SignalBrowserModel::updateVisibleEventItems ()
+{
+    if (!signal_browser_view_ || isEventDensityShown ())
+        return;
+
+    QRectF visible_rect = signal_browser_view_->getVisibleSceneRect ();
+    float64 pixel_per_sample = getSignalViewSettings()->getPixelsPerSample();
+    if (visible_rect.left() / pixel_per_sample < event_items_begin_ ||
+        visible_rect.right() / pixel_per_sample > event_items_end_)
+        updateEventItemsImpl ();
 }
 
 //-----------------------------------------------------------------------------
 void SignalBrowserModel::addEventItem (QSharedPointer<SignalEvent const> event)
 {
-    EventGraphicsItem* event_item = new EventGraphicsItem(
-            *this, getSignalViewSettings(), event, event_manager_,
-            tab_context_, color_manager_);
+    if (isEventDensityShown () ||
+        event->getPosition() > event_items_end_ ||
+        event->getPosition() + event->getDuration() < event_items_begin_)
+        return;
 
-    id2event_item_[event->getId()] = event_item;
-    signal_browser_view_->addEventGraphicsItem(event_item);
-    event_item->updateToSignalEvent();
-    event_item->show();
+    acquireEventItem (event);
 }
 
 //-----------------------------------------------------------------------------
@@ -495,12 +614,53 @@ void SignalBrowserModel::removeEventItemImpl ()
     delete event_item;
 }
 
+//-----------------------------------------------------------------------------
+void SignalBrowserModel::renderVisibleTiles (qreal device_pixel_ratio)
+{
+    if (!signal_browser_view_)
+        return;
+
+    int32 const tile_width = SignalTileCache::TILE_WIDTH_;
+    QRectF visible_rect = signal_browser_view_->getVisibleSceneRect ();
+    QList<QPair<SignalRenderParameters, int32> > tiles;
+    for (SignalGraphicsItem* signal_item : channel2signal_item_)
+    {
+        if (!signal_item->isVisible ())
+            continue;
+        QRectF rect = signal_item->mapRectFromScene (visible_rect).intersected (signal_item->boundingRect ());
+        if (rect.isEmpty ())
+            continue;
+
+        SignalRenderParameters parameters = signal_item->getRenderParameters ();
+        int32 first_tile = std::max<int32> (0, rect.left() / tile_width);
+        int32 last_tile = std::min<int32> ((static_cast<int32>(parameters.width) - 1) / tile_width,
+                                           rect.right() / tile_width);
+        for (int32 tile_index = first_tile; tile_index <= last_tile; tile_index++)
+            tiles.append (qMakePair (parameters, tile_index));
+    }
+    tile_cache_.renderTiles (tiles, device_pixel_ratio);
+}
+
+//-----------------------------------------------------------------------------
+void SignalBrowserModel::updateChannel (ChannelID id)
+{
+    if (channel2signal_item_.count (id))
+        channel2signal_item_[id]->update ();
+}
+
 //-----------------------------------------------------------------------------
 // set event changed
 void SignalBrowserModel::updateEvent (EventID id)
 {
     if (id2event_item_.find (id) == id2event_item_.end())
+    {
+        // the event may have been moved into the covered range
+        QSharedPointer<SignalEvent const> event = event_manager_->getEvent (id);
+        if (event && !isEventDensityShown () && event->getPosition() <= event_items_end_ &&
+            event->getPosition() + event->getDuration() >= event_items_begin_)
+            updateEventItem (id, getShownEventTypes ());
         return;
+    }
 
     EventGraphicsItem* event_item = id2event_item_[id];
     event_item->updateToSignalEvent ();
@@ -517,6 +677,27 @@ void SignalBrowserModel::updateEvent (EventID id)
         }
 }
 
+//-----------------------------------------------------------------------------
+void SignalBrowserModel::updateEvents (EventChanges const& changes)
+{
+    for (EventID id : changes.removed)
+    {
+        Int2EventGraphicsItemPtrMap::iterator event_iter = id2event_item_.find (id);
+        if (event_iter == id2event_item_.end())
+            continue;
+        if (event_iter->second == selected_event_item_)
+            unselectEvent ();
+        releaseEventItem (event_iter->second);
+        id2event_item_.erase (event_iter);
+    }
+
+    // created and changed events are covered by updating the items in range
+    updateEventItemsImpl ();
+
+    if (selected_event_item_ && changes.changed.contains (selected_event_item_->getId()))
+        updateEvent (selected_event_item_->getId());
+}
+
 //-----------------------------------------------------------------------------
 // get selected event item
 EventGraphicsItem* SignalBrowserModel::getSelectedEventItem()
@@ -13,6 +13,8 @@
 #include "gui/signal_visualisation_model.h"
 #include "gui/color_manager.h"
 #include "event_graphics_item.h"
+#include "event_density_graphics_item.h"
+#include "signal_tile_cache.h"
 
 #include <QObject>
 #include <QMap>
@@ -89,6 +91,15 @@ public:
     void zoomInAll();
     void zoomOutAll();
 
+    //-------------------------------------------------------------------------
+    /// pre-rendered signals of the channels
+    SignalTileCache& getTileCache () {return tile_cache_;}
+
+    //-------------------------------------------------------------------------
+    /// renders the missing tiles of all visible channels in parallel, so
+    /// painting the channels afterwards only composes the tiles
+    void renderVisibleTiles (qreal device_pixel_ratio);
+
     EventGraphicsItem* getSelectedEventItem();
     void updateEventItems ();
 
@@ -96,6 +107,10 @@ public slots:
     //-------------------------------------------------------------------------
     virtual void update ();
 
+    //-------------------------------------------------------------------------
+    /// drops the rendered tiles, which may lack samples decoded since
+    virtual void updateSignals ();
+
     //-------------------------------------------------------------------------
     /// adds the given event
     virtual void addEventItem (QSharedPointer<SignalEvent const> event);
@@ -106,6 +121,10 @@ public slots:
 
     void updateEvent (EventID id);
 
+    //-------------------------------------------------------------------------
+    /// updates the items after a batch of edits at once
+    void updateEvents (EventChanges const& changes);
+
     virtual void selectEvent (EventID id);
     void unselectEvent ();
 
@@ -121,6 +140,15 @@ private slots:
     /// implementation of removeEventItem which really deletes the item
     void removeEventItemImpl ();
 
+    //-------------------------------------------------------------------------
+    /// repaints the channel, e.g. if a tile of it has been rendered
+    void updateChannel (ChannelID id);
+
+    //-------------------------------------------------------------------------
+    /// updates the event items if the view has been scrolled out of the range
+    /// covered by them
+    void updateVisibleEventItems ();
+
 private:
 
     //-------------------------------------------------------------------------
@@ -130,10 +158,35 @@ private:
     void removeChannel (ChannelID channel_nr);
 
     //-------------------------------------------------------------------------
+    /// creates, updates or releases the items of the events around the
+    /// visible range; events further away have no item at all
     void updateEventItemsImpl ();
 
+    //-------------------------------------------------------------------------
+    /// shows the event with an item if its type and channel are shown,
+    /// otherwise releases its item
+    void updateEventItem (EventID id, std::set<EventType> const& shown_event_types);
+
+    //-------------------------------------------------------------------------
+    /// @return a recycled or new item showing the event
+    EventGraphicsItem* acquireEventItem (QSharedPointer<SignalEvent const> event);
+
+    //-------------------------------------------------------------------------
+    /// hides the item and keeps it for reuse
+    void releaseEventItem (EventGraphicsItem* event_item);
+
+    //-------------------------------------------------------------------------
+    /// @return true if the view is zoomed out that far, that the events are
+    ///         drawn by the density item instead of single items
+    bool isEventDensityShown () const;
+
+    //-------------------------------------------------------------------------
+    /// releases all event items but the selected one and shows the density
+    void showEventDensity ();
+
     //-------------------------------------------------------------------------
     static uint8 const SIGNAL_Z = 4;
+    static float64 const DEFAULT_EVENT_DENSITY_PIXELS_PER_SECOND_;
 
     ChannelManager const& channel_manager_;
     QSharedPointer<EventManager> event_manager_;
@@ -156,7 +209,13 @@ private:
     float64 x_grid_pixel_intervall_;
 
     bool initialized_;
+    SignalTileCache tile_cache_;
     QList<EventGraphicsItem*> items_to_delete_;
+    QList<EventGraphicsItem*> free_event_items_;
+    unsigned event_items_begin_;
+    unsigned event_items_end_;
+    EventDensityGraphicsItem* event_density_item_;
+    float64 event_density_pixels_per_second_;
 };
 
 }
@@ -6,6 +6,7 @@
 #include "signal_browser_view.h"
 #include "signal_graphics_item.h"
 #include "event_graphics_item.h"
+#include "event_density_graphics_item.h"
 #include "y_axis_widget_4.h"
 #include "x_axis_widget_4.h"
 #include "label_widget.h"
@@ -123,12 +124,24 @@ void SignalBrowserView::removeEventGraphicsItem (EventGraphicsItem* event_graphi
     qDebug () << "SignalBrowserView::removeEventGraphicsItem " << event_graphics_item->getId() << " finished";
 }
 
+//-----------------------------------------------------------------------------
+void SignalBrowserView::addEventDensityGraphicsItem (EventDensityGraphicsItem* event_density_item)
+{
+    graphics_scene_->addItem (event_density_item);
+}
+
 //-----------------------------------------------------------------------------
 int32 SignalBrowserView::getVisibleX () const
 {
     return graphics_view_->mapToScene(0,0).x();
 }
 
+//-----------------------------------------------------------------------------
+QRectF SignalBrowserView::getVisibleSceneRect () const
+{
+    return graphics_view_->mapToScene (graphics_view_->viewport()->rect()).boundingRect();
+}
+
 //-----------------------------------------------------------------------------
 void SignalBrowserView::goTo (float32 x)
 {
@@ -241,6 +254,9 @@ void SignalBrowserView::setMode (SignalVisualisationMode mode)
 //-----------------------------------------------------------------------------
 void SignalBrowserView::graphicsViewResized (QResizeEvent* event)
 {
+    // a wider view shows more of the scene
+    emit visibleXChanged (graphics_view_->mapToScene (0, 0).x());
+
     unsigned channel_height = model_->getSignalViewSettings()->getChannelHeight();
     if (!channel_height)
         return;
@@ -34,6 +34,7 @@ class YAxisWidget;
 class XAxisWidget;
 class SignalGraphicsItem;
 class EventGraphicsItem;
+class EventDensityGraphicsItem;
 class EventEditingWidget;
 class EventCreationWidget;
 class AdaptBrowserViewWidget;
@@ -55,9 +56,11 @@ public:
     void removeSignalGraphicsItem (ChannelID channel_nr, SignalGraphicsItem* graphics_item);
     void addEventGraphicsItem (EventGraphicsItem* event_graphics_item);
     void removeEventGraphicsItem (EventGraphicsItem* event_graphics_item);
+    void addEventDensityGraphicsItem (EventDensityGraphicsItem* event_density_item);
 
     void resizeScene (int32 width, int32 height);
     int32 getVisibleX () const;
+    QRectF getVisibleSceneRect () const;
 
     void goTo (float32 x);
     void updateWidgets (bool update_view = true);
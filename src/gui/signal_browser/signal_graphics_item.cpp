@@ -5,6 +5,7 @@
 
 #include "signal_graphics_item.h"
 #include "signal_browser_model_4.h"
+#include "signal_tile_cache.h"
 #include "editing_commands/new_event_undo_command.h"
 #include "base/math_utils.h"
 #include "gui/signal_browser_mouse_handling.h"
@@ -245,32 +246,6 @@ void SignalGraphicsItem::paint (QPainter* painter, const QStyleOptionGraphicsIte
 
     QRectF clip (option->exposedRect);
 
-    double pixel_per_sample = signal_view_settings_->getPixelsPerSample();
-
-    double last_x = clip.x () - 10;
-    if (last_x < 0)
-        last_x = 0;
-    unsigned start_sample = last_x / pixel_per_sample;
-    if (start_sample > 0)
-        start_sample--;
-
-    unsigned length = ((clip.x() - start_sample * pixel_per_sample)
-                       + clip.width() + 20);
-    if (last_x + length > width_)
-        length = width_ - last_x;
-
-    length /= pixel_per_sample;
-    if (length < channel_manager_.getNumberSamples() - start_sample)
-        length++;
-
-
-    QSharedPointer<DataBlock const> data_block = channel_manager_.getData (id_, start_sample, length);
-
-    last_x = start_sample * pixel_per_sample;
-
-    float64 last_y = (*data_block)[0];
-    float64 new_y = 0;
-
     if (draw_x_grid_)
         drawXGrid (painter, option);
 
@@ -286,27 +261,70 @@ void SignalGraphicsItem::paint (QPainter* painter, const QStyleOptionGraphicsIte
 //        painter->drawLine(0, height_, width_, height_);
 //    }
 
-    painter->translate (0, height_ / 2.0f);
-    painter->setPen (color_manager_->getChannelColor (id_));
+    SignalRenderParameters parameters = getRenderParameters ();
 
+    // tiles can only be blitted if the item is not scaled (e.g. when printing)
+    if (painter->worldTransform().type() > QTransform::TxTranslate || width_ == 0)
+    {
+        painter->translate (0, height_ / 2.0f);
+        SignalRenderer_::drawSignal (painter, channel_manager_, parameters, clip.left(), clip.right());
+        return;
+    }
+
+    SignalTileCache& tile_cache = signal_browser_model_.getTileCache();
+    int32 const tile_width = SignalTileCache::TILE_WIDTH_;
+    qreal device_pixel_ratio = painter->device() ? painter->device()->devicePixelRatioF() : 1;
+    int32 first_tile = std::max<int32> (0, clip.left() / tile_width);
+    int32 last_tile = std::min<int32> ((width_ - 1) / tile_width, clip.right() / tile_width);
+
+    bool parallel_rendered = false;
 
-    for (int index = 0;
-         index < static_cast<int>(data_block->size()) - 1;
-         index++)
+    // the neighbouring tiles are requested too, so they are ready for scrolling
+    for (int32 tile_index = first_tile - 1; tile_index <= last_tile + 1; tile_index++)
     {
-        new_y = (*data_block)[index+1];
+        if (tile_index < 0 || tile_index * tile_width >= static_cast<int32>(width_))
+            continue;
 
-        //!Draw nothing if NAN
-        if (!std::isnan(last_y) && !std::isnan(new_y))
+        QImage tile = tile_cache.getTile (parameters, tile_index, device_pixel_ratio);
+        if (tile_index < first_tile || tile_index > last_tile)
+            continue;
+
+        // render the visible tiles of all channels at once instead of
+        // drawing one channel after the other
+        if (tile.isNull() && tile_cache.isParallelRenderingEnabled() && !parallel_rendered)
         {
-            painter->drawLine(last_x, y_offset_ - (y_zoom_ * last_y), last_x + pixel_per_sample, y_offset_ - (y_zoom_ * new_y));
+            signal_browser_model_.renderVisibleTiles (device_pixel_ratio);
+            parallel_rendered = true;
+            tile = tile_cache.getTile (parameters, tile_index, device_pixel_ratio);
         }
 
-        last_x += pixel_per_sample;
-        last_y = new_y;
+        if (!tile.isNull())
+            painter->drawImage (QPointF (tile_index * tile_width, 0), tile);
+        else
+        {
+            // drawn directly until the tile has been rendered
+            painter->save ();
+            painter->translate (0, height_ / 2.0f);
+            SignalRenderer_::drawSignal (painter, channel_manager_, parameters,
+                                         std::max<float64> (clip.left(), tile_index * tile_width),
+                                         std::min<float64> (clip.right(), (tile_index + 1) * tile_width));
+            painter->restore ();
+        }
     }
+}
 
-    return;
+//-----------------------------------------------------------------------------
+SignalRenderParameters SignalGraphicsItem::getRenderParameters () const
+{
+    SignalRenderParameters parameters;
+    parameters.id = id_;
+    parameters.pixels_per_sample = signal_view_settings_->getPixelsPerSample();
+    parameters.y_zoom = y_zoom_;
+    parameters.y_offset = y_offset_;
+    parameters.height = height_;
+    parameters.width = width_;
+    parameters.color = color_manager_->getChannelColor (id_);
+    return parameters;
 }
 
 //-----------------------------------------------------------------------------
@@ -448,17 +466,18 @@ void SignalGraphicsItem::mousePressEvent (QGraphicsSceneMouseEvent * event )
 
             if (event_manager_->getFileType().startsWith("XDF", Qt::CaseInsensitive))
             {
+                QSharedPointer<Xdf> xdf = event_manager_->getXdf();
                 //If user added events in Sigviewer, we will create a new stream to store these events
                 //and later store back to the XDF file
-                if (!XDFdata->userAddedStream)
+                if (!xdf->userAddedStream)
                 {
                     //check whether a user added stream has already been existing
-                    XDFdata->userAddedStream = XDFdata->streams.size();
-                    XDFdata->streams.emplace_back();
+                    xdf->userAddedStream = xdf->streams.size();
+                    xdf->streams.emplace_back();
                     time_t currentTime = time(nullptr);
                     std::string timeString = asctime(localtime(&currentTime));
                     timeString.pop_back(); //we don't need '\n' at the end
-                    XDFdata->streams.back().streamHeader =
+                    xdf->streams.back().streamHeader =
                             "<?xml version='1.0'?>"
                             "<info>"
                                 "<name>User Created Event Stream</name>"
@@ -478,12 +497,12 @@ void SignalGraphicsItem::mousePressEvent (QGraphicsSceneMouseEvent * event )
                 new_signal_event_ = QSharedPointer<SignalEvent>
                         (new SignalEvent(sample_cleaned_pos,
                                          signal_browser_model_.getActualEventCreationType(),
-                                         event_manager_->getSampleRate(), XDFdata->userAddedStream,
+                                         event_manager_->getSampleRate(), xdf->userAddedStream,
                                          id_));
-                //Add the newly created event to the XDFdata object for later use
+                //Add the newly created event to the Xdf of the file for later use
                 QString eventName = event_manager_->getNameOfEventType(signal_browser_model_.getActualEventCreationType());
-                XDFdata->userCreatedEvents.emplace_back
-                        (eventName.toStdString(), (sample_cleaned_pos/event_manager_->getSampleRate()) + XDFdata->minTS);
+                xdf->userCreatedEvents.emplace_back
+                        (eventName.toStdString(), (sample_cleaned_pos/event_manager_->getSampleRate()) + xdf->minTS);
             }
             else
             {
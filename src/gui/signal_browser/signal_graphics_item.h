@@ -10,6 +10,7 @@
 #include "file_handling/event_manager.h"
 #include "gui/color_manager.h"
 #include "gui/signal_view_settings.h"
+#include "signal_renderer.h"
 
 #include <QGraphicsObject>
 
@@ -53,6 +54,10 @@ public:
     void scale (double lower_value, double upper_value);
     void autoScale (ScaleMode auto_zoom_type);
 
+    //-------------------------------------------------------------------------
+    /// parameters to draw the signal of the item with its current settings
+    SignalRenderParameters getRenderParameters () const;
+
 public slots:
     void updateYGridIntervall();
     void setHeight (unsigned height);
@@ -0,0 +1,232 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "signal_renderer.h"
+
+#include <QLineF>
+#include <QPainter>
+#include <QPointF>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+bool SignalRenderParameters::operator== (SignalRenderParameters const& other) const
+{
+    return id == other.id &&
+           pixels_per_sample == other.pixels_per_sample &&
+           y_zoom == other.y_zoom &&
+           y_offset == other.y_offset &&
+           height == other.height &&
+           width == other.width &&
+           color == other.color;
+}
+
+namespace SignalRenderer_
+{
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/// samples per pixel from which on one vertical min/max line is drawn per
+/// pixel column instead of a line between every two samples
+double const MIN_SAMPLES_PER_PIXEL_FOR_ENVELOPE = 4;
+
+//-----------------------------------------------------------------------------
+/// draws one vertical min/max line per pixel column, used if many samples
+/// fall onto one pixel
+void drawEnvelope (QPainter* painter, ChannelManager const& channel_manager,
+                   SignalRenderParameters const& parameters,
+                   float64 x_from, float64 x_to)
+{
+    ChannelID id = parameters.id;
+    float64 samples_per_pixel = 1.0 / parameters.pixels_per_sample;
+    size_t number_samples = channel_manager.getNumberSamples();
+
+    int32 x_start = std::max<int32> (0, x_from - 1);
+    int32 x_end = std::min<int32> (parameters.width, x_to + 1);
+    if (x_end <= x_start)
+        return;
+
+    size_t first_sample = x_start * samples_per_pixel;
+    size_t last_sample = std::min<size_t> (number_samples, std::ceil (x_end * samples_per_pixel) + 1);
+    if (last_sample <= first_sample)
+        return;
+
+    // use the coarsest precomputed min/max level that still resolves one
+    // pixel, otherwise fall back to the raw samples of the exposed range
+    unsigned factor = channel_manager.getNearestDownsamplingFactor (id, samples_per_pixel);
+    QSharedPointer<DataBlock const> min_data;
+    QSharedPointer<DataBlock const> max_data;
+    size_t data_offset = 0;
+    if (factor > 1)
+    {
+        min_data = channel_manager.getDownsampledMin (id, factor);
+        max_data = channel_manager.getDownsampledMax (id, factor);
+    }
+    if (min_data.isNull() || max_data.isNull())
+    {
+        factor = 1;
+        data_offset = first_sample;
+        min_data = channel_manager.getAvailableData (id, first_sample, last_sample - first_sample);
+        max_data = min_data;
+    }
+    if (min_data.isNull())
+        return;
+
+    size_t data_size = std::min (min_data->size(), max_data->size());
+
+    QVector<QLineF> lines;
+    lines.reserve (x_end - x_start);
+
+    bool last_valid = false;
+    float32 last_min = 0;
+    float32 last_max = 0;
+    for (int32 x = x_start; x < x_end; x++)
+    {
+        size_t column_start = x * samples_per_pixel;
+        size_t column_end = std::min<size_t> (number_samples, (x + 1) * samples_per_pixel);
+        // columns narrower than a sample, which only happens for channels
+        // recorded at a higher rate than the file, show everything between
+        // the samples around them
+        if (samples_per_pixel < 1)
+            column_end = std::min<size_t> (number_samples, std::ceil ((x + 1) * samples_per_pixel) + 1);
+        else if (column_end <= column_start)
+            column_end = column_start + 1;
+
+        size_t index = column_start / factor;
+        size_t index_end = (column_end + factor - 1) / factor;
+        index = index > data_offset ? index - data_offset : 0;
+        index_end = std::min (data_size, index_end > data_offset ? index_end - data_offset : 0);
+
+        //!Skip NAN, columns without any value are drawn as gaps
+        bool valid = false;
+        float32 min = 0;
+        float32 max = 0;
+        if (index < index_end)
+        {
+            if (min_data == max_data)
+                valid = min_data->getMinMax (index, index_end - index, min, max);
+            else
+            {
+                float32 unused = 0;
+                valid = min_data->getMinMax (index, index_end - index, min, unused) &&
+                        max_data->getMinMax (index, index_end - index, unused, max);
+            }
+        }
+
+        if (valid)
+        {
+            float32 column_min = min;
+            float32 column_max = max;
+            // connect to the previous column so steep slopes stay continuous
+            if (last_valid)
+            {
+                min = std::min (min, last_max);
+                max = std::max (max, last_min);
+            }
+            float64 y_min = parameters.y_offset - (parameters.y_zoom * min);
+            float64 y_max = parameters.y_offset - (parameters.y_zoom * max);
+            if (y_max - y_min < 1 && y_min - y_max < 1)
+                lines.append (QLineF (x, y_min, x + 1, y_min));
+            else
+                lines.append (QLineF (x, y_min, x, y_max));
+            last_min = column_min;
+            last_max = column_max;
+        }
+        last_valid = valid;
+    }
+
+    painter->drawLines (lines);
+}
+
+//-----------------------------------------------------------------------------
+/// draws a polyline through the samples, interrupted at NAN values
+void drawSamples (QPainter* painter, ChannelManager const& channel_manager,
+                  SignalRenderParameters const& parameters,
+                  float64 x_from, float64 x_to)
+{
+    float64 pixel_per_sample = parameters.pixels_per_sample;
+    size_t number_samples = channel_manager.getNumberSamples();
+
+    // one more sample on each side, so lines leaving the range are drawn too
+    size_t start_sample = std::max<float64> (0, std::floor (x_from / pixel_per_sample) - 1);
+    size_t end_sample = std::min<float64> (number_samples, std::ceil (x_to / pixel_per_sample) + 2);
+    if (end_sample <= start_sample + 1)
+        return;
+
+    QSharedPointer<DataBlock const> data_block = channel_manager.getAvailableData (parameters.id, start_sample,
+                                                                                   end_sample - start_sample);
+    if (data_block.isNull() || data_block->size() < 2)
+        return;
+
+    // reused between calls, every rendering thread has its own buffers
+    thread_local std::vector<float32> values;
+    thread_local std::vector<QPointF> points;
+
+    // only the covered parts of sparse channels are read and drawn
+    float64 x_start = start_sample * pixel_per_sample;
+    float64 y_offset = parameters.y_offset;
+    float64 y_zoom = parameters.y_zoom;
+    for (DataBlock::Range const& range : data_block->getCoveredRanges (0, data_block->size()))
+    {
+        size_t size = range.end - range.begin;
+        values.resize (size);
+        points.resize (size);
+        data_block->copyTo (range.begin, size, values.data());
+
+        QPointF* point = points.data();
+        float32 const* value = values.data();
+        for (size_t index = 0; index < size; index++)
+            point[index] = QPointF (x_start + (range.begin + index) * pixel_per_sample,
+                                    y_offset - (y_zoom * value[index]));
+
+        //!Draw nothing if NAN
+        size_t run_start = 0;
+        while (run_start < size)
+        {
+            while (run_start < size && std::isnan (value[run_start]))
+                run_start++;
+            size_t run_end = run_start;
+            while (run_end < size && !std::isnan (value[run_end]))
+                run_end++;
+            if (run_end - run_start > 1)
+                painter->drawPolyline (point + run_start, static_cast<int>(run_end - run_start));
+            run_start = run_end;
+        }
+    }
+}
+
+}
+
+//-----------------------------------------------------------------------------
+void drawSignal (QPainter* painter, ChannelManager const& channel_manager,
+                 SignalRenderParameters const& parameters,
+                 float64 x_start, float64 x_end)
+{
+    if (x_end <= x_start || parameters.pixels_per_sample <= 0)
+        return;
+
+    painter->setPen (parameters.color);
+
+    // every channel is drawn at its own resolution, channels recorded at a
+    // higher rate than the file have more samples per pixel
+    float64 native_samples_per_sample = channel_manager.getChannelSampleRate (parameters.id) /
+                                        channel_manager.getSampleRate ();
+    if (native_samples_per_sample / parameters.pixels_per_sample >= MIN_SAMPLES_PER_PIXEL_FOR_ENVELOPE)
+        drawEnvelope (painter, channel_manager, parameters, x_start, x_end);
+    else
+        drawSamples (painter, channel_manager, parameters, x_start, x_end);
+}
+
+}
+
+}
@@ -0,0 +1,54 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef SIGNAL_RENDERER_H
+#define SIGNAL_RENDERER_H
+
+#include "file_handling/channel_manager.h"
+
+#include <QColor>
+
+class QPainter;
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// SignalRenderParameters
+///
+/// everything needed to draw the signal of a channel, so it can be drawn
+/// independently of its SignalGraphicsItem (e.g. by another thread)
+struct SignalRenderParameters
+{
+    ChannelID id;
+    float64 pixels_per_sample;
+    float64 y_zoom;
+    float64 y_offset;
+    int32 height;
+    uint32 width;
+    QColor color;
+
+    //-------------------------------------------------------------------------
+    bool operator== (SignalRenderParameters const& other) const;
+};
+
+namespace SignalRenderer_
+{
+
+//-----------------------------------------------------------------------------
+/// draws the signal of a channel between the given x positions; y positions
+/// are relative to the middle of the channel
+///
+/// thread safe as long as the ChannelManager is, so it may draw into a QImage
+/// on any thread
+void drawSignal (QPainter* painter, ChannelManager const& channel_manager,
+                 SignalRenderParameters const& parameters,
+                 float64 x_start, float64 x_end);
+
+}
+
+}
+
+#endif // SIGNAL_RENDERER_H
@@ -0,0 +1,189 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "signal_tile_cache.h"
+
+#include <QPainter>
+#include <QSemaphore>
+#include <QSettings>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sigviewer
+{
+
+int32 const SignalTileCache::TILE_WIDTH_ = 256;
+int const SignalTileCache::DEFAULT_CACHE_SIZE_IN_MB_ = 256;
+
+//-----------------------------------------------------------------------------
+size_t qHash (SignalTileCache::TileKey const& key, size_t seed)
+{
+    return qHashMulti (seed, key.parameters.id, key.tile_index, key.parameters.pixels_per_sample,
+                       key.parameters.y_zoom, key.parameters.y_offset, key.parameters.height,
+                       key.parameters.color.rgba (), key.device_pixel_ratio);
+}
+
+//-----------------------------------------------------------------------------
+SignalTileCache::SignalTileCache (ChannelManager const& channel_manager)
+    : channel_manager_ (channel_manager)
+{
+    qRegisterMetaType<ChannelID> ("ChannelID");
+
+    QSettings settings;
+    parallel_rendering_ = settings.value ("SignalBrowser/parallel_rendering", true).toBool ();
+    int cache_size = settings.value ("SignalBrowser/tile_cache_size_mb", DEFAULT_CACHE_SIZE_IN_MB_).toInt ();
+    tiles_.setMaxCost (std::max (1, cache_size) * 1024);
+}
+
+//-----------------------------------------------------------------------------
+SignalTileCache::~SignalTileCache ()
+{
+    pool_.clear ();
+    pool_.waitForDone ();
+}
+
+//-----------------------------------------------------------------------------
+QImage SignalTileCache::getTile (SignalRenderParameters const& parameters, int32 tile_index,
+                                 qreal device_pixel_ratio)
+{
+    TileKey key = {parameters, tile_index, device_pixel_ratio};
+
+    QMutexLocker lock (&mutex_);
+
+    // tiles of former parameters of the channel will never be shown again
+    if (current_parameters_.contains (parameters.id) &&
+        !(current_parameters_[parameters.id] == parameters))
+        removeTiles (parameters.id);
+    current_parameters_[parameters.id] = parameters;
+
+    if (QImage* tile = tiles_.object (key))
+        return *tile;
+
+    if (!rendering_.contains (key))
+    {
+        rendering_.insert (key);
+        pool_.start ([this, key] ()
+        {
+            // skip tiles the channel does not need anymore
+            {
+                QMutexLocker lock (&mutex_);
+                if (!rendering_.contains (key) ||
+                    !(current_parameters_.value (key.parameters.id) == key.parameters))
+                {
+                    rendering_.remove (key);
+                    return;
+                }
+            }
+
+            QImage tile = renderTile (key);
+
+            {
+                QMutexLocker lock (&mutex_);
+                if (!rendering_.remove (key))
+                    return;
+                tiles_.insert (key, new QImage (tile), std::max<qsizetype> (1, tile.sizeInBytes () / 1024));
+            }
+            emit tileRendered (key.parameters.id);
+        });
+    }
+    return QImage ();
+}
+
+//-----------------------------------------------------------------------------
+void SignalTileCache::renderTiles (QList<QPair<SignalRenderParameters, int32> > const& tiles,
+                                   qreal device_pixel_ratio)
+{
+    QList<TileKey> missing_tiles;
+    {
+        QMutexLocker lock (&mutex_);
+        for (auto const& tile : tiles)
+        {
+            TileKey key = {tile.first, tile.second, device_pixel_ratio};
+            if (current_parameters_.contains (key.parameters.id) &&
+                !(current_parameters_[key.parameters.id] == key.parameters))
+                removeTiles (key.parameters.id);
+            current_parameters_[key.parameters.id] = key.parameters;
+
+            if (tiles_.contains (key) || missing_tiles.contains (key))
+                continue;
+            // a background render of the tile is superseded by this one
+            rendering_.remove (key);
+            missing_tiles.append (key);
+        }
+    }
+    if (missing_tiles.isEmpty ())
+        return;
+
+    // rendered before any prefetched tile waiting in the pool
+    int const RENDER_PRIORITY = 1;
+    QSemaphore rendered;
+    for (TileKey const& key : missing_tiles)
+    {
+        pool_.start ([this, key, &rendered] ()
+        {
+            QImage tile = renderTile (key);
+            {
+                QMutexLocker lock (&mutex_);
+                tiles_.insert (key, new QImage (tile), std::max<qsizetype> (1, tile.sizeInBytes () / 1024));
+            }
+            rendered.release ();
+        }, RENDER_PRIORITY);
+    }
+    rendered.acquire (missing_tiles.size ());
+}
+
+//-----------------------------------------------------------------------------
+void SignalTileCache::invalidate (ChannelID id)
+{
+    QMutexLocker lock (&mutex_);
+    removeTiles (id);
+    current_parameters_.remove (id);
+}
+
+//-----------------------------------------------------------------------------
+void SignalTileCache::invalidateAll ()
+{
+    QMutexLocker lock (&mutex_);
+    tiles_.clear ();
+    rendering_.clear ();
+    current_parameters_.clear ();
+}
+
+//-----------------------------------------------------------------------------
+QImage SignalTileCache::renderTile (TileKey const& key) const
+{
+    int32 width = std::min<int32> (TILE_WIDTH_, static_cast<int32>(key.parameters.width) -
+                                                key.tile_index * TILE_WIDTH_);
+    QImage tile (static_cast<int>(std::ceil (std::max (1, width) * key.device_pixel_ratio)),
+                 static_cast<int>(std::ceil (std::max (1, key.parameters.height) * key.device_pixel_ratio)),
+                 QImage::Format_ARGB32_Premultiplied);
+    tile.setDevicePixelRatio (key.device_pixel_ratio);
+    tile.fill (Qt::transparent);
+
+    float64 x_start = key.tile_index * TILE_WIDTH_;
+    QPainter painter (&tile);
+    painter.translate (-x_start, key.parameters.height / 2.0f);
+    SignalRenderer_::drawSignal (&painter, channel_manager_, key.parameters,
+                                 x_start, x_start + width);
+    return tile;
+}
+
+//-----------------------------------------------------------------------------
+void SignalTileCache::removeTiles (ChannelID id)
+{
+    for (TileKey const& key : tiles_.keys ())
+        if (key.parameters.id == id)
+            tiles_.remove (key);
+    for (auto key = rendering_.begin (); key != rendering_.end ();)
+    {
+        if (key->parameters.id == id)
+            key = rendering_.erase (key);
+        else
+            ++key;
+    }
+}
+
+}
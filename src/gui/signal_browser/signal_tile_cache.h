@@ -0,0 +1,119 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef SIGNAL_TILE_CACHE_H
+#define SIGNAL_TILE_CACHE_H
+
+#include "signal_renderer.h"
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QThreadPool>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// SignalTileCache
+///
+/// pre-rendered strips ("tiles") of the signals of the channels, so scrolling
+/// and repainting only blits images instead of drawing the samples again
+///
+/// tiles are rendered into QImages on a thread pool; a tile belongs to one set
+/// of SignalRenderParameters, so changing the zoom, offset, height or color of
+/// a channel never shows outdated tiles
+class SignalTileCache : public QObject
+{
+    Q_OBJECT
+public:
+    //-------------------------------------------------------------------------
+    /// @param channel_manager must outlive the SignalTileCache
+    SignalTileCache (ChannelManager const& channel_manager);
+
+    //-------------------------------------------------------------------------
+    /// waits for tiles being rendered
+    virtual ~SignalTileCache ();
+
+    //-------------------------------------------------------------------------
+    /// @return the tile with the given index or a null image if it has not
+    ///         been rendered yet; missing tiles are rendered in the background
+    ///         and tileRendered is emitted when they are available
+    QImage getTile (SignalRenderParameters const& parameters, int32 tile_index,
+                    qreal device_pixel_ratio);
+
+    //-------------------------------------------------------------------------
+    /// renders all given tiles which are not cached yet in parallel and
+    /// returns when they are available
+    void renderTiles (QList<QPair<SignalRenderParameters, int32> > const& tiles,
+                      qreal device_pixel_ratio);
+
+    //-------------------------------------------------------------------------
+    /// @return true if the visible tiles of all channels are rendered in
+    ///         parallel before painting, so painting only composes them
+    bool isParallelRenderingEnabled () const {return parallel_rendering_;}
+
+    //-------------------------------------------------------------------------
+    static int32 const TILE_WIDTH_;
+
+public slots:
+    //-------------------------------------------------------------------------
+    /// drops all tiles of the given channel
+    void invalidate (ChannelID id);
+
+    //-------------------------------------------------------------------------
+    /// drops all tiles
+    void invalidateAll ();
+
+signals:
+    //-------------------------------------------------------------------------
+    /// emitted from the rendering threads; connections to objects of the GUI
+    /// thread are queued
+    void tileRendered (ChannelID id);
+
+private:
+    //-------------------------------------------------------------------------
+    struct TileKey
+    {
+        SignalRenderParameters parameters;
+        int32 tile_index;
+        qreal device_pixel_ratio;
+
+        bool operator== (TileKey const& other) const
+        {
+            return tile_index == other.tile_index &&
+                   device_pixel_ratio == other.device_pixel_ratio &&
+                   parameters == other.parameters;
+        }
+    };
+
+    friend size_t qHash (TileKey const& key, size_t seed);
+
+    //-------------------------------------------------------------------------
+    /// renders a tile on the calling thread
+    QImage renderTile (TileKey const& key) const;
+
+    //-------------------------------------------------------------------------
+    void removeTiles (ChannelID id);
+
+    static int const DEFAULT_CACHE_SIZE_IN_MB_;
+
+    ChannelManager const& channel_manager_;
+    bool parallel_rendering_;
+    QThreadPool pool_;
+    QMutex mutex_;
+    QCache<TileKey, QImage> tiles_;
+    QSet<TileKey> rendering_;
+    QHash<ChannelID, SignalRenderParameters> current_parameters_;
+};
+
+}
+
+#endif // SIGNAL_TILE_CACHE_H
@@ -106,6 +106,10 @@ public slots:
     //-------------------------------------------------------------------------
     virtual void update () {}
 
+    //-------------------------------------------------------------------------
+    /// redraws the signals, e.g. after further samples have been decoded
+    virtual void updateSignals () {update ();}
+
     //-------------------------------------------------------------------------
     void setActualEventCreationType (EventType type);
 
@@ -0,0 +1,215 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#include "event_epochs.h"
+#include "base/fixed_data_block.h"
+
+#include "signal_processing/FFTReal.h"
+
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+namespace sigviewer
+{
+
+// 64 bytes, the size of a cache line and of the widest vector registers
+size_t const EventEpochs::ALIGNMENT_IN_FLOATS_ = 16;
+size_t const EventEpochs::MAX_SPAN_LENGTH_ = 1 << 20;
+
+//-----------------------------------------------------------------------------
+EventEpochs::EventEpochs (ChannelManager const& channel_manager, std::vector<ChannelID> const& channels,
+                          std::vector<size_t> const& starts, size_t number_samples)
+    : sample_rate_ (channel_manager.getSampleRate ()),
+      number_epochs_ (starts.size ()),
+      number_channels_ (channels.size ()),
+      number_samples_ (number_samples),
+      row_stride_ ((number_samples + ALIGNMENT_IN_FLOATS_ - 1) / ALIGNMENT_IN_FLOATS_ * ALIGNMENT_IN_FLOATS_),
+      data_ (0)
+{
+    storage_.resize (number_epochs_ * number_channels_ * row_stride_ + ALIGNMENT_IN_FLOATS_);
+    void* aligned = storage_.data ();
+    size_t space = storage_.size () * sizeof (float32);
+    data_ = static_cast<float32*> (std::align (ALIGNMENT_IN_FLOATS_ * sizeof (float32), sizeof (float32),
+                                               aligned, space));
+
+    // neighbouring epochs are read as one span, so every channel needs only
+    // a few data blocks
+    std::vector<size_t> order (number_epochs_);
+    std::iota (order.begin (), order.end (), 0);
+    std::sort (order.begin (), order.end (), [&starts] (size_t epoch, size_t other)
+    {
+        return starts[epoch] < starts[other];
+    });
+    struct Span
+    {
+        size_t begin;
+        size_t end;
+        size_t first_epoch;     // index into order
+        size_t end_epoch;
+    };
+    std::vector<Span> spans;
+    for (size_t index = 0; index < order.size (); index++)
+    {
+        size_t start = starts[order[index]];
+        if (spans.empty () || start + number_samples_ - spans.back ().begin > MAX_SPAN_LENGTH_)
+            spans.push_back ({start, start, index, index});
+        spans.back ().end = std::max (spans.back ().end, start + number_samples_);
+        spans.back ().end_epoch = index + 1;
+    }
+
+    forEachChannel ([&] (size_t channel_index)
+    {
+        for (Span const& span : spans)
+        {
+            QSharedPointer<DataBlock const> data;
+            if (number_samples_ > 0 && span.end <= channel_manager.getNumberSamples ())
+                data = channel_manager.getData (channels[channel_index], span.begin, span.end - span.begin);
+
+            for (size_t index = span.first_epoch; index < span.end_epoch; index++)
+            {
+                float32* row = getRow (order[index], channel_index);
+                if (data.isNull ())
+                    std::fill (row, row + number_samples_, NAN);
+                else
+                    data->copyTo (starts[order[index]] - span.begin, number_samples_, row);
+            }
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+float32 const* EventEpochs::getSamples (size_t epoch, size_t channel_index) const
+{
+    return data_ + (epoch * number_channels_ + channel_index) * row_stride_;
+}
+
+//-----------------------------------------------------------------------------
+void EventEpochs::calculateMeanAndStandardDeviation (QVector<QSharedPointer<DataBlock> >& means,
+                                                     QVector<QSharedPointer<DataBlock> >& standard_deviations) const
+{
+    means.fill (QSharedPointer<DataBlock> (), number_channels_);
+    standard_deviations.fill (QSharedPointer<DataBlock> (), number_channels_);
+    if (number_epochs_ == 0)
+        return;
+
+    forEachChannel ([&] (size_t channel_index)
+    {
+        std::vector<float64> sums (number_samples_, 0);
+        for (size_t epoch = 0; epoch < number_epochs_; epoch++)
+        {
+            float32 const* row = getSamples (epoch, channel_index);
+            for (size_t sample = 0; sample < number_samples_; sample++)
+                sums[sample] += row[sample];
+        }
+        QSharedPointer<QVector<float32> > mean (new QVector<float32> (number_samples_));
+        for (size_t sample = 0; sample < number_samples_; sample++)
+            (*mean)[sample] = sums[sample] / number_epochs_;
+
+        float32 const* mean_row = mean->constData ();
+        std::fill (sums.begin (), sums.end (), 0);
+        for (size_t epoch = 0; epoch < number_epochs_; epoch++)
+        {
+            float32 const* row = getSamples (epoch, channel_index);
+            for (size_t sample = 0; sample < number_samples_; sample++)
+            {
+                float64 deviation = row[sample] - mean_row[sample];
+                sums[sample] += deviation * deviation;
+            }
+        }
+        QSharedPointer<QVector<float32> > standard_deviation (new QVector<float32> (number_samples_));
+        for (size_t sample = 0; sample < number_samples_; sample++)
+            (*standard_deviation)[sample] = std::sqrt (sums[sample] / number_epochs_);
+
+        means[channel_index] = QSharedPointer<DataBlock> (new FixedDataBlock (mean, sample_rate_));
+        standard_deviations[channel_index] = QSharedPointer<DataBlock> (new FixedDataBlock (standard_deviation, sample_rate_));
+    });
+}
+
+//-----------------------------------------------------------------------------
+QVector<QSharedPointer<DataBlock> > EventEpochs::calculateMeanPowerSpectra () const
+{
+    QVector<QSharedPointer<DataBlock> > spectra (number_channels_);
+    if (number_epochs_ == 0 || number_samples_ == 0)
+        return spectra;
+
+    size_t fft_samples = 1;
+    while (fft_samples < number_samples_)
+        fft_samples *= 2;
+
+    // triangular window centered in the padded input, as in
+    // FixedDataBlock::createPowerSpectrum
+    size_t padding = (fft_samples - number_samples_) / 2;
+    std::vector<FFTReal::flt_t> window (fft_samples, 0);
+    float64 factor = 0;
+    for (size_t x = padding; x < std::min (fft_samples, padding + number_samples_); x++)
+    {
+        if (x * 2 < fft_samples)
+            factor += (2.0 / number_samples_);
+        else
+            factor -= (2.0 / number_samples_);
+        window[x] = factor;
+    }
+
+    forEachChannel ([&] (size_t channel_index)
+    {
+        FFTReal fft (fft_samples);
+        std::vector<FFTReal::flt_t> in (fft_samples, 0);
+        std::vector<FFTReal::flt_t> out (fft_samples);
+        std::vector<float64> sums (fft_samples / 2, 0);
+        for (size_t epoch = 0; epoch < number_epochs_; epoch++)
+        {
+            float32 const* row = getSamples (epoch, channel_index);
+            for (size_t sample = 0; sample < number_samples_; sample++)
+                in[padding + sample] = row[sample] * window[padding + sample];
+            fft.do_fft (out.data (), in.data ());
+            fft.rescale (out.data ());
+            for (size_t index = 0; index < fft_samples / 2; index++)
+            {
+                float64 real = out[index];
+                float64 imaginary = out[fft_samples / 2 + index];
+                sums[index] += std::log10 (real * real + imaginary * imaginary);
+            }
+        }
+
+        QSharedPointer<QVector<float32> > spectrum (new QVector<float32> (fft_samples / 2));
+        for (size_t index = 0; index < fft_samples / 2; index++)
+            (*spectrum)[index] = sums[index] / number_epochs_;
+        spectra[channel_index] = QSharedPointer<DataBlock> (
+                new FixedDataBlock (spectrum, static_cast<float64>(fft_samples) / sample_rate_));
+    });
+    return spectra;
+}
+
+//-----------------------------------------------------------------------------
+void EventEpochs::forEachChannel (std::function<void (size_t)> const& function) const
+{
+    // the first channel is handled on the calling thread, as readers may
+    // buffer data and report progress on the first access
+    QSemaphore finished_channels;
+    for (size_t channel_index = 1; channel_index < number_channels_; channel_index++)
+    {
+        QThreadPool::globalInstance ()->start ([&function, &finished_channels, channel_index] ()
+        {
+            function (channel_index);
+            finished_channels.release ();
+        });
+    }
+    if (number_channels_ > 0)
+        function (0);
+    finished_channels.acquire (static_cast<int>(std::max<size_t> (number_channels_, 1) - 1));
+}
+
+//-----------------------------------------------------------------------------
+float32* EventEpochs::getRow (size_t epoch, size_t channel_index)
+{
+    return data_ + (epoch * number_channels_ + channel_index) * row_stride_;
+}
+
+}
@@ -0,0 +1,90 @@
+// © SigViewer developers
+//
+// License: GPL-3.0
+
+
+#ifndef EVENT_EPOCHS_H
+#define EVENT_EPOCHS_H
+
+#include "base/data_block.h"
+#include "file_handling/channel_manager.h"
+
+#include <QSharedPointer>
+#include <QVector>
+
+#include <functional>
+#include <vector>
+
+namespace sigviewer
+{
+
+//-----------------------------------------------------------------------------
+/// EventEpochs
+///
+/// the signal windows of some channels around events ("epochs"), gathered
+/// into one contiguous [epoch][channel][sample] array; every window starts
+/// at a 64 byte boundary, so averaging over the epochs runs over plain
+/// aligned rows
+///
+/// the channels are gathered and reduced in parallel
+class EventEpochs
+{
+public:
+    //-------------------------------------------------------------------------
+    /// @param starts first sample of every epoch; windows which do not lie
+    ///               completely within the signal are filled with NAN
+    /// @param number_samples length of every epoch
+    EventEpochs (ChannelManager const& channel_manager, std::vector<ChannelID> const& channels,
+                 std::vector<size_t> const& starts, size_t number_samples);
+
+    //-------------------------------------------------------------------------
+    size_t getNumberEpochs () const {return number_epochs_;}
+
+    //-------------------------------------------------------------------------
+    size_t getNumberChannels () const {return number_channels_;}
+
+    //-------------------------------------------------------------------------
+    size_t getNumberSamples () const {return number_samples_;}
+
+    //-------------------------------------------------------------------------
+    /// @param channel_index index of the channel in the channels given to
+    ///                      the constructor
+    float32 const* getSamples (size_t epoch, size_t channel_index) const;
+
+    //-------------------------------------------------------------------------
+    /// mean and standard deviation of every sample over all epochs, one block
+    /// per channel index
+    void calculateMeanAndStandardDeviation (QVector<QSharedPointer<DataBlock> >& means,
+                                            QVector<QSharedPointer<DataBlock> >& standard_deviations) const;
+
+    //-------------------------------------------------------------------------
+    /// mean of the logarithmic power spectra of all epochs, one block per
+    /// channel index; the epochs are padded to a power of 2
+    QVector<QSharedPointer<DataBlock> > calculateMeanPowerSpectra () const;
+
+private:
+    //-------------------------------------------------------------------------
+    /// calls the function for every channel index on the thread pool, the
+    /// first one on the calling thread, and waits for all of them
+    void forEachChannel (std::function<void (size_t)> const& function) const;
+
+    //-------------------------------------------------------------------------
+    float32* getRow (size_t epoch, size_t channel_index);
+
+    static size_t const ALIGNMENT_IN_FLOATS_;
+    static size_t const MAX_SPAN_LENGTH_;
+
+    float64 sample_rate_;
+    size_t number_epochs_;
+    size_t number_channels_;
+    size_t number_samples_;
+    size_t row_stride_;
+    std::vector<float32> storage_;
+    float32* data_;
+
+    Q_DISABLE_COPY (EventEpochs);
+};
+
+}
+
+#endif // EVENT_EPOCHS_H
@@ -3,13 +3,44 @@
 // License: GPL-3.0
 
 #include "base/fixed_data_block.h"
+#include "base/mapped_data_block.h"
+#include "base/native_rate_data_block.h"
+#include "base/sparse_data_block.h"
 #include "base/sigviewer_user_types.h"
+#include "file_handling/channel_manager.h"
+#include "signal_processing/event_epochs.h"
 
+#include <QtEndian>
+#include <QTemporaryFile>
 #include <QtTest>
 #include <cmath>
 
 using namespace sigviewer;
 
+// channel c holds sin(0.1 * (c + 1) * sample) + sample / 1000
+class SineChannelManager : public ChannelManager
+{
+public:
+    std::set<ChannelID> getChannels() const override { return {0, 1, 2}; }
+    uint32 getNumberChannels() const override { return 3; }
+    QString getChannelLabel(ChannelID id) const override { return QString::number(id); }
+    QString getChannelLabel(ChannelID id, int) const override { return QString::number(id); }
+    QString getChannelYUnitString(ChannelID) const override { return "uV"; }
+    float64 getDurationInSec() const override { return getNumberSamples() / getSampleRate(); }
+    size_t getNumberSamples() const override { return 5000; }
+    float64 getSampleRate() const override { return 100; }
+
+    QSharedPointer<DataBlock const> getData(ChannelID id, unsigned start_pos, unsigned length) const override
+    {
+        if (start_pos + length > getNumberSamples())
+            return QSharedPointer<DataBlock const>();
+        QSharedPointer<QVector<float32>> data(new QVector<float32>);
+        for (unsigned sample = start_pos; sample < start_pos + length; sample++)
+            data->push_back(std::sin(0.1 * (id + 1) * sample) + sample / 1000.0);
+        return QSharedPointer<DataBlock const>(new FixedDataBlock(data, getSampleRate()));
+    }
+};
+
 class TestDataBlock : public QObject
 {
     Q_OBJECT
@@ -29,6 +60,202 @@ private slots:
             QCOMPARE(block[i], static_cast<float32>(i + 1));
     }
 
+    void subBlockMinMax()
+    {
+        QSharedPointer<QVector<float32>> data(new QVector<float32>);
+        for (unsigned i = 1; i <= 40; i++)
+            data->push_back(i);
+        (*data)[20] = NAN;
+        (*data)[21] = 1000;
+
+        FixedDataBlock block(data, 10);
+        QSharedPointer<DataBlock> sub_block = block.createSubBlock(10, 10);
+        QCOMPARE(sub_block->getMin(), 11.0f);
+        QCOMPARE(sub_block->getMax(), 20.0f);
+
+        float32 copied[3];
+        sub_block->copyTo(2, 3, copied);
+        QCOMPARE(copied[0], 13.0f);
+        QCOMPARE(copied[2], 15.0f);
+
+        // sub-blocks of sub-blocks start relative to their base
+        QSharedPointer<DataBlock> nested_block = sub_block->createSubBlock(5, 4);
+        QCOMPARE((*nested_block)[0], 16.0f);
+        QCOMPARE(nested_block->getMin(), 16.0f);
+        QCOMPARE(nested_block->getMax(), 19.0f);
+        nested_block->copyTo(1, 2, copied);
+        QCOMPARE(copied[0], 17.0f);
+        QCOMPARE(copied[1], 18.0f);
+
+        // NANs are skipped and only the range of the block is considered
+        float32 min = 0;
+        float32 max = 0;
+        QVERIFY(block.getMinMax(20, 3, min, max));
+        QCOMPARE(min, 23.0f);
+        QCOMPARE(max, 1000.0f);
+        QVERIFY(!block.getMinMax(20, 1, min, max));
+        QCOMPARE(min, 23.0f);
+        QCOMPARE(max, 1000.0f);
+
+        QSharedPointer<QVector<float32>> nans(new QVector<float32>(20, NAN));
+        FixedDataBlock nan_block(nans, 10);
+        QCOMPARE(nan_block.getMin(), 0.0f);
+        QCOMPARE(nan_block.getMax(), 0.0f);
+    }
+
+    void mappedBlock()
+    {
+        // 8 header bytes followed by 3 records of 4 int16 samples of each of 2 channels
+        QByteArray content(8, 'x');
+        for (int record = 0; record < 3; record++)
+            for (int channel = 0; channel < 2; channel++)
+                for (int sample = 0; sample < 4; sample++) {
+                    qint16 value = qToLittleEndian<qint16>((channel + 1) * 100 + record * 4 + sample);
+                    content.append(reinterpret_cast<char const*>(&value), sizeof(value));
+                }
+        qint16 overflow = qToLittleEndian<qint16>(32767);
+        content.replace(8 + 8 + 2, 2, reinterpret_cast<char const*>(&overflow), sizeof(overflow));
+
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        file.write(content);
+        file.flush();
+
+        QSharedPointer<MappedFile const> mapped_file(new MappedFile(file.fileName()));
+        QVERIFY(mapped_file->data());
+
+        MappedChannelLayout layout;
+        layout.first_sample_position = 8 + 8;
+        layout.record_size = 16;
+        layout.samples_per_record = 4;
+        layout.format = MappedChannelLayout::INT16;
+        layout.scale = 0.5;
+        layout.offset = 1;
+        layout.overflow_detection = true;
+        layout.digital_min = -32768;
+        layout.digital_max = 32767;
+
+        MappedDataBlock block(mapped_file, layout, 12, 10);
+        QCOMPARE(block.size(), 12u);
+        QCOMPARE(block[0], 101.0f);
+        QVERIFY(std::isnan(block[1]));
+        for (unsigned i = 2; i < 12; i++)
+            QCOMPARE(block[i], (200 + i) * 0.5f + 1);
+        QCOMPARE(block.getMin(), 101.0f);
+        QCOMPARE(block.getMax(), 106.5f);
+
+        // sub blocks span record boundaries
+        QSharedPointer<DataBlock> sub_block = block.createSubBlock(3, 6);
+        QCOMPARE((*sub_block)[0], 102.5f);
+        float32 min = 0;
+        float32 max = 0;
+        QVERIFY(sub_block->getMinMax(1, 4, min, max));
+        QCOMPARE(min, 103.0f);
+        QCOMPARE(max, 104.5f);
+
+        float32 copied[6];
+        sub_block->copyTo(0, 6, copied);
+        for (unsigned i = 0; i < 6; i++)
+            QCOMPARE(copied[i], (*sub_block)[i]);
+    }
+
+    void sparseBlock()
+    {
+        // samples 10..14 and 30..32 of 50 are covered
+        std::vector<SparseExtent> extents;
+        extents.push_back({10, {1, 2, NAN, 4, 5}});
+        extents.push_back({30, {-3, 7, 6}});
+        SparseDataBlock block(std::move(extents), 50, 10);
+        QCOMPARE(block.size(), size_t(50));
+        QVERIFY(std::isnan(block[0]));
+        QVERIFY(std::isnan(block[12]));
+        QVERIFY(std::isnan(block[15]));
+        QCOMPARE(block[13], 4.0f);
+        QCOMPARE(block[31], 7.0f);
+        QCOMPARE(block.getMin(), -3.0f);
+        QCOMPARE(block.getMax(), 7.0f);
+
+        float32 min = 0;
+        float32 max = 0;
+        QVERIFY(!block.getMinMax(15, 15, min, max));
+        QVERIFY(block.getMinMax(13, 20, min, max));
+        QCOMPARE(min, -3.0f);
+        QCOMPARE(max, 7.0f);
+
+        std::vector<DataBlock::Range> ranges = block.getCoveredRanges(12, 20);
+        QCOMPARE(ranges.size(), size_t(2));
+        QCOMPARE(ranges[0].begin, size_t(12));
+        QCOMPARE(ranges[0].end, size_t(15));
+        QCOMPARE(ranges[1].begin, size_t(30));
+        QCOMPARE(ranges[1].end, size_t(32));
+
+        // sub blocks count from their own start
+        QSharedPointer<DataBlock> sub_block = block.createSubBlock(14, 20);
+        QCOMPARE((*sub_block)[0], 5.0f);
+        QCOMPARE((*sub_block)[17], 7.0f);
+        ranges = sub_block->getCoveredRanges(0, sub_block->size());
+        QCOMPARE(ranges.size(), size_t(2));
+        QCOMPARE(ranges[0].begin, size_t(0));
+        QCOMPARE(ranges[0].end, size_t(1));
+        QCOMPARE(ranges[1].begin, size_t(16));
+        QCOMPARE(ranges[1].end, size_t(19));
+
+        float32 copied[20];
+        sub_block->copyTo(0, 20, copied);
+        for (size_t index = 0; index < 20; index++)
+            QCOMPARE(std::isnan(copied[index]), std::isnan((*sub_block)[index]));
+        QCOMPARE(copied[0], 5.0f);
+        QCOMPARE(copied[18], 6.0f);
+
+        // dense blocks are covered completely
+        QSharedPointer<QVector<float32>> data(new QVector<float32>(8, 1));
+        ranges = FixedDataBlock(data, 10).getCoveredRanges(2, 4);
+        QCOMPARE(ranges.size(), size_t(1));
+        QCOMPARE(ranges[0].begin, size_t(2));
+        QCOMPARE(ranges[0].end, size_t(6));
+    }
+
+    void nativeRateBlock()
+    {
+        // 4 samples at 5 Hz starting at sample 2 of a 10 Hz block of 12 samples
+        NativeRateDataBlock slow({0, 2, -4, 6}, 5, 2, 12, 10);
+        QCOMPARE(slow.getNativeSampleRatePerUnit(), 5.0);
+        QVERIFY(std::isnan(slow[1]));
+        QCOMPARE(slow[2], 0.0f);
+        QCOMPARE(slow[3], 1.0f);
+        QCOMPARE(slow[6], -4.0f);
+        QCOMPARE(slow[7], 1.0f);
+        QCOMPARE(slow[8], 6.0f);
+        QVERIFY(std::isnan(slow[9]));
+
+        std::vector<DataBlock::Range> ranges = slow.getCoveredRanges(0, 12);
+        QCOMPARE(ranges.size(), size_t(1));
+        QCOMPARE(ranges[0].begin, size_t(2));
+        QCOMPARE(ranges[0].end, size_t(9));
+
+        QSharedPointer<DataBlock> sub_block = slow.createSubBlock(3, 4);
+        float32 copied[4];
+        sub_block->copyTo(0, 4, copied);
+        QCOMPARE(copied[0], 1.0f);
+        QCOMPARE(copied[3], -4.0f);
+
+        // the peaks between the samples of the block are found as well
+        NativeRateDataBlock fast({1, 9, 2, -7, 3, 0, 5}, 30, 0, 3, 10);
+        QCOMPARE(fast.size(), size_t(3));
+        QCOMPARE(fast[1], -7.0f);
+        float32 min = 0;
+        float32 max = 0;
+        QVERIFY(fast.getMinMax(0, 2, min, max));
+        QCOMPARE(min, -7.0f);
+        QCOMPARE(max, 9.0f);
+        QVERIFY(fast.getMinMax(1, 2, min, max));
+        QCOMPARE(min, -7.0f);
+        QCOMPARE(max, 5.0f);
+        QVERIFY(fast.getMinMax(2, 1, min, max));
+        QCOMPARE(min, 5.0f);
+        QCOMPARE(max, 5.0f);
+    }
+
     void mean()
     {
         QSharedPointer<QVector<float32>> data(new QVector<float32>);
@@ -87,6 +314,49 @@ private slots:
             QCOMPARE((*stdDevMixed)[x], expected);
         }
     }
+
+    void eventEpochs()
+    {
+        SineChannelManager channel_manager;
+        std::vector<ChannelID> channels = {2, 0};
+        std::vector<size_t> starts = {1000, 10, 3001, 250};
+        size_t const number_samples = 128;
+
+        EventEpochs epochs(channel_manager, channels, starts, number_samples);
+        QCOMPARE(epochs.getNumberEpochs(), starts.size());
+        QCOMPARE(epochs.getNumberChannels(), channels.size());
+        QVERIFY(reinterpret_cast<quintptr>(epochs.getSamples(1, 1)) % 64 == 0);
+
+        QVector<QSharedPointer<DataBlock>> means;
+        QVector<QSharedPointer<DataBlock>> standard_deviations;
+        epochs.calculateMeanAndStandardDeviation(means, standard_deviations);
+        QVector<QSharedPointer<DataBlock>> spectra = epochs.calculateMeanPowerSpectra();
+
+        // the same as averaging the data blocks of every epoch
+        for (size_t index = 0; index < channels.size(); index++) {
+            std::list<QSharedPointer<DataBlock const>> blocks;
+            std::list<QSharedPointer<DataBlock const>> block_spectra;
+            for (size_t epoch = 0; epoch < starts.size(); epoch++) {
+                QSharedPointer<DataBlock const> block = channel_manager.getData(channels[index], starts[epoch],
+                                                                                number_samples);
+                QCOMPARE(epochs.getSamples(epoch, index)[17], (*block)[17]);
+                blocks.push_back(block);
+                block_spectra.push_back(FixedDataBlock::createPowerSpectrum(block));
+            }
+            auto mean = FixedDataBlock::calculateMean(blocks);
+            auto standard_deviation = FixedDataBlock::calculateStandardDeviation(blocks, mean);
+            auto spectrum = FixedDataBlock::calculateMean(block_spectra);
+            QCOMPARE(means[index]->size(), mean->size());
+            QCOMPARE(spectra[index]->size(), spectrum->size());
+            QCOMPARE(spectra[index]->getSampleRatePerUnit(), spectrum->getSampleRatePerUnit());
+            for (size_t x = 0; x < number_samples; x++) {
+                QVERIFY(std::abs((*means[index])[x] - (*mean)[x]) < 1e-5);
+                QVERIFY(std::abs((*standard_deviations[index])[x] - (*standard_deviation)[x]) < 1e-5);
+            }
+            for (size_t x = 0; x < spectrum->size(); x++)
+                QVERIFY(std::abs((*spectra[index])[x] - (*spectrum)[x]) < 1e-3);
+        }
+    }
 };
 
 QTEST_GUILESS_MAIN(TestDataBlock)
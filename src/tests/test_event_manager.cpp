@@ -52,6 +52,155 @@ private slots:
         QCOMPARE(event->getPosition(), 10u);
         QCOMPARE(event->getType(), EventType(1));
     }
+
+    void eventsAt()
+    {
+        // mock event 3 lies at [768, 896] on channel 3
+        QVERIFY(mgr_->getEventsAt(800, 3) == std::set<EventID>({3}));
+        QVERIFY(mgr_->getEventsAt(800, 2).empty());
+        QVERIFY(mgr_->getEventsAt(896, 3) == std::set<EventID>({3}));
+        QVERIFY(mgr_->getEventsAt(897, 3).empty());
+
+        auto all_channels = mgr_->createEvent(UNDEFINED_CHANNEL, 790, 20, 1, UNDEFINED_STREAM_ID);
+        QVERIFY(mgr_->getEventsAt(800, 3) == std::set<EventID>({3, all_channels->getId()}));
+        QVERIFY(mgr_->getEventsAt(800, 2) == std::set<EventID>({all_channels->getId()}));
+
+        mgr_->removeEvent(all_channels->getId());
+        QVERIFY(mgr_->getEventsAt(800, 2) == std::set<EventID>());
+
+        QSharedPointer<SignalEvent> moved = mgr_->getAndLockEventForEditing(3);
+        moved->setPosition(5000);
+        mgr_->updateAndUnlockEvent(3);
+        QVERIFY(mgr_->getEventsAt(800, 3).empty());
+        QVERIFY(mgr_->getEventsAt(5100, 3) == std::set<EventID>({3}));
+    }
+
+    void eventsInRange()
+    {
+        QCOMPARE(mgr_->getEventsInRange(0, 10), QList<EventID>({0}));
+        QCOMPARE(mgr_->getEventsInRange(300, 600), QList<EventID>({1, 2}));
+        QVERIFY(mgr_->getEventsInRange(129, 255).isEmpty());
+        QCOMPARE(static_cast<int>(mgr_->getEventsInRange(0, MOCK_NUM_SAMPLES).size()), MOCK_NUM_EVENTS);
+    }
+
+    void eventsOfSameType()
+    {
+        // every fifth mock event has the type 1
+        QCOMPARE(mgr_->getEvents(1), QList<EventID>({0, 5, 10, 15, 20, 25, 30, 35, 40}));
+        QCOMPARE(mgr_->getNextEventOfSameType(0), EventID(5));
+        QCOMPARE(mgr_->getPreviousEventOfSameType(5), EventID(0));
+        QCOMPARE(mgr_->getPreviousEventOfSameType(0), UNDEFINED_EVENT_ID);
+        QCOMPARE(mgr_->getNextEventOfSameType(40), UNDEFINED_EVENT_ID);
+
+        QSharedPointer<SignalEvent> moved = mgr_->getAndLockEventForEditing(40);
+        moved->setPosition(0);
+        mgr_->updateAndUnlockEvent(40);
+        QCOMPARE(mgr_->getNextEventOfSameType(0), EventID(40));
+        QCOMPARE(mgr_->getPreviousEventOfSameType(0), UNDEFINED_EVENT_ID);
+
+        QSharedPointer<SignalEvent> retyped = mgr_->getAndLockEventForEditing(10);
+        retyped->setType(2);
+        mgr_->updateAndUnlockEvent(10);
+        QCOMPARE(mgr_->getEvents(1), QList<EventID>({0, 40, 5, 15, 20, 25, 30, 35}));
+        QCOMPARE(mgr_->getNextEventOfSameType(5), EventID(15));
+    }
+
+    void stableIds()
+    {
+        mgr_->removeEvent(7);
+        QVERIFY(mgr_->getEvent(7).isNull());
+        QCOMPARE(mgr_->getNumberOfEvents(), unsigned(MOCK_NUM_EVENTS - 1));
+
+        // ids of removed events are not handed out again...
+        auto created = mgr_->createEvent(2, 100, 10, 3, UNDEFINED_STREAM_ID);
+        QCOMPARE(created->getId(), EventID(MOCK_NUM_EVENTS));
+
+        // ...but can be restored, e.g. by undoing the removal
+        auto restored = mgr_->createEvent(7, 1792, 128, 3, UNDEFINED_STREAM_ID, 7);
+        QCOMPARE(restored->getId(), EventID(7));
+        QVERIFY(mgr_->createEvent(7, 0, 1, 3, UNDEFINED_STREAM_ID, 7).isNull());
+
+        SignalEvent event;
+        QVERIFY(mgr_->getEvent(7, event));
+        QCOMPARE(event.getPosition(), size_t(1792));
+        QCOMPARE(event.getChannel(), ChannelID(7));
+
+        size_t number_events = 0;
+        mgr_->readEvents([&number_events](EventStore const& store) { number_events = store.size(); });
+        QCOMPARE(number_events, size_t(MOCK_NUM_EVENTS + 1));
+    }
+
+    void editedCopyIsAppliedOnUpdate()
+    {
+        QSharedPointer<SignalEvent> edited = mgr_->getAndLockEventForEditing(2);
+        edited->setDuration(1000);
+        QCOMPARE(mgr_->getEvent(2)->getDuration(), size_t(128));
+        mgr_->updateAndUnlockEvent(2);
+        QCOMPARE(mgr_->getEvent(2)->getDuration(), size_t(1000));
+    }
+
+    void batchIsReportedOnce()
+    {
+        int created = 0;
+        connect(mgr_.data(), &EventManager::eventCreated,
+                [&created](QSharedPointer<SignalEvent const>) { created++; });
+        QSignalSpy removed(mgr_.data(), SIGNAL(eventRemoved(EventID)));
+        QSignalSpy changed(mgr_.data(), SIGNAL(changed()));
+        QList<EventChanges> batches;
+        connect(mgr_.data(), &EventManager::eventsChanged,
+                [&batches](EventChanges const& changes) { batches.append(changes); });
+
+        mgr_->beginBatch();
+        mgr_->beginBatch();
+        EventID kept = mgr_->createEvent(1, 100, 10, 1, UNDEFINED_STREAM_ID)->getId();
+        EventID dropped = mgr_->createEvent(1, 200, 10, 1, UNDEFINED_STREAM_ID)->getId();
+        mgr_->removeEvent(dropped);
+        mgr_->removeEvent(3);
+        QCOMPARE(mgr_->getEventsAt(105, 1).count(kept), size_t(1));
+        QVERIFY(mgr_->getEventsAt(800, 3).empty());
+        mgr_->getAndLockEventForEditing(4)->setDuration(10);
+        mgr_->updateAndUnlockEvent(4);
+        mgr_->commitBatch();
+        QCOMPARE(batches.size(), 0);
+        mgr_->commitBatch();
+
+        QCOMPARE(created, 0);
+        QCOMPARE(removed.count(), 0);
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(batches.size(), 1);
+        QCOMPARE(batches[0].created, QList<EventID>() << kept);
+        QCOMPARE(batches[0].removed, QList<EventID>() << 3);
+        QCOMPARE(batches[0].changed, QList<EventID>() << 4);
+        QCOMPARE(mgr_->getEventsAt(105, 1).count(kept), size_t(1));
+    }
+
+    void bulkAddAndRemove()
+    {
+        QList<EventChanges> batches;
+        connect(mgr_.data(), &EventManager::eventsChanged,
+                [&batches](EventChanges const& changes) { batches.append(changes); });
+
+        EventColumns events;
+        events.append(800, 10, 1, 3);
+        events.append(10, 0, 1, UNDEFINED_CHANNEL);
+        QList<EventID> ids = mgr_->addEvents(events);
+        QCOMPARE(ids, QList<EventID>({MOCK_NUM_EVENTS, MOCK_NUM_EVENTS + 1}));
+        QCOMPARE(batches.size(), 1);
+        QCOMPARE(batches[0].created, ids);
+        QVERIFY(mgr_->getEventsAt(805, 3) == std::set<EventID>({3, ids[0]}));
+        QCOMPARE(mgr_->getEvents(1).mid(0, 4), QList<EventID>({0, ids[1], ids[0], 5}));
+        QCOMPARE(mgr_->getNextEventOfSameType(ids[0]), EventID(5));
+
+        mgr_->removeEvents(QList<EventID>() << ids << 3);
+        QCOMPARE(batches.size(), 2);
+        QCOMPARE(batches[1].removed, QList<EventID>({3, ids[0], ids[1]}));
+        QVERIFY(mgr_->getEventsAt(805, 3).empty());
+        QCOMPARE(mgr_->getNumberOfEvents(), unsigned(MOCK_NUM_EVENTS - 1));
+
+        // restoring the ids, e.g. by redoing an import
+        QCOMPARE(mgr_->addEvents(events, ids), ids);
+        QCOMPARE(mgr_->getEvent(ids[1])->getPosition(), size_t(10));
+    }
 };
 
 int main(int argc, char* argv[])
@@ -10,7 +10,6 @@
 #include "mock_file_signal_reader.h"
 
 #include <QApplication>
-#include <QTableWidget>
 #include <QtTest>
 
 using namespace sigviewer;
@@ -43,7 +42,9 @@ private slots:
         auto mgr = makeEventManager();
         QScopedPointer<FileChannelManager> cm(makeChannelManager());
         EventTableWidget w(QSharedPointer<TabContext>(new TabContext()), mgr, *cm);
-        QCOMPARE(w.ui_.event_table_->rowCount(),
+        QCOMPARE(w.event_table_model_->rowCount(),
+                 static_cast<int>(mgr->getNumberOfEvents()));
+        QCOMPARE(w.ui_.event_table_->model()->rowCount(),
                  static_cast<int>(mgr->getNumberOfEvents()));
     }
 
@@ -52,22 +53,18 @@ private slots:
         auto mgr = makeEventManager();
         QScopedPointer<FileChannelManager> cm(makeChannelManager());
         EventTableWidget w(QSharedPointer<TabContext>(new TabContext()), mgr, *cm);
-        QTableWidget* table = w.ui_.event_table_;
+        EventTableModel* table = w.event_table_model_;
         int oldCount = table->rowCount();
 
         auto event = mgr->createEvent(1, 10, 12, 0x03, UNDEFINED_STREAM_ID);
         QCOMPARE(table->rowCount(), oldCount + 1);
 
-        bool found = false;
-        for (int row = 0; row < table->rowCount(); ++row) {
-            if (table->item(row, EventTableWidget::ID_INDEX_)->text()
-                    == QString::number(event->getId())) {
-                found = true;
-                QCOMPARE(table->item(row, EventTableWidget::CHANNEL_INDEX_)->text(),
-                         cm->getChannelLabel(1));
-            }
-        }
-        QVERIFY(found);
+        int row = table->getRow(event->getId());
+        QVERIFY(row >= 0);
+        QCOMPARE(table->data(table->index(row, EventTableModel::ID_INDEX_)).toInt(),
+                 event->getId());
+        QCOMPARE(table->data(table->index(row, EventTableModel::CHANNEL_INDEX_)).toString(),
+                 cm->getChannelLabel(1));
     }
 
     void deletedEventRemovedFromTable()
@@ -75,16 +72,17 @@ private slots:
         auto mgr = makeEventManager();
         QScopedPointer<FileChannelManager> cm(makeChannelManager());
         EventTableWidget w(QSharedPointer<TabContext>(new TabContext()), mgr, *cm);
-        QTableWidget* table = w.ui_.event_table_;
+        EventTableModel* table = w.event_table_model_;
         int oldCount = table->rowCount();
 
         const EventID removeId = 2;
         mgr->removeEvent(removeId);
         QCOMPARE(table->rowCount(), oldCount - 1);
+        QCOMPARE(table->getRow(removeId), -1);
 
         for (int row = 0; row < table->rowCount(); ++row)
-            QVERIFY(table->item(row, EventTableWidget::ID_INDEX_)->text()
-                    != QString::number(removeId));
+            QVERIFY(table->data(table->index(row, EventTableModel::ID_INDEX_)).toInt()
+                    != removeId);
     }
 
     void changedEventReflectedInTable()
@@ -92,7 +90,7 @@ private slots:
         auto mgr = makeEventManager();
         QScopedPointer<FileChannelManager> cm(makeChannelManager());
         EventTableWidget w(QSharedPointer<TabContext>(new TabContext()), mgr, *cm);
-        QTableWidget* table = w.ui_.event_table_;
+        EventTableModel* table = w.event_table_model_;
         int oldCount = table->rowCount();
 
         const EventID id      = 4;
@@ -106,14 +104,25 @@ private slots:
         }
 
         QCOMPARE(table->rowCount(), oldCount);
-        for (int row = 0; row < table->rowCount(); ++row) {
-            if (table->item(row, EventTableWidget::ID_INDEX_)->text().toInt() == id) {
-                QCOMPARE(table->item(row, EventTableWidget::TYPE_INDEX_)->text(),
-                         mgr->getNameOfEventType(newType));
-                QCOMPARE(table->item(row, EventTableWidget::CHANNEL_INDEX_)->text(),
-                         cm->getChannelLabel(newChannel));
-            }
-        }
+        int row = table->getRow(id);
+        QVERIFY(row >= 0);
+        QCOMPARE(table->data(table->index(row, EventTableModel::TYPE_INDEX_)).toString(),
+                 mgr->getNameOfEventType(newType));
+        QCOMPARE(table->data(table->index(row, EventTableModel::CHANNEL_INDEX_)).toString(),
+                 cm->getChannelLabel(newChannel));
+    }
+
+    void sortedByPosition()
+    {
+        auto mgr = makeEventManager();
+        QScopedPointer<FileChannelManager> cm(makeChannelManager());
+        EventTableWidget w(QSharedPointer<TabContext>(new TabContext()), mgr, *cm);
+        mgr->createEvent(1, 0, 12, 0x03, UNDEFINED_STREAM_ID);
+
+        QAbstractItemModel* sorted = w.ui_.event_table_->model();
+        for (int row = 1; row < sorted->rowCount(); ++row)
+            QVERIFY(sorted->index(row - 1, EventTableModel::POSITION_INDEX_).data(EventTableModel::SORT_ROLE_).toUInt()
+                    <= sorted->index(row, EventTableModel::POSITION_INDEX_).data(EventTableModel::SORT_ROLE_).toUInt());
     }
 };
 
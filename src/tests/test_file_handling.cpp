@@ -3,19 +3,62 @@
 // License: GPL-3.0
 
 #include "application_context.h"
+#include "base/fixed_data_block.h"
+#include "base/native_rate_data_block.h"
+#include "file_handling/csv_event_writer.h"
+#include "file_handling/decoded_cache.h"
+#include "file_handling/event_importer.h"
 #include "file_handling/file_signal_writer_factory.h"
 #include "file_handling/file_signal_reader_factory.h"
+#include "file_handling/xdf_chunk_reader.h"
+#include "file_handling/xdf_streaming_decoder.h"
 #include "gui/commands/open_file_gui_command.h"
 #include "gui/gui_action_factory.h"
 #include "gui/gui_action_factory_registrator.h"
+#include "gui/processed_signal_channel_manager.h"
 #include "mock_file_signal_reader.h"
 
 #include <QApplication>
+#include <QStandardPaths>
 #include <QTemporaryFile>
+#include <QtEndian>
 #include <QtTest>
 
+#include <cmath>
+
 using namespace sigviewer;
 
+// the two channels of the EEG stream of streamXdfChunks, decoded by a decoder
+// the test starts
+class StreamedChannelManager : public ChannelManager
+{
+public:
+    StreamedChannelManager(XdfStreamingDecoder const& decoder) : decoder_(decoder) {}
+    std::set<ChannelID> getChannels() const override { return {0, 1}; }
+    uint32 getNumberChannels() const override { return 2; }
+    QString getChannelLabel(ChannelID id) const override { return QString::number(id); }
+    QString getChannelLabel(ChannelID id, int) const override { return QString::number(id); }
+    QString getChannelYUnitString(ChannelID) const override { return "uV"; }
+    float64 getDurationInSec() const override { return getNumberSamples() / getSampleRate(); }
+    size_t getNumberSamples() const override { return 400; }
+    float64 getSampleRate() const override { return 100; }
+
+    QSharedPointer<DataBlock const> getData(ChannelID id, unsigned start_pos, unsigned length) const override
+    {
+        return decoder_.getChannel(id, start_pos, length, true)->createSubBlock(start_pos, length);
+    }
+
+    QSharedPointer<DataBlock const> getAvailableData(ChannelID id, unsigned start_pos, unsigned length) const override
+    {
+        return decoder_.getChannel(id, start_pos, length, false)->createSubBlock(start_pos, length);
+    }
+
+    bool waitUntilDecoded(int timeout_in_ms) const override { return decoder_.waitUntilDecoded(timeout_in_ms); }
+
+private:
+    XdfStreamingDecoder const& decoder_;
+};
+
 class TestFileHandling : public QObject
 {
     Q_OBJECT
@@ -23,6 +66,7 @@ class TestFileHandling : public QObject
 private slots:
     void initTestCase()
     {
+        QStandardPaths::setTestModeEnabled(true);
         ApplicationContext::init({});
     }
 
@@ -87,6 +131,276 @@ private slots:
             QVERIFY(found);
         }
     }
+
+    void exportEventsToCSV()
+    {
+        auto ctx = ApplicationContext::getInstance()->getCurrentFileContext();
+        QVERIFY(!ctx.isNull());
+        auto evtMgr = ctx->getEventManager();
+        // removed ids leave gaps, which must not hide events with higher ids
+        evtMgr->removeEvent(1);
+        evtMgr->createEvent(2, 5, 7, evtMgr->getEvent(0)->getType(), UNDEFINED_STREAM_ID);
+
+        QTemporaryFile f("XXXXXX.csv");
+        QVERIFY(f.open());
+        f.close();
+        CSVEventWriter writer(f.fileName());
+        QVERIFY(writer.saveEvents(evtMgr, evtMgr->getEventTypes()).isEmpty());
+
+        QVERIFY(f.open());
+        QList<QByteArray> lines = f.readAll().split('\n');
+        QCOMPARE(lines.takeFirst(), QByteArray("position,duration,channel,type,name"));
+        QCOMPARE(lines.takeLast(), QByteArray());
+        QCOMPARE(lines.size(), static_cast<int>(evtMgr->getNumberOfEvents()));
+        QCOMPARE(lines[1], QByteArray("5,7,2,") + QByteArray::number(evtMgr->getEvent(0)->getType()) +
+                           "," + evtMgr->getNameOfEventType(evtMgr->getEvent(0)->getType()).remove(',').toUtf8());
+        uint32 previous = 0;
+        for (QByteArray const& line : lines) {
+            uint32 position = line.left(line.indexOf(',')).toUInt();
+            QVERIFY(previous <= position);
+            previous = position;
+        }
+    }
+
+    void importEventsFromCSV()
+    {
+        auto ctx = ApplicationContext::getInstance()->getCurrentFileContext();
+        QVERIFY(!ctx.isNull());
+        auto evtMgr = ctx->getEventManager();
+
+        QTemporaryFile f("XXXXXX.csv");
+        QVERIFY(f.open());
+        f.close();
+        CSVEventWriter writer(f.fileName());
+        QVERIFY(writer.saveEvents(evtMgr, evtMgr->getEventTypes()).isEmpty());
+
+        EventColumns events;
+        size_t skipped_lines = 1;
+        QVERIFY(EventImporter::readEvents(f.fileName(), evtMgr->getSampleRate(), events, skipped_lines).isEmpty());
+        QCOMPARE(skipped_lines, size_t(0));
+        QCOMPARE(events.size(), size_t(evtMgr->getNumberOfEvents()));
+        EventID first = evtMgr->getEventsByPosition().first();
+        QCOMPARE(events.positions[0], uint32(evtMgr->getEvent(first)->getPosition()));
+        QCOMPARE(events.channels[0], evtMgr->getEvent(first)->getChannel());
+        QCOMPARE(events.types[0], evtMgr->getEvent(first)->getType());
+    }
+
+    void parseEventTable()
+    {
+        QByteArray tsv("position\tduration\tchannel\ttype\r\n"
+                       "100\t20\t-1\t3\r\n"
+                       "not\tan\tevent\n"
+                       "\n"
+                       "200\t0\t1\t4\textra");
+        EventColumns events;
+        QCOMPARE(EventImporter::parseTable(tsv.constData(), tsv.constData() + tsv.size(), events), size_t(1));
+        QCOMPARE(events.size(), size_t(2));
+        QCOMPARE(events.positions[1], uint32(200));
+        QCOMPARE(events.durations[0], uint32(20));
+        QCOMPARE(events.channels[0], UNDEFINED_CHANNEL);
+        QCOMPARE(events.types[1], EventType(4));
+
+        QByteArray semicolons("1;2;0;5\n");
+        QCOMPARE(EventImporter::parseTable(semicolons.constData(), semicolons.constData() + semicolons.size(), events), size_t(0));
+        QCOMPARE(events.size(), size_t(3));
+        QCOMPARE(events.types[2], EventType(5));
+    }
+
+    void decodedCacheRoundTrip()
+    {
+        auto ctx = ApplicationContext::getInstance()->getCurrentFileContext();
+        QVERIFY(!ctx.isNull());
+        ChannelManager const& channel_manager = ctx->getChannelManager();
+
+        QTemporaryFile signal_file("XXXXXX.dummy");
+        QVERIFY(signal_file.open());
+        signal_file.write("signal");
+        signal_file.close();
+
+        QVERIFY(DecodedCache::open(signal_file.fileName()).isNull());
+
+        QList<QSharedPointer<SignalEvent const>> events;
+        events.append(QSharedPointer<SignalEvent const>(new SignalEvent(10, 2, 100, 0, 1, 5)));
+        QVERIFY(DecodedCache::write(signal_file.fileName(), channel_manager, events, "reader",
+                                    [] () {return false;}));
+
+        QSharedPointer<DecodedCache const> cache = DecodedCache::open(signal_file.fileName());
+        QVERIFY(!cache.isNull());
+        QCOMPARE(cache->getNumberSamples(), channel_manager.getNumberSamples());
+        QCOMPARE(cache->getReaderData(), QByteArray("reader"));
+        QCOMPARE(cache->getEvents().size(), 1);
+        QVERIFY(cache->getEvents().first()->equals(*events.first()));
+
+        for (ChannelID id : channel_manager.getChannels()) {
+            QSharedPointer<DataBlock const> original = channel_manager.getData(id, 0, channel_manager.getNumberSamples());
+            QSharedPointer<DataBlock const> cached = cache->getChannel(id);
+            QVERIFY(!cached.isNull());
+            QCOMPARE(cached->size(), original->size());
+            for (size_t index = 0; index < original->size(); index += 97)
+                QCOMPARE((*cached)[index], (*original)[index]);
+        }
+
+        // a modified file invalidates its cache
+        QVERIFY(signal_file.open());
+        signal_file.write("modified signal");
+        signal_file.close();
+        QVERIFY(DecodedCache::open(signal_file.fileName()).isNull());
+    }
+
+    void decodedCacheNativeRate()
+    {
+        QTemporaryFile signal_file("XXXXXX.dummy");
+        QVERIFY(signal_file.open());
+        signal_file.write("signal");
+        signal_file.close();
+
+        // a channel at the rate of the file and one recorded three times as
+        // fast, with peaks between the samples of the file
+        ProcessedSignalChannelManager channel_manager(10, 12, nullptr);
+        QSharedPointer<QVector<float32>> data(new QVector<float32>(12, 1));
+        channel_manager.addChannel(0, QSharedPointer<DataBlock const>(new FixedDataBlock(data, 10)), "slow", "uV");
+        std::vector<float32> samples(30);
+        for (size_t sample = 0; sample < samples.size(); sample++)
+            samples[sample] = sample % 3 == 1 ? 100 : 0;
+        channel_manager.addChannel(1, QSharedPointer<DataBlock const>(new NativeRateDataBlock(samples, 30, 1.5, 12, 10)),
+                                   "fast", "uV");
+
+        QVERIFY(DecodedCache::write(signal_file.fileName(), channel_manager, {}, QByteArray(),
+                                    [] () {return false;}));
+        QSharedPointer<DecodedCache const> cache = DecodedCache::open(signal_file.fileName());
+        QVERIFY(!cache.isNull());
+        QCOMPARE(cache->getChannel(0)->getNativeSampleRatePerUnit(), 10.0);
+
+        QSharedPointer<DataBlock const> original = channel_manager.getData(1, 0, 12);
+        QSharedPointer<DataBlock const> cached = cache->getChannel(1);
+        QVERIFY(!cached.isNull());
+        QCOMPARE(cached->getNativeSampleRatePerUnit(), 30.0);
+        for (size_t index = 0; index < original->size(); index++)
+            QCOMPARE((*cached)[index], (*original)[index]);
+
+        float32 min = 0;
+        float32 max = 0;
+        QVERIFY(cached->getMinMax(2, 3, min, max));
+        QCOMPARE(max, 100.0f);
+    }
+
+    void streamXdfChunks()
+    {
+        auto number = [] (auto value) {
+            QByteArray bytes(sizeof(value), 0);
+            qToLittleEndian(value, bytes.data());
+            return bytes;
+        };
+        auto chunk = [&number] (quint16 tag, QByteArray const& content) {
+            return QByteArray(1, 4) + number(quint32(content.size() + 2)) + number(tag) + content;
+        };
+
+        // a stream of 2 channels at 100 Hz in 3 chunks, which only have a time
+        // stamp at their first sample, and a marker stream
+        QByteArray xdf("XDF:");
+        xdf += chunk(1, "<?xml version=\"1.0\"?><info><version>1.0</version></info>");
+        xdf += chunk(2, number(quint32(7)) + "<?xml version=\"1.0\"?><info><name>EEG</name>"
+                        "<channel_count>2</channel_count><nominal_srate>100</nominal_srate>"
+                        "<channel_format>float32</channel_format><desc><channels>"
+                        "<channel><label>C3</label></channel><channel><label>C4</label></channel>"
+                        "</channels></desc></info>");
+        xdf += chunk(2, number(quint32(9)) + "<?xml version=\"1.0\"?><info><name>Markers</name>"
+                        "<channel_count>1</channel_count><nominal_srate>0</nominal_srate>"
+                        "<channel_format>string</channel_format></info>");
+        xdf += chunk(4, number(quint32(7)) + number(0.0) + number(0.5));
+        for (int index = 0; index < 3; index++) {
+            QByteArray samples = number(quint32(7)) + QByteArray(1, 1) + QByteArray(1, 100);
+            for (int sample = 0; sample < 100; sample++) {
+                if (sample == 0)
+                    samples += QByteArray(1, 8) + number(10.0 + index);
+                else
+                    samples += QByteArray(1, 0);
+                samples += number(float(index * 100 + sample)) + number(float(-index * 100 - sample));
+            }
+            xdf += chunk(3, samples);
+        }
+        xdf += chunk(3, number(quint32(9)) + QByteArray(1, 1) + QByteArray(1, 2) +
+                        QByteArray(1, 8) + number(10.5) + QByteArray(1, 1) + QByteArray(1, 5) + "start" +
+                        QByteArray(1, 8) + number(12.0) + QByteArray(1, 1) + QByteArray(1, 4) + "stop");
+        xdf += chunk(6, number(quint32(7)) + "<info><sample_count>300</sample_count></info>");
+        xdf += QByteArray(1, 4) + number(quint32(100));   // truncated chunk
+
+        QTemporaryFile file("XXXXXX.xdf");
+        QVERIFY(file.open());
+        file.write(xdf);
+        file.close();
+
+        QSharedPointer<XdfChunkReader> reader(new XdfChunkReader(file.fileName()));
+        QCOMPARE(reader->scan(), QString());
+        QCOMPARE(reader->getVersion(), 1.0);
+        QCOMPARE(reader->getStreams().size(), size_t(2));
+        XdfChunkReader::Stream const& stream = reader->getStreams()[0];
+        QVERIFY(stream.name == "EEG");
+        QCOMPARE(stream.channels.size(), size_t(2));
+        QVERIFY(stream.channels[1].at("label") == "C4");
+        QCOMPARE(stream.chunks.size(), size_t(3));
+        QCOMPARE(stream.number_samples, size_t(300));
+        QCOMPARE(stream.chunks[2].first_sample, size_t(200));
+        QVERIFY(reader->isNumeric(0));
+        QVERIFY(!reader->isNumeric(1));
+        QVERIFY(std::abs(reader->getLastTimeStamp(0) - 12.99) < 1e-9);
+        QCOMPARE(reader->synchronise(0, 11.0), 11.5);
+
+        std::vector<float32> first(100);
+        std::vector<float32> second(100);
+        float32* rows[] = {first.data(), second.data()};
+        QVERIFY(reader->decodeSamples(0, 1, rows, 0));
+        QCOMPARE(first[5], 105.0f);
+        QCOMPARE(second[99], -199.0f);
+
+        std::vector<std::string> values;
+        std::vector<double> time_stamps;
+        QVERIFY(reader->decodeStrings(1, 0, values, time_stamps));
+        QCOMPARE(values.size(), size_t(2));
+        QVERIFY(values[1] == "stop");
+        QCOMPARE(time_stamps[0], 10.5);
+
+        // the stream starts 50 samples after the begin of the file
+        XdfStreamingDecoder::Layout layout {0, 0, XdfStreamingDecoder::Layout::REGULAR, 50, 0};
+        XdfStreamingDecoder decoder(reader, {layout}, 400, 100, 10.0);
+        decoder.start();
+        QSharedPointer<DataBlock const> channel = decoder.getChannel(1, 100, 50, true);
+        QVERIFY(!channel.isNull());
+        QCOMPARE(channel->size(), size_t(400));
+        QVERIFY(std::isnan((*channel)[10]));
+        QCOMPARE((*channel)[150], -100.0f);
+        QVERIFY(decoder.waitUntilDecoded(-1));
+        QCOMPARE((*decoder.getChannel(0, 0, 400, false))[349], 299.0f);
+
+        // extrema searched before the samples are decoded are estimated and
+        // neither returned nor stored in the decoded cache, but searched again
+        // once decoding has finished
+        XdfStreamingDecoder streamed_decoder(reader, {layout}, 400, 100, 10.0);
+        StreamedChannelManager channel_manager(streamed_decoder);
+        std::map<ChannelID, float64> min_values;
+        std::map<ChannelID, float64> max_values;
+        QCOMPARE(channel_manager.getMaxValue(0), 0.0);
+        QVERIFY(!channel_manager.getMinMaxValues(min_values, max_values));
+
+        streamed_decoder.start();
+        QVERIFY(streamed_decoder.waitUntilDecoded(-1));
+        QVERIFY(DecodedCache::write(file.fileName(), channel_manager, {}, QByteArray(),
+                                    [] () {return false;}));
+        QSharedPointer<DecodedCache const> cache = DecodedCache::open(file.fileName());
+        QVERIFY(!cache.isNull());
+        QVERIFY(!cache->getMinMaxValues(min_values, max_values));
+
+        QCOMPARE(channel_manager.getMaxValue(0), 299.0);
+        QCOMPARE(channel_manager.getMinValue(1), -299.0);
+        QVERIFY(DecodedCache::write(file.fileName(), channel_manager, {}, QByteArray(),
+                                    [] () {return false;}));
+        cache = DecodedCache::open(file.fileName());
+        QVERIFY(!cache.isNull());
+        QVERIFY(cache->getMinMaxValues(min_values, max_values));
+        QCOMPARE(min_values[0], 0.0);
+        QCOMPARE(max_values[0], 299.0);
+        QCOMPARE(min_values[1], -299.0);
+    }
 };
 
 int main(int argc, char* argv[])